@@ -0,0 +1,288 @@
+// AssetCache.cpp
+#include "AssetCache.h"
+#include "config.h"
+#include "fileutils.h"
+#include "objExporter.h"
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr char kMagic[4] = { 'W', 'I', 'A', 'C' };
+    constexpr uint32_t kVersion = 2;
+
+    // 归档指纹
+    struct ArchiveFingerprint {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    bool GetFingerprint(const std::wstring& archivePath, ArchiveFingerprint& out) {
+        std::error_code ec;
+        fs::path p(archivePath);
+        auto size = fs::file_size(p, ec);
+        if (ec) return false;
+        auto mtime = fs::last_write_time(p, ec);
+        if (ec) return false;
+        out.path = wstring_to_string(archivePath);
+        out.size = static_cast<uint64_t>(size);
+        out.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        return true;
+    }
+
+    // 缓存目录:相对路径按程序所在目录解析,与其他输出路径一致
+    fs::path GetCacheDir() {
+        fs::path dir(config.assetCacheDir);
+        if (dir.is_relative()) dir = fs::path(getExecutableDir()) / dir;
+        return dir;
+    }
+
+    // 缓存文件名:归档路径的 FNV-1a 64 位哈希
+    fs::path GetCacheFilePath(const std::string& archivePath) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : archivePath) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        char name[24];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(hash));
+        return GetCacheDir() / name;
+    }
+
+    // ---------- 写入 ----------
+    class BinaryWriter {
+    public:
+        void U32(uint32_t v) { Raw(&v, sizeof(v)); }
+        void U64(uint64_t v) { Raw(&v, sizeof(v)); }
+        void Bytes(const unsigned char* data, size_t size) {
+            U64(size);
+            Raw(data, size);
+        }
+        void Str(const std::string& s) { Bytes(reinterpret_cast<const unsigned char*>(s.data()), s.size()); }
+        void Raw(const void* data, size_t size) {
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            buffer.insert(buffer.end(), p, p + size);
+        }
+        std::vector<unsigned char> buffer;
+    };
+
+    // ---------- 读取 ----------
+    class BinaryReader {
+    public:
+        BinaryReader(const unsigned char* data, size_t size) : cur(data), end(data + size) {}
+
+        bool U32(uint32_t& v) { return Raw(&v, sizeof(v)); }
+        bool U64(uint64_t& v) { return Raw(&v, sizeof(v)); }
+        bool Bytes(const unsigned char*& data, size_t& size) {
+            uint64_t len;
+            if (!U64(len) || len > static_cast<uint64_t>(end - cur)) return false;
+            data = cur;
+            size = static_cast<size_t>(len);
+            cur += size;
+            return true;
+        }
+        bool Str(std::string& s) {
+            const unsigned char* data;
+            size_t size;
+            if (!Bytes(data, size)) return false;
+            s.assign(reinterpret_cast<const char*>(data), size);
+            return true;
+        }
+        bool Raw(void* out, size_t size) {
+            if (static_cast<size_t>(end - cur) < size) return false;
+            std::memcpy(out, cur, size);
+            cur += size;
+            return true;
+        }
+    private:
+        const unsigned char* cur;
+        const unsigned char* end;
+    };
+
+    void WriteHeader(BinaryWriter& w, const ArchiveFingerprint& fp, const std::string& modId) {
+        w.Raw(kMagic, sizeof(kMagic));
+        w.U32(kVersion);
+        w.Str(fp.path);
+        w.U64(fp.size);
+        w.U64(static_cast<uint64_t>(fp.mtime));
+        w.Str(modId);
+    }
+
+    // 校验缓存头与当前归档指纹一致
+    bool ReadHeader(BinaryReader& r, const ArchiveFingerprint& fp, std::string& modId) {
+        char magic[4];
+        uint32_t version;
+        std::string path;
+        uint64_t size, mtime;
+        if (!r.Raw(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) return false;
+        if (!r.U32(version) || version != kVersion) return false;
+        if (!r.Str(path) || path != fp.path) return false;
+        if (!r.U64(size) || size != fp.size) return false;
+        if (!r.U64(mtime) || static_cast<int64_t>(mtime) != fp.mtime) return false;
+        return r.Str(modId);
+    }
+
+    void WriteBinaryMap(BinaryWriter& w, const std::unordered_map<std::string, std::vector<unsigned char>>& map) {
+        w.U64(map.size());
+        for (const auto& pair : map) {
+            w.Str(pair.first);
+            w.Bytes(pair.second.data(), pair.second.size());
+        }
+    }
+
+    void WriteEntryMap(BinaryWriter& w, const std::unordered_map<std::string, ArchiveEntryRef>& map) {
+        w.U64(map.size());
+        for (const auto& pair : map) {
+            w.Str(pair.first);
+            w.U64(pair.second.entryIndex);
+            w.U64(pair.second.size);
+        }
+    }
+
+    void WriteJsonMap(BinaryWriter& w, const std::unordered_map<std::string, nlohmann::json>& map) {
+        w.U64(map.size());
+        std::vector<uint8_t> cbor;
+        for (const auto& pair : map) {
+            cbor.clear();
+            nlohmann::json::to_cbor(pair.second, cbor);
+            w.Str(pair.first);
+            w.Bytes(cbor.data(), cbor.size());
+        }
+    }
+
+    bool ReadBinaryMap(BinaryReader& r, std::unordered_map<std::string, std::vector<unsigned char>>& map) {
+        uint64_t count;
+        if (!r.U64(count)) return false;
+        map.reserve(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string key;
+            const unsigned char* data;
+            size_t size;
+            if (!r.Str(key) || !r.Bytes(data, size)) return false;
+            map.emplace(std::move(key), std::vector<unsigned char>(data, data + size));
+        }
+        return true;
+    }
+
+    bool ReadEntryMap(BinaryReader& r, std::unordered_map<std::string, ArchiveEntryRef>& map) {
+        uint64_t count;
+        if (!r.U64(count)) return false;
+        map.reserve(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string key;
+            ArchiveEntryRef ref;
+            if (!r.Str(key) || !r.U64(ref.entryIndex) || !r.U64(ref.size)) return false;
+            map.emplace(std::move(key), ref);
+        }
+        return true;
+    }
+
+    bool ReadJsonMap(BinaryReader& r, std::unordered_map<std::string, nlohmann::json>& map) {
+        uint64_t count;
+        if (!r.U64(count)) return false;
+        map.reserve(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            std::string key;
+            const unsigned char* data;
+            size_t size;
+            if (!r.Str(key) || !r.Bytes(data, size)) return false;
+            nlohmann::json value = nlohmann::json::from_cbor(data, data + size, true, false);
+            if (value.is_discarded()) return false;
+            map.emplace(std::move(key), std::move(value));
+        }
+        return true;
+    }
+
+    bool ReadCacheFile(const fs::path& filePath, std::vector<unsigned char>& out) {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file) return false;
+        std::streamsize size = file.tellg();
+        if (size <= 0) return false;
+        file.seekg(0, std::ios::beg);
+        out.resize(static_cast<size_t>(size));
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()), size));
+    }
+}
+
+namespace AssetCache {
+    bool TryLoadModId(const std::wstring& archivePath, std::string& outModId) {
+        if (!config.useAssetCache) return false;
+        ArchiveFingerprint fp;
+        if (!GetFingerprint(archivePath, fp)) return false;
+
+        // 只读取文件头部,不加载资源数据
+        std::ifstream file(GetCacheFilePath(fp.path), std::ios::binary);
+        if (!file) return false;
+        std::vector<unsigned char> header(4096);
+        file.read(reinterpret_cast<char*>(header.data()), header.size());
+        header.resize(static_cast<size_t>(file.gcount()));
+
+        BinaryReader r(header.data(), header.size());
+        return ReadHeader(r, fp, outModId);
+    }
+
+    bool TryLoad(const std::wstring& archivePath, std::string& outModId, ArchiveResources& outResources) {
+        if (!config.useAssetCache) return false;
+        ArchiveFingerprint fp;
+        if (!GetFingerprint(archivePath, fp)) return false;
+
+        std::vector<unsigned char> data;
+        if (!ReadCacheFile(GetCacheFilePath(fp.path), data)) return false;
+
+        BinaryReader r(data.data(), data.size());
+        ArchiveResources resources;
+        if (!ReadHeader(r, fp, outModId) ||
+            !ReadEntryMap(r, resources.localTextures) ||
+            !ReadJsonMap(r, resources.localBlockstates) ||
+            !ReadJsonMap(r, resources.localModels) ||
+            !ReadJsonMap(r, resources.localMcmetas) ||
+            !ReadJsonMap(r, resources.localBiomes) ||
+            !ReadBinaryMap(r, resources.localColormaps)) {
+            std::cerr << "Warning: Asset cache is corrupt, rebuilding: " << fp.path << std::endl;
+            return false;
+        }
+        outResources = std::move(resources);
+        return true;
+    }
+
+    void Store(const std::wstring& archivePath, const std::string& modId, const ArchiveResources& resources) {
+        if (!config.useAssetCache) return;
+        ArchiveFingerprint fp;
+        if (!GetFingerprint(archivePath, fp)) return;
+
+        BinaryWriter w;
+        WriteHeader(w, fp, modId);
+        WriteEntryMap(w, resources.localTextures);
+        WriteJsonMap(w, resources.localBlockstates);
+        WriteJsonMap(w, resources.localModels);
+        WriteJsonMap(w, resources.localMcmetas);
+        WriteJsonMap(w, resources.localBiomes);
+        WriteBinaryMap(w, resources.localColormaps);
+
+        std::error_code ec;
+        fs::create_directories(GetCacheDir(), ec);
+        fs::path filePath = GetCacheFilePath(fp.path);
+        fs::path tmpPath = filePath;
+        tmpPath += ".tmp";
+        {
+            std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!file) return;
+            file.write(reinterpret_cast<const char*>(w.buffer.data()), w.buffer.size());
+            if (!file) {
+                file.close();
+                fs::remove(tmpPath, ec);
+                return;
+            }
+        }
+        fs::rename(tmpPath, filePath, ec);
+        if (ec) {
+            fs::remove(tmpPath, ec);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include "include/json.hpp"
+#include "JarReader.h"
+
+/**
+ * @brief 单个归档(JAR/资源包)中提取出的全部资源
+ */
+struct ArchiveResources {
+    std::unordered_map<std::string, ArchiveEntryRef> localTextures;               // 本地材质(归档内位置)
+    std::unordered_map<std::string, nlohmann::json> localBlockstates;             // 本地方块状态
+    std::unordered_map<std::string, nlohmann::json> localModels;                  // 本地模型
+    std::unordered_map<std::string, nlohmann::json> localMcmetas;                 // 本地材质元数据
+    std::unordered_map<std::string, nlohmann::json> localBiomes;                  // 本地生物群系
+    std::unordered_map<std::string, std::vector<unsigned char>> localColormaps;   // 本地颜色映射
+};
+
+// ========= 持久化资源缓存 =========
+// 每个归档对应一个二进制缓存文件,以归档路径、大小和修改时间作为指纹;
+// JSON 以 CBOR 形式保存,纹理只保存条目位置,热启动时无需解压和文本解析
+namespace AssetCache {
+    // 仅读取缓存头中的模组ID(指纹不匹配时返回 false)
+    bool TryLoadModId(const std::wstring& archivePath, std::string& outModId);
+
+    // 读取归档的全部缓存资源(指纹不匹配或文件损坏时返回 false)
+    bool TryLoad(const std::wstring& archivePath, std::string& outModId, ArchiveResources& outResources);
+
+    // 将归档资源写入缓存(先写临时文件再替换,失败时静默跳过)
+    void Store(const std::wstring& archivePath, const std::string& modId, const ArchiveResources& resources);
+}
@@ -18,6 +18,12 @@
 #include <iostream>
 #include <thread>
 #include <atomic>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <shared_mutex>
 #include "ModelDeduplicator.h"
 #include "ChunkGroupAllocator.h"
 #include <utility>
@@ -32,7 +38,46 @@ static const std::unordered_map<FaceType, int> neighborIndexMap = {
         {FaceType::DOWN, 1}, {FaceType::UP, 0}, {FaceType::NORTH, 4},
         {FaceType::SOUTH, 5}, {FaceType::WEST, 2}, {FaceType::EAST, 3}
 };
-void ChunkGenerator::ProcessBlockForModel(ModelData& chunkModel, int x, int y, int z) {
+
+// 同一 Section 内平整的流体顶面,按(顶面高度, 材质, 面方向)分组,每组为一张 16x16 的占用表
+struct FluidSurfaceLayer {
+    float height;                   // 顶面绝对高度
+    Material material;              // 顶面材质(静止贴图)
+    FaceType faceDirection;         // 顶面剔除方向
+    std::array<bool, 256> cells{};  // 索引为 (z & 15) * 16 + (x & 15)
+};
+
+struct FluidSurfaceCollector {
+    std::vector<FluidSurfaceLayer> layers;
+
+    void Add(int x, int z, float height, const Material& material, FaceType faceDirection) {
+        for (auto& layer : layers) {
+            if (layer.height == height && layer.faceDirection == faceDirection &&
+                layer.material.name == material.name) {
+                layer.cells[(z & 15) * 16 + (x & 15)] = true;
+                return;
+            }
+        }
+        FluidSurfaceLayer layer;
+        layer.height = height;
+        layer.material = material;
+        layer.faceDirection = faceDirection;
+        layer.cells[(z & 15) * 16 + (x & 15)] = true;
+        layers.push_back(std::move(layer));
+    }
+};
+
+// 判断流体模型的顶面是否为四角等高、使用静止贴图的平面
+static bool IsFlatStillFluidTop(const ModelData& model, const Face& face) {
+    if (face.materialIndex != 0 || face.materialIndex >= static_cast<int>(model.materials.size())) return false;
+    float y0 = model.vertices[face.vertexIndices[0] * 3 + 1];
+    for (int i = 1; i < 4; ++i) {
+        if (model.vertices[face.vertexIndices[i] * 3 + 1] != y0) return false;
+    }
+    return true;
+}
+
+void ChunkGenerator::ProcessBlockForModel(ModelData& chunkModel, int x, int y, int z, FluidSurfaceCollector* fluidSurfaces) {
     std::array<bool, 6> neighbors; // 邻居是否为空气
     std::array<int, 10> fluidLevels; // 流体液位
 
@@ -77,17 +122,19 @@ void ChunkGenerator::ProcessBlockForModel(ModelData& chunkModel, int x, int y, i
 
     ModelData blockModel;
     ModelData liquidModel;
+    bool isPureFluid = false; // 纯流体方块(非含水方块)
     if (currentBlock.level > -1) {
         blockModel = GetRandomModelFromCache(ns, blockName);
 
         if (blockModel.vertices.empty()) {
-            liquidModel = GenerateFluidModel(fluidLevels, currentBlock.name);
+            liquidModel = *GenerateFluidModel(fluidLevels, currentBlock.name);
             AssignFluidMaterials(liquidModel, currentBlock.name);
-            blockModel = liquidModel;
+            blockModel = std::move(liquidModel);
+            isPureFluid = true;
         }
         else
         {
-            liquidModel = GenerateFluidModel(fluidLevels, "minecraft:water[level:0]");
+            liquidModel = *GenerateFluidModel(fluidLevels, "minecraft:water[level:0]");
             AssignFluidMaterials(liquidModel, "minecraft:water[level:0]");
 
             // 只对有流体方向的面设置为不剔除
@@ -161,9 +208,18 @@ void ChunkGenerator::ProcessBlockForModel(ModelData& chunkModel, int x, int y, i
     filteredModel.faces.reserve(validFaceIndices.size());
 
     for (int faceIdx : validFaceIndices) {
+        // 流体顶面(索引1)若为平面,交给收集器在 Section 结束后统一合并
+        if (fluidSurfaces != nullptr && isPureFluid && faceIdx == 1 &&
+            IsFlatStillFluidTop(blockModel, blockModel.faces[faceIdx])) {
+            const Face& top = blockModel.faces[faceIdx];
+            float height = y + blockModel.vertices[top.vertexIndices[0] * 3 + 1];
+            fluidSurfaces->Add(x, z, height, blockModel.materials[top.materialIndex], top.faceDirection);
+            continue;
+        }
         // 直接复制Face结构体
         filteredModel.faces.push_back(blockModel.faces[faceIdx]);
     }
+    if (filteredModel.faces.empty()) return;
 
     // 顶点和UV数据保持不变(后续合并时会去重)
     filteredModel.vertices = blockModel.vertices;
@@ -200,6 +256,9 @@ ModelData ChunkGenerator::GenerateChunkModel(int chunkX, int sectionY, int chunk
     int blockYStart = sectionY * 16;
    
     
+    FluidSurfaceCollector fluidSurfaces;
+    FluidSurfaceCollector* fluidSurfacesPtr = config.mergeFluidSurface ? &fluidSurfaces : nullptr;
+
     // 遍历区块内的每个方块
     for (int x = blockXStart; x < blockXStart + 16; ++x) {
         for (int z = blockZStart; z < blockZStart + 16; ++z) {
@@ -209,11 +268,15 @@ ModelData ChunkGenerator::GenerateChunkModel(int chunkX, int sectionY, int chunk
                 if (x < xStart || x > xEnd || y < yStart || y > yEnd || z < zStart || z > zEnd) {
                     continue; // 跳过不在导出区域内的方块
                 }
-                ProcessBlockForModel(chunkModel, x, y, z);
+                ProcessBlockForModel(chunkModel, x, y, z, fluidSurfacesPtr);
             }
         }
     }
 
+    if (!fluidSurfaces.layers.empty()) {
+        EmitMergedFluidSurfaces(chunkModel, fluidSurfaces, blockXStart, blockZStart);
+    }
+
     
     auto chunkKey = std::make_pair(chunkX, chunkZ);
     {
@@ -246,6 +309,84 @@ ModelData ChunkGenerator::GenerateChunkModel(int chunkX, int sectionY, int chunk
     return chunkModel;
 }
 
+void ChunkGenerator::EmitMergedFluidSurfaces(ModelData& chunkModel, const FluidSurfaceCollector& fluidSurfaces, int blockXStart, int blockZStart) {
+    // 占用表坐标相对 Section 的最小角,(x & 15) 对负坐标同样成立
+    ModelData surfaceModel;
+    for (const auto& layer : fluidSurfaces.layers) {
+        const Material& material = layer.material;
+        float aspectRatio = material.aspectRatio < 1.0f ? 1.0f : material.aspectRatio;
+        // 动态材质的帧竖向排列,V方向平铺会跨帧,只沿X方向合并
+        bool mergeAlongZ = material.type != ANIMATED;
+
+        int materialIndex = static_cast<int>(surfaceModel.materials.size());
+        surfaceModel.materials.push_back(material);
+
+        std::array<bool, 256> cells = layer.cells;
+        for (int lz = 0; lz < 16; ++lz) {
+            for (int lx = 0; lx < 16; ++lx) {
+                if (!cells[lz * 16 + lx]) continue;
+
+                // 沿X方向扩展
+                int width = 1;
+                while (lx + width < 16 && cells[lz * 16 + lx + width]) ++width;
+
+                // 沿Z方向扩展整行
+                int depth = 1;
+                while (mergeAlongZ && lz + depth < 16) {
+                    bool rowFull = true;
+                    for (int i = 0; i < width; ++i) {
+                        if (!cells[(lz + depth) * 16 + lx + i]) { rowFull = false; break; }
+                    }
+                    if (!rowFull) break;
+                    ++depth;
+                }
+
+                for (int dz = 0; dz < depth; ++dz) {
+                    for (int dx = 0; dx < width; ++dx) {
+                        cells[(lz + dz) * 16 + lx + dx] = false;
+                    }
+                }
+
+                // 顶点顺序与 GenerateFluidModel 的顶面一致:西北,西南,东南,东北
+                int vBase = static_cast<int>(surfaceModel.vertices.size() / 3);
+                int uvBase = static_cast<int>(surfaceModel.uvCoordinates.size() / 2);
+                float x0 = static_cast<float>(blockXStart + lx), x1 = x0 + width;
+                float z0 = static_cast<float>(blockZStart + lz), z1 = z0 + depth;
+                surfaceModel.vertices.insert(surfaceModel.vertices.end(), {
+                    x0, layer.height, z0,
+                    x0, layer.height, z1,
+                    x1, layer.height, z1,
+                    x1, layer.height, z0
+                });
+
+                // UV按方块数平铺,V方向仍以单帧高度为单位
+                float vBottom = 1.0f - static_cast<float>(depth) / aspectRatio;
+                surfaceModel.uvCoordinates.insert(surfaceModel.uvCoordinates.end(), {
+                    0.0f, 1.0f,
+                    0.0f, vBottom,
+                    static_cast<float>(width), vBottom,
+                    static_cast<float>(width), 1.0f
+                });
+
+                Face face;
+                face.vertexIndices = { vBase, vBase + 1, vBase + 2, vBase + 3 };
+                face.uvIndices = { uvBase, uvBase + 1, uvBase + 2, uvBase + 3 };
+                face.materialIndex = materialIndex;
+                face.faceDirection = layer.faceDirection;
+                surfaceModel.faces.push_back(face);
+            }
+        }
+    }
+    if (surfaceModel.faces.empty()) return;
+
+    if (chunkModel.vertices.empty()) {
+        chunkModel = std::move(surfaceModel);
+    }
+    else {
+        MergeModelsDirectly(chunkModel, surfaceModel);
+    }
+}
+
 ModelData ChunkGenerator::GenerateLODChunkModel(int chunkX, int sectionY, int chunkZ, float lodSize) {
     // 从RegionModelExporter.cpp中复制GenerateLODChunkModel的实现
     ModelData chunkModel;
@@ -291,7 +432,7 @@ ModelData ChunkGenerator::GenerateLODChunkModel(int chunkX, int sectionY, int ch
                     }
                 }
                 
-                std::vector<std::string> color = LODManager::GetBlockColor(x, y, z, id, type);
+                LODBoxColors color = LODManager::GetBlockColor(x, y, z, id, type);
                 level = (lodBlockSize - (level));
                 // 如果块类型是固体
                 if (type == SOLID) {
@@ -307,4 +448,217 @@ ModelData ChunkGenerator::GenerateLODChunkModel(int chunkX, int sectionY, int ch
         }
     }
     return chunkModel;
-}
\ No newline at end of file
+}
+
+//============== 高度场远景地形 ==============//
+// 读取区块高度图(WORLD_SURFACE)的副本,区块未加载时返回 false
+static bool CopyChunkSurfaceHeights(int chunkX, int chunkZ, std::vector<int>& out) {
+    std::shared_lock<std::shared_mutex> lock(heightMapCacheMutex);
+    auto chunkIt = heightMapCache.find(std::make_pair(chunkX, chunkZ));
+    if (chunkIt == heightMapCache.end()) return false;
+    auto typeIt = chunkIt->second.find("WORLD_SURFACE");
+    if (typeIt == chunkIt->second.end() || typeIt->second.size() < 256) return false;
+    out = typeIt->second;
+    return true;
+}
+
+ModelData ChunkGenerator::GenerateHeightfieldChunkModel(int chunkX, int chunkZ) {
+    ModelData model;
+    const int blockXStart = chunkX * 16;
+    const int blockZStart = chunkZ * 16;
+    const int baseY = minSectionY * 16;
+    const float tolerance = std::max(config.heightfieldErrorTolerance, 0.0f);
+
+    // 列顶面高度,范围为本区块及周围一圈(18x18),缺失或超出导出范围的列记为空洞
+    constexpr int kNoColumn = INT_MIN;
+    std::array<int, 18 * 18> columnTop;
+    columnTop.fill(kNoColumn);
+    auto columnAt = [&](int lx, int lz) -> int& { return columnTop[(lz + 1) * 18 + (lx + 1)]; };
+    for (int ncz = -1; ncz <= 1; ++ncz) {
+        for (int ncx = -1; ncx <= 1; ++ncx) {
+            std::vector<int> heights;
+            if (!CopyChunkSurfaceHeights(chunkX + ncx, chunkZ + ncz, heights)) continue;
+            for (int lz = std::max(-1, ncz * 16); lz <= std::min(16, ncz * 16 + 15); ++lz) {
+                for (int lx = std::max(-1, ncx * 16); lx <= std::min(16, ncx * 16 + 15); ++lx) {
+                    int wx = blockXStart + lx, wz = blockZStart + lz;
+                    if (wx < config.minX || wx > config.maxX || wz < config.minZ || wz > config.maxZ) continue;
+                    int raw = heights[mod16(lx) + mod16(lz) * 16];
+                    if (raw <= 0) continue; // 整列为空
+                    columnAt(lx, lz) = std::clamp(baseY + raw, config.minY, config.maxY + 1);
+                }
+            }
+        }
+    }
+
+    // 本区块每列的地表颜色(调色板索引)与是否为流体
+    std::array<uint32_t, 256> columnColor{};
+    std::array<bool, 256> columnFluid{};
+    for (int lz = 0; lz < 16; ++lz) {
+        for (int lx = 0; lx < 16; ++lx) {
+            int top = columnAt(lx, lz);
+            if (top == kNoColumn) continue;
+            int x = blockXStart + lx, z = blockZStart + lz;
+            int id = GetBlockId(x, top - 1, z);
+            if (id == 0) {
+                columnAt(lx, lz) = kNoColumn;
+                continue;
+            }
+            Block block = GetBlockById(id);
+            BlockType type = (block.level > -1) ? FLUID : SOLID;
+            columnColor[lx + lz * 16] = LODManager::GetBlockColor(x, top - 1, z, id, type).top;
+            columnFluid[lx + lz * 16] = (type == FLUID);
+        }
+    }
+
+    // 角点高度:取相邻四列的平均值,与相邻区块共享同一组列数据以保证边界一致
+    std::array<float, 17 * 17> cornerHeight;
+    for (int cz = 0; cz <= 16; ++cz) {
+        for (int cx = 0; cx <= 16; ++cx) {
+            float sum = 0.0f;
+            int count = 0;
+            for (int dz = -1; dz <= 0; ++dz) {
+                for (int dx = -1; dx <= 0; ++dx) {
+                    int h = columnAt(cx + dx, cz + dz);
+                    if (h == kNoColumn) continue;
+                    sum += static_cast<float>(h);
+                    count++;
+                }
+            }
+            cornerHeight[cz * 17 + cx] = count > 0 ? sum / count : static_cast<float>(baseY);
+        }
+    }
+    auto corner = [&](int cx, int cz) { return cornerHeight[cz * 17 + cx]; };
+
+    // 四叉树简化:节点内所有角点与双线性插值的最大偏差不超过容限,且不混合流体/固体/空洞时成为叶子
+    struct HeightfieldLeaf { int x0, z0, size; };
+    std::vector<HeightfieldLeaf> leaves;
+    std::array<uint8_t, 256> leafSize{};
+    std::function<void(int, int, int)> subdivide = [&](int x0, int z0, int size) {
+        bool uniform = true;
+        bool hasHole = false;
+        bool firstFluid = columnFluid[x0 + z0 * 16];
+        for (int lz = z0; lz < z0 + size && uniform; ++lz) {
+            for (int lx = x0; lx < x0 + size; ++lx) {
+                if (columnAt(lx, lz) == kNoColumn) hasHole = true;
+                if (hasHole || columnFluid[lx + lz * 16] != firstFluid) {
+                    uniform = false;
+                    break;
+                }
+            }
+        }
+        float maxError = 0.0f;
+        if (uniform && size > 1) {
+            float h00 = corner(x0, z0), h10 = corner(x0 + size, z0);
+            float h01 = corner(x0, z0 + size), h11 = corner(x0 + size, z0 + size);
+            for (int cz = z0; cz <= z0 + size && maxError <= tolerance; ++cz) {
+                float v = static_cast<float>(cz - z0) / size;
+                for (int cx = x0; cx <= x0 + size; ++cx) {
+                    float u = static_cast<float>(cx - x0) / size;
+                    float interp = (h00 * (1 - u) + h10 * u) * (1 - v) + (h01 * (1 - u) + h11 * u) * v;
+                    maxError = std::max(maxError, std::abs(corner(cx, cz) - interp));
+                }
+            }
+        }
+        if (size == 1 || (uniform && maxError <= tolerance)) {
+            if (size == 1 && hasHole) return;
+            leaves.push_back({ x0, z0, size });
+            for (int lz = z0; lz < z0 + size; ++lz) {
+                for (int lx = x0; lx < x0 + size; ++lx) {
+                    leafSize[lx + lz * 16] = static_cast<uint8_t>(size);
+                }
+            }
+            return;
+        }
+        int half = size / 2;
+        subdivide(x0, z0, half);
+        subdivide(x0 + half, z0, half);
+        subdivide(x0, z0 + half, half);
+        subdivide(x0 + half, z0 + half, half);
+    };
+    subdivide(0, 0, 16);
+    if (leaves.empty()) return model;
+
+    // 材质:每个调色板颜色一个材质
+    std::unordered_map<uint32_t, int> materialIndexMap;
+    auto materialFor = [&](uint32_t colorIndex) -> int {
+        auto it = materialIndexMap.find(colorIndex);
+        if (it != materialIndexMap.end()) return it->second;
+        int idx = static_cast<int>(model.materials.size());
+        model.materials.push_back(LODManager::GetLODColorMaterial(colorIndex));
+        materialIndexMap.emplace(colorIndex, idx);
+        return idx;
+    };
+    // 叶子颜色:取节点内出现次数最多的颜色
+    auto leafColor = [&](const HeightfieldLeaf& leaf) -> uint32_t {
+        std::unordered_map<uint32_t, int> counts;
+        uint32_t best = columnColor[leaf.x0 + leaf.z0 * 16];
+        int bestCount = 0;
+        for (int lz = leaf.z0; lz < leaf.z0 + leaf.size; ++lz) {
+            for (int lx = leaf.x0; lx < leaf.x0 + leaf.size; ++lx) {
+                int c = ++counts[columnColor[lx + lz * 16]];
+                if (c > bestCount) {
+                    bestCount = c;
+                    best = columnColor[lx + lz * 16];
+                }
+            }
+        }
+        return best;
+    };
+
+    model.uvCoordinates = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    auto addVertex = [&](float x, float y, float z) -> int {
+        int idx = static_cast<int>(model.vertices.size() / 3);
+        model.vertices.push_back(x);
+        model.vertices.push_back(y);
+        model.vertices.push_back(z);
+        return idx;
+    };
+    // 裙边:遮挡相邻叶子尺寸不同(T形接缝)或区块边界处的缝隙
+    const float skirtDepth = tolerance + 1.0f;
+    auto addSkirt = [&](float ax, float az, float ah, float bx, float bz, float bh, int materialIndex, FaceType direction) {
+        float bottom = std::min(ah, bh) - skirtDepth;
+        int a = addVertex(ax, ah, az);
+        int b = addVertex(bx, bh, bz);
+        int c = addVertex(bx, bottom, bz);
+        int d = addVertex(ax, bottom, az);
+        model.faces.push_back({ { a, b, c, d }, { 0, 1, 2, 3 }, materialIndex, direction });
+    };
+    // 相邻一侧是否存在更小的叶子(或区块边界)
+    auto needsSkirt = [&](const HeightfieldLeaf& leaf, int side) -> bool {
+        for (int i = 0; i < leaf.size; ++i) {
+            int lx, lz;
+            switch (side) {
+            case 0: lx = leaf.x0 + i; lz = leaf.z0 - 1; break;         // 北
+            case 1: lx = leaf.x0 + i; lz = leaf.z0 + leaf.size; break; // 南
+            case 2: lx = leaf.x0 - 1; lz = leaf.z0 + i; break;         // 西
+            default: lx = leaf.x0 + leaf.size; lz = leaf.z0 + i; break; // 东
+            }
+            if (lx < 0 || lx >= 16 || lz < 0 || lz >= 16) return true;
+            uint8_t neighborSize = leafSize[lx + lz * 16];
+            if (neighborSize != 0 && neighborSize < leaf.size) return true;
+        }
+        return false;
+    };
+
+    for (const auto& leaf : leaves) {
+        int materialIndex = materialFor(leafColor(leaf));
+        float x0 = static_cast<float>(blockXStart + leaf.x0), x1 = x0 + leaf.size;
+        float z0 = static_cast<float>(blockZStart + leaf.z0), z1 = z0 + leaf.size;
+        float hNW = corner(leaf.x0, leaf.z0), hNE = corner(leaf.x0 + leaf.size, leaf.z0);
+        float hSW = corner(leaf.x0, leaf.z0 + leaf.size), hSE = corner(leaf.x0 + leaf.size, leaf.z0 + leaf.size);
+
+        // 顶面顶点顺序与 LOD 方块顶面一致:西北、西南、东南、东北
+        int nw = addVertex(x0, hNW, z0);
+        int sw = addVertex(x0, hSW, z1);
+        int se = addVertex(x1, hSE, z1);
+        int ne = addVertex(x1, hNE, z0);
+        model.faces.push_back({ { nw, sw, se, ne }, { 0, 3, 2, 1 }, materialIndex, FaceType::DO_NOT_CULL });
+
+        // 裙边顶点按逆时针排列,法线朝外
+        if (needsSkirt(leaf, 0)) addSkirt(x0, z0, hNW, x1, z0, hNE, materialIndex, FaceType::NORTH);
+        if (needsSkirt(leaf, 1)) addSkirt(x1, z1, hSE, x0, z1, hSW, materialIndex, FaceType::SOUTH);
+        if (needsSkirt(leaf, 2)) addSkirt(x0, z1, hSW, x0, z0, hNW, materialIndex, FaceType::WEST);
+        if (needsSkirt(leaf, 3)) addSkirt(x1, z0, hNE, x1, z1, hSE, materialIndex, FaceType::EAST);
+    }
+    return model;
+}
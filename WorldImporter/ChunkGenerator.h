@@ -5,12 +5,18 @@
 #include "model.h"
 #include "block.h"
 
+struct FluidSurfaceCollector;
+
 class ChunkGenerator {
 public:
     static ModelData GenerateChunkModel(int chunkX, int sectionY, int chunkZ);
     static ModelData GenerateLODChunkModel(int chunkX, int sectionY, int chunkZ, float lodSize);
+    // 根据高度图生成简化的2.5D远景地形(整个区块一次生成,不遍历 Section)
+    static ModelData GenerateHeightfieldChunkModel(int chunkX, int chunkZ);
 private:
-    static void ProcessBlockForModel(ModelData& chunkModel, int x, int y, int z);
+    static void ProcessBlockForModel(ModelData& chunkModel, int x, int y, int z, FluidSurfaceCollector* fluidSurfaces = nullptr);
+    // 将收集到的平整流体顶面合并为大面并写入区块模型
+    static void EmitMergedFluidSurfaces(ModelData& chunkModel, const FluidSurfaceCollector& fluidSurfaces, int blockXStart, int blockZStart);
 };
 
 #endif // CHUNK_GENERATOR_H
\ No newline at end of file
@@ -3,6 +3,13 @@
 #include <thread>
 #include <vector>
 #include <shared_mutex>
+#include <queue>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+#include <atomic>
+#include <climits>
+#include <cstring>
 #include "locutil.h"
 #include "ChunkLoader.h"
 #include "block.h"
@@ -21,8 +28,10 @@ void ChunkLoader::LoadChunks(int chunkXStart, int chunkXEnd, int chunkZStart, in
             if (!HasChunk(chunkX, chunkZ)) {
                 continue;
             }
-            futures.push_back(std::async(std::launch::async, [&, chunkX, chunkZ]() {
-                LoadAndCacheBlockData(chunkX, chunkZ);
+            // 高度场远景区块只需要地表附近的子区块
+            bool surfaceOnly = LODManager::IsHeightfieldChunk(chunkX, chunkZ);
+            futures.push_back(std::async(std::launch::async, [&, chunkX, chunkZ, surfaceOnly]() {
+                LoadAndCacheBlockData(chunkX, chunkZ, surfaceOnly);
                 for (int sectionY = sectionYStart; sectionY <= sectionYEnd; ++sectionY) {
                     auto key = std::make_tuple(chunkX, sectionY, chunkZ);
                     // 确保条目存在（可能由RegionModelExporter预先创建以存储LOD）
@@ -86,8 +95,419 @@ void ChunkLoader::UnloadChunks(int chunkXStart, int chunkXEnd, int chunkZStart,
     }
 }
 
+//============== 预算驱动的四叉树LOD选择 ==============//
+// 面数估算:LOD计算发生在区块加载之前,此处只扫描区块NBT的字节流(不构建标签树、不写入任何缓存),
+// 统计导出范围内各子区块的非空气方块数量,再按子区块的实心比例估算面数
+static bool IsAirBlockName(const char* name, size_t length) {
+    auto equals = [&](const char* literal) {
+        return length == std::strlen(literal) && std::memcmp(name, literal, length) == 0;
+    };
+    return equals("minecraft:air") || equals("minecraft:cave_air") || equals("minecraft:void_air");
+}
+
+namespace {
+    // NBT 字节流扫描器(大端序),越界时将 ok 置为 false 并停止读取
+    struct NbtScanner {
+        const std::vector<char>& data;
+        size_t index = 0;
+        bool ok = true;
+
+        bool Has(size_t count) {
+            if (index + count > data.size()) ok = false;
+            return ok;
+        }
+        uint8_t U8() { return Has(1) ? static_cast<uint8_t>(data[index++]) : 0; }
+        uint32_t U32() {
+            if (!Has(4)) return 0;
+            uint32_t v = 0;
+            for (int i = 0; i < 4; ++i) v = (v << 8) | static_cast<uint8_t>(data[index++]);
+            return v;
+        }
+        // 读取字符串,返回在缓冲区内的位置与长度
+        size_t Str(size_t& length) {
+            length = Has(2) ? ((static_cast<uint8_t>(data[index]) << 8) | static_cast<uint8_t>(data[index + 1])) : 0;
+            if (!ok) return 0;
+            index += 2;
+            size_t start = index;
+            if (Has(length)) index += length;
+            return start;
+        }
+        bool NameIs(size_t start, size_t length, const char* literal) const {
+            return length == std::strlen(literal) && std::memcmp(data.data() + start, literal, length) == 0;
+        }
+        void Skip(uint8_t type) {
+            switch (static_cast<TagType>(type)) {
+            case TagType::BYTE: if (Has(1)) index += 1; break;
+            case TagType::SHORT: if (Has(2)) index += 2; break;
+            case TagType::INT: case TagType::FLOAT: if (Has(4)) index += 4; break;
+            case TagType::LONG: case TagType::DOUBLE: if (Has(8)) index += 8; break;
+            case TagType::BYTE_ARRAY: { size_t n = U32(); if (Has(n)) index += n; break; }
+            case TagType::INT_ARRAY: { size_t n = U32(); if (Has(n * 4)) index += n * 4; break; }
+            case TagType::LONG_ARRAY: { size_t n = U32(); if (Has(n * 8)) index += n * 8; break; }
+            case TagType::STRING: { size_t n; Str(n); break; }
+            case TagType::LIST: {
+                uint8_t elemType = U8();
+                uint32_t n = U32();
+                for (uint32_t i = 0; i < n && ok; ++i) Skip(elemType);
+                break;
+            }
+            case TagType::COMPOUND: {
+                while (ok) {
+                    uint8_t childType = U8();
+                    if (childType == 0) break;
+                    size_t n;
+                    Str(n);
+                    Skip(childType);
+                }
+                break;
+            }
+            default: ok = false; break;
+            }
+        }
+    };
+
+    // 单个子区块的统计:调色板各项是否为实心,以及 data 数组在缓冲区内的位置
+    struct SectionStats {
+        int y = INT_MIN;
+        std::vector<uint8_t> paletteSolid;
+        size_t dataOffset = 0;
+        size_t dataLongs = 0;
+    };
+
+    // 扫描 block_states 复合标签
+    void ScanBlockStates(NbtScanner& scan, SectionStats& stats) {
+        while (scan.ok) {
+            uint8_t type = scan.U8();
+            if (type == 0) break;
+            size_t nameLength;
+            size_t name = scan.Str(nameLength);
+            if (type == static_cast<uint8_t>(TagType::LIST) && scan.NameIs(name, nameLength, "palette")) {
+                uint8_t elemType = scan.U8();
+                uint32_t count = scan.U32();
+                for (uint32_t i = 0; i < count && scan.ok; ++i) {
+                    if (elemType != static_cast<uint8_t>(TagType::COMPOUND)) { scan.Skip(elemType); continue; }
+                    bool solid = true;
+                    while (scan.ok) {
+                        uint8_t fieldType = scan.U8();
+                        if (fieldType == 0) break;
+                        size_t fieldLength;
+                        size_t field = scan.Str(fieldLength);
+                        if (fieldType == static_cast<uint8_t>(TagType::STRING) && scan.NameIs(field, fieldLength, "Name")) {
+                            size_t valueLength;
+                            size_t value = scan.Str(valueLength);
+                            if (scan.ok) solid = !IsAirBlockName(scan.data.data() + value, valueLength);
+                        }
+                        else {
+                            scan.Skip(fieldType);
+                        }
+                    }
+                    stats.paletteSolid.push_back(solid ? 1 : 0);
+                }
+            }
+            else if (type == static_cast<uint8_t>(TagType::LONG_ARRAY) && scan.NameIs(name, nameLength, "data")) {
+                stats.dataLongs = scan.U32();
+                stats.dataOffset = scan.index;
+                if (scan.Has(stats.dataLongs * 8)) scan.index += stats.dataLongs * 8;
+            }
+            else {
+                scan.Skip(type);
+            }
+        }
+    }
+
+    // 子区块中非空气方块的数量(只解包调色板索引计数,不生成方块数组)
+    int CountSolidBlocks(const std::vector<char>& data, const SectionStats& stats) {
+        const size_t paletteSize = stats.paletteSolid.size();
+        if (paletteSize == 0) return 0;
+        if (paletteSize == 1 || stats.dataLongs == 0) return stats.paletteSolid[0] ? 4096 : 0;
+
+        int bitsPerState = 4;
+        while ((size_t(1) << bitsPerState) < paletteSize) ++bitsPerState;
+        const int statesPerLong = 64 / bitsPerState;
+        const uint64_t mask = (uint64_t(1) << bitsPerState) - 1;
+        int solid = 0;
+        int block = 0;
+        for (size_t l = 0; l < stats.dataLongs && block < 4096; ++l) {
+            uint64_t value = 0;
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data() + stats.dataOffset + l * 8);
+            for (int b = 0; b < 8; ++b) value = (value << 8) | bytes[b];
+            for (int k = 0; k < statesPerLong && block < 4096; ++k, ++block) {
+                size_t p = static_cast<size_t>((value >> (k * bitsPerState)) & mask);
+                if (p < paletteSize && stats.paletteSolid[p]) ++solid;
+            }
+        }
+        return solid;
+    }
+}
+
+static double EstimateChunkFacesFromSections(int chunkX, int chunkZ, int sectionYStart, int sectionYEnd) {
+    const int sectionCount = sectionYEnd - sectionYStart + 1;
+    if (sectionCount <= 0 || !HasChunk(chunkX, chunkZ)) return 0.0;
+    int regionX, regionZ;
+    chunkToRegion(chunkX, chunkZ, regionX, regionZ);
+    std::vector<char> chunkData = GetChunkNBTData(GetRegionFromCache(regionX, regionZ), chunkX, chunkZ);
+    if (chunkData.empty()) return 0.0;
+
+    // 各子区块的实心比例,缺失的子区块视为空气
+    std::vector<double> fill(sectionCount, 0.0);
+    NbtScanner scan{ chunkData };
+    if (scan.U8() != static_cast<uint8_t>(TagType::COMPOUND)) return 0.0;
+    size_t rootNameLength;
+    scan.Str(rootNameLength);
+    while (scan.ok) {
+        uint8_t type = scan.U8();
+        if (type == 0) break;
+        size_t nameLength;
+        size_t name = scan.Str(nameLength);
+        if (type != static_cast<uint8_t>(TagType::LIST) || !scan.NameIs(name, nameLength, "sections")) {
+            scan.Skip(type);
+            continue;
+        }
+        uint8_t elemType = scan.U8();
+        uint32_t count = scan.U32();
+        for (uint32_t i = 0; i < count && scan.ok; ++i) {
+            if (elemType != static_cast<uint8_t>(TagType::COMPOUND)) { scan.Skip(elemType); continue; }
+            SectionStats stats;
+            while (scan.ok) {
+                uint8_t fieldType = scan.U8();
+                if (fieldType == 0) break;
+                size_t fieldLength;
+                size_t field = scan.Str(fieldLength);
+                if (fieldType == static_cast<uint8_t>(TagType::BYTE) && scan.NameIs(field, fieldLength, "Y")) {
+                    stats.y = static_cast<int8_t>(scan.U8());
+                }
+                else if (fieldType == static_cast<uint8_t>(TagType::COMPOUND) && scan.NameIs(field, fieldLength, "block_states")) {
+                    ScanBlockStates(scan, stats);
+                }
+                else {
+                    scan.Skip(fieldType);
+                }
+            }
+            if (scan.ok && stats.y >= sectionYStart && stats.y <= sectionYEnd) {
+                fill[stats.y - sectionYStart] = CountSolidBlocks(chunkData, stats) / 4096.0;
+            }
+        }
+        break;
+    }
+
+    // 相邻子区块(含列的上下端)之间按实心比例之差计为水平界面;
+    // 部分填充的子区块内部至少有一层地表,另按空实混合程度估算洞穴与地形起伏带来的面
+    double faces = 256.0 * (fill.front() + fill.back());
+    for (int i = 0; i < sectionCount; ++i) {
+        double f = fill[i];
+        if (i > 0) faces += 256.0 * std::abs(f - fill[i - 1]);
+        if (f > 0.0 && f < 1.0) faces += 256.0 + 2048.0 * std::min(f, 1.0 - f);
+    }
+    return faces;
+}
+
+// 相对LOD0的面数系数:LOD1 去掉了复杂模型,更大的方块尺寸按表面积平方缩小
+static double LODFaceFactor(float lod) {
+    if (lod <= 0.0f) return 1.0;
+    if (lod <= 1.0f) return 0.8;
+    return 0.8 / (static_cast<double>(lod) * lod);
+}
+
+// 各LOD等级的几何误差(以方块为单位)
+static double LODGeometricError(float lod) {
+    if (lod <= 0.0f) return 0.0;
+    if (lod <= 1.0f) return 0.5;
+    return lod;
+}
+
+struct LODQuadNode {
+    int x0, z0, size;  // 区块坐标与边长(区块数)
+    int levelIdx;      // 在可用LOD列表中的索引(0为最精细)
+    bool isLeaf;
+};
+
+static bool CalculateChunkLODsByBudget(int expandedChunkXStart, int expandedChunkXEnd, int expandedChunkZStart, int expandedChunkZEnd,
+    int sectionYStart, int sectionYEnd) {
+    // 预算统一换算为面数(每个四边形面 = 2 个三角形)
+    double faceBudget = 0.0;
+    if (config.lodTriangleBudget > 0) faceBudget = config.lodTriangleBudget / 2.0;
+    if (config.lodByteBudget > 0) {
+        double byByte = config.lodByteBudget / std::max(1.0, config.lodObjBytesPerFace);
+        faceBudget = (faceBudget > 0.0) ? std::min(faceBudget, byByte) : byByte;
+    }
+    if (faceBudget <= 0.0) {
+        std::cerr << "警告: useLODBudget 已启用但未设置预算,回退到距离环LOD" << std::endl;
+        return false;
+    }
+
+    // 可用LOD等级(由精细到粗糙)
+    std::vector<float> levels;
+    if (config.LOD0renderDistance > 0) levels.push_back(0.0f);
+    levels.push_back(1.0f);
+    if (config.activeLOD2) levels.push_back(2.0f);
+    if (config.activeLOD3) levels.push_back(4.0f);
+    if (config.activeLOD4) levels.push_back(8.0f);
+
+    const int width = expandedChunkXEnd - expandedChunkXStart + 1;
+    const int depth = expandedChunkZEnd - expandedChunkZStart + 1;
+
+    // 先在当前线程读入涉及的 region 文件(区域缓存本身不加锁),之后并行统计各区块的子区块面数
+    {
+        int regionXStart, regionZStart, regionXEnd, regionZEnd;
+        chunkToRegion(expandedChunkXStart, expandedChunkZStart, regionXStart, regionZStart);
+        chunkToRegion(expandedChunkXEnd, expandedChunkZEnd, regionXEnd, regionZEnd);
+        for (int rx = regionXStart; rx <= regionXEnd; ++rx) {
+            for (int rz = regionZStart; rz <= regionZEnd; ++rz) {
+                // 不存在的 region 文件不读取,避免报错并在缓存中留下空数据
+                if (HasRegionFile(rx, rz)) GetRegionFromCache(rx, rz);
+            }
+        }
+    }
+    std::vector<double> chunkFaces(static_cast<size_t>(width) * depth, 0.0);
+    {
+        std::atomic<size_t> nextChunk{ 0 };
+        unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&]() {
+                for (size_t i = nextChunk++; i < chunkFaces.size(); i = nextChunk++) {
+                    int ix = static_cast<int>(i % width);
+                    int iz = static_cast<int>(i / width);
+                    chunkFaces[i] = EstimateChunkFacesFromSections(expandedChunkXStart + ix, expandedChunkZStart + iz,
+                        sectionYStart, sectionYEnd);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+    }
+
+    // 每区块LOD0面数估算的二维前缀和,用于O(1)查询任意节点
+    std::vector<double> sat(static_cast<size_t>(width + 1) * (depth + 1), 0.0);
+    auto satAt = [&](int ix, int iz) -> double& { return sat[static_cast<size_t>(iz) * (width + 1) + ix]; };
+    for (int iz = 0; iz < depth; ++iz) {
+        double rowSum = 0.0;
+        for (int ix = 0; ix < width; ++ix) {
+            rowSum += chunkFaces[static_cast<size_t>(iz) * width + ix];
+            satAt(ix + 1, iz + 1) = satAt(ix + 1, iz) + rowSum;
+        }
+    }
+
+    // 节点与区域求交后的估算面数和面积
+    auto clipNode = [&](const LODQuadNode& n, int& ix0, int& iz0, int& ix1, int& iz1) {
+        ix0 = std::max(n.x0 - expandedChunkXStart, 0);
+        iz0 = std::max(n.z0 - expandedChunkZStart, 0);
+        ix1 = std::min(n.x0 + n.size - expandedChunkXStart, width);
+        iz1 = std::min(n.z0 + n.size - expandedChunkZStart, depth);
+        return ix0 < ix1 && iz0 < iz1;
+    };
+    auto nodeFaces = [&](const LODQuadNode& n, int levelIdx) -> double {
+        int ix0, iz0, ix1, iz1;
+        if (!clipNode(n, ix0, iz0, ix1, iz1)) return 0.0;
+        double base = satAt(ix1, iz1) - satAt(ix0, iz1) - satAt(ix1, iz0) + satAt(ix0, iz0);
+        return base * LODFaceFactor(levels[levelIdx]);
+    };
+    auto nodeArea = [&](const LODQuadNode& n) -> double {
+        int ix0, iz0, ix1, iz1;
+        if (!clipNode(n, ix0, iz0, ix1, iz1)) return 0.0;
+        return static_cast<double>(ix1 - ix0) * (iz1 - iz0);
+    };
+    // 节点到LOD中心的最近距离(区块)
+    auto nodeDistance = [&](const LODQuadNode& n) -> double {
+        double dx = std::max({ static_cast<double>(n.x0 - config.LODCenterX), 0.0, static_cast<double>(config.LODCenterX - (n.x0 + n.size - 1)) });
+        double dz = std::max({ static_cast<double>(n.z0 - config.LODCenterZ), 0.0, static_cast<double>(config.LODCenterZ - (n.z0 + n.size - 1)) });
+        return std::sqrt(dx * dx + dz * dz);
+    };
+    // 细化优先级:单位面数增量带来的屏幕误差下降
+    auto refinePriority = [&](const LODQuadNode& n) -> double {
+        float cur = levels[n.levelIdx];
+        float next = levels[n.levelIdx - 1];
+        double benefit = nodeArea(n) * (LODGeometricError(cur) - LODGeometricError(next)) / (nodeDistance(n) + 1.0);
+        double cost = nodeFaces(n, n.levelIdx - 1) - nodeFaces(n, n.levelIdx);
+        return benefit / std::max(cost, 1.0);
+    };
+
+    // 根节点:覆盖整个区域的2的幂正方形,初始为最粗糙等级
+    int rootSize = 1;
+    while (rootSize < std::max(width, depth)) rootSize <<= 1;
+    std::vector<LODQuadNode> nodes;
+    nodes.push_back({ expandedChunkXStart, expandedChunkZStart, rootSize, static_cast<int>(levels.size()) - 1, true });
+    double totalFaces = nodeFaces(nodes[0], nodes[0].levelIdx);
+
+    using QueueItem = std::pair<double, size_t>;
+    std::priority_queue<QueueItem> queue;
+    auto pushNode = [&](size_t idx) {
+        if (nodes[idx].levelIdx > 0 && nodeArea(nodes[idx]) > 0.0) {
+            queue.emplace(refinePriority(nodes[idx]), idx);
+        }
+    };
+    // 分裂为四个子节点,子节点使用给定等级
+    auto splitNode = [&](size_t idx, int childLevel) {
+        LODQuadNode parent = nodes[idx];
+        nodes[idx].isLeaf = false;
+        int half = parent.size / 2;
+        for (int c = 0; c < 4; ++c) {
+            LODQuadNode child{ parent.x0 + (c & 1) * half, parent.z0 + (c >> 1) * half, half, childLevel, true };
+            if (nodeArea(child) <= 0.0) continue;
+            nodes.push_back(child);
+            pushNode(nodes.size() - 1);
+        }
+    };
+    pushNode(0);
+
+    // 贪心细化,直到预算用尽
+    while (!queue.empty()) {
+        size_t idx = queue.top().second;
+        queue.pop();
+        LODQuadNode n = nodes[idx];
+        double delta = nodeFaces(n, n.levelIdx - 1) - nodeFaces(n, n.levelIdx);
+        bool fits = totalFaces + delta <= faceBudget;
+
+        // 节点相对距离过大或整体细化超出预算时,先等级不变地拆分以获得更细的粒度
+        if (n.size > 1 && (n.size * 2 > nodeDistance(n) || !fits)) {
+            splitNode(idx, n.levelIdx);
+            continue;
+        }
+        if (!fits) continue;
+
+        totalFaces += delta;
+        if (n.size > 1) {
+            splitNode(idx, n.levelIdx - 1);
+        }
+        else {
+            nodes[idx].levelIdx--;
+            pushNode(idx);
+        }
+    }
+
+    // 写回每个区块的LOD等级
+    {
+        size_t effectiveXCount = (expandedChunkXEnd - expandedChunkXStart + 1);
+        size_t effectiveZCount = (expandedChunkZEnd - expandedChunkZStart + 1);
+        size_t secCount = sectionYEnd - sectionYStart + 1;
+        std::unique_lock<std::shared_mutex> lock(g_chunkSectionInfoMapMutex);
+        g_chunkSectionInfoMap.reserve(effectiveXCount * effectiveZCount * secCount);
+        for (const auto& n : nodes) {
+            if (!n.isLeaf) continue;
+            int ix0, iz0, ix1, iz1;
+            if (!clipNode(n, ix0, iz0, ix1, iz1)) continue;
+            for (int ix = ix0; ix < ix1; ++ix) {
+                for (int iz = iz0; iz < iz1; ++iz) {
+                    for (int sy = sectionYStart; sy <= sectionYEnd; ++sy) {
+                        g_chunkSectionInfoMap[std::make_tuple(expandedChunkXStart + ix, sy, expandedChunkZStart + iz)].lodLevel = levels[n.levelIdx];
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "LOD预算选择: 估算三角形 " << static_cast<size_t>(totalFaces * 2.0)
+        << " / 预算 " << static_cast<size_t>(faceBudget * 2.0) << std::endl;
+    return true;
+}
+
 void ChunkLoader::CalculateChunkLODs(int expandedChunkXStart, int expandedChunkXEnd, int expandedChunkZStart, int expandedChunkZEnd,
     int sectionYStart, int sectionYEnd) {
+    // 预算模式:按三角形/字节预算选择LOD
+    if (config.activeLOD && config.useLODBudget &&
+        CalculateChunkLODsByBudget(expandedChunkXStart, expandedChunkXEnd, expandedChunkZStart, expandedChunkZEnd, sectionYStart, sectionYEnd)) {
+        return;
+    }
+
     // 计算LOD范围
     const int L0 = config.LOD0renderDistance;
     const int L1 = L0 + config.LOD1renderDistance;
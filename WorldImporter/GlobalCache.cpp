@@ -18,6 +18,7 @@
 // GlobalCache.cpp
 #include "GlobalCache.h"
 #include "JarReader.h"
+#include "AssetCache.h"
 #include "fileutils.h"
 #include <iostream>
 #include <filesystem> 
@@ -26,6 +27,10 @@
 #include <thread>
 #include <future>
 #include <queue>
+#include <deque>
+#include <condition_variable>
+#include <algorithm>
+#include <memory>
 #include <atomic>
 #include "include/json.hpp"
 #include <fstream>
@@ -45,7 +50,7 @@ std::unordered_set<std::string> fluidBlocks;  // 流体方块集合
 // ========= 全局缓存命名空间 =========
 namespace GlobalCache {
     // 缓存数据结构
-    std::unordered_map<std::string, std::vector<unsigned char>> textures;    // 材质缓存
+    std::unordered_map<std::string, ArchiveEntryRef> textures;               // 材质索引(按需解压)
     std::unordered_map<std::string, nlohmann::json> mcmetaCache;             // 材质元数据缓存
     std::unordered_map<std::string, nlohmann::json> blockstates;             // 方块状态缓存
     std::unordered_map<std::string, nlohmann::json> models;                  // 模型缓存
@@ -61,20 +66,128 @@ namespace GlobalCache {
     std::atomic<bool> stopFlag{ false };   // 控制工作线程停止标志
     std::queue<std::wstring> jarQueue;     // JAR文件路径队列
     std::vector<std::string> jarOrder;     // JAR文件加载顺序和对应的模组ID
+    std::vector<std::wstring> archivePaths; // 与 jarOrder 对应的归档路径
+
+    // 覆盖关系解析后的资源索引
+    ResolvedIndex<ArchiveEntryRef> resolvedTextures;
+    ResolvedIndex<nlohmann::json> resolvedMcmetas;
+    ResolvedIndex<nlohmann::json> resolvedBlockstates;
+    ResolvedIndex<nlohmann::json> resolvedModels;
+    ResolvedIndex<nlohmann::json> resolvedBiomes;
+    ResolvedIndex<std::vector<unsigned char>> resolvedColormaps;
+}
+
+/**
+ * @brief 按 jarOrder 优先级解析资源覆盖关系
+ * 缓存键格式为 "modId:namespace:path",jarOrder 中靠前的归档优先(资源包 > 模组 > 原版),
+ * 与逐个遍历 jarOrder 查找时的结果一致
+ */
+template <typename T>
+static void BuildResolvedIndex(const std::unordered_map<std::string, T>& source,
+    const std::unordered_map<std::string, size_t>& jarPriority,
+    GlobalCache::ResolvedIndex<T>& index) {
+    std::unordered_map<std::string, size_t> chosenPriority;
+    index.clear();
+    index.reserve(source.size());
+    chosenPriority.reserve(source.size());
+    for (const auto& entry : source) {
+        size_t colonPos = entry.first.find(':');
+        if (colonPos == std::string::npos) continue;
+        auto priorityIt = jarPriority.find(entry.first.substr(0, colonPos));
+        if (priorityIt == jarPriority.end()) continue;
+        std::string resourceKey = entry.first.substr(colonPos + 1);
+
+        auto chosenIt = chosenPriority.find(resourceKey);
+        if (chosenIt == chosenPriority.end()) {
+            chosenPriority.emplace(resourceKey, priorityIt->second);
+            index.emplace(std::move(resourceKey), &entry);
+        }
+        else if (priorityIt->second < chosenIt->second) {
+            chosenIt->second = priorityIt->second;
+            index[resourceKey] = &entry;
+        }
+    }
+}
+
+/**
+ * @brief 归档句柄池
+ * libzip 的句柄不能被多个线程同时使用,按归档保存空闲句柄,
+ * 读取时借出、读完归还,并发读取同一归档时按需打开新句柄
+ */
+class ArchiveHandlePool {
+public:
+    ~ArchiveHandlePool() {
+        for (auto& handles : idleHandles) {
+            for (zip_t* handle : handles) {
+                zip_close(handle);
+            }
+        }
+    }
+
+    zip_t* Acquire(uint32_t archiveIndex) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (archiveIndex < idleHandles.size() && !idleHandles[archiveIndex].empty()) {
+                zip_t* handle = idleHandles[archiveIndex].back();
+                idleHandles[archiveIndex].pop_back();
+                return handle;
+            }
+        }
+        if (archiveIndex >= GlobalCache::archivePaths.size()) return nullptr;
+        int error = 0;
+        zip_t* handle = zip_open(wstring_to_string(GlobalCache::archivePaths[archiveIndex]).c_str(), ZIP_RDONLY, &error);
+        if (!handle) {
+            std::cerr << "Failed to reopen archive: " << wstring_to_string(GlobalCache::archivePaths[archiveIndex])
+                << ", error code: " << error << std::endl;
+        }
+        return handle;
+    }
+
+    void Release(uint32_t archiveIndex, zip_t* handle) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (idleHandles.size() <= archiveIndex) {
+            idleHandles.resize(archiveIndex + 1);
+        }
+        idleHandles[archiveIndex].push_back(handle);
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::vector<zip_t*>> idleHandles;
+};
+
+static ArchiveHandlePool archiveHandlePool;
+
+bool GlobalCache::LoadTexture(const std::string& cacheKey, std::vector<unsigned char>& outData) {
+    // 初始化完成后纹理索引只读,无需加锁
+    auto it = textures.find(cacheKey);
+    if (it == textures.end()) return false;
+    const ArchiveEntryRef& ref = it->second;
+
+    zip_t* handle = archiveHandlePool.Acquire(ref.archiveIndex);
+    if (!handle) return false;
+
+    bool success = false;
+    zip_file_t* file = zip_fopen_index(handle, ref.entryIndex, 0);
+    if (file) {
+        outData.resize(static_cast<size_t>(ref.size));
+        success = zip_fread(file, outData.data(), ref.size) == static_cast<zip_int64_t>(ref.size);
+        zip_fclose(file);
+    }
+    archiveHandlePool.Release(ref.archiveIndex, handle);
+
+    if (!success) {
+        outData.clear();
+        std::cerr << "Failed to read texture from archive: " << cacheKey << std::endl;
+    }
+    return success;
 }
 
 /**
  * @brief 每个JAR文件资源处理任务的结果数据结构
  * 存储从单个JAR文件中提取的所有资源
  */
-struct TaskResult {
-    std::unordered_map<std::string, std::vector<unsigned char>> localTextures;    // 本地材质
-    std::unordered_map<std::string, nlohmann::json> localBlockstates;             // 本地方块状态
-    std::unordered_map<std::string, nlohmann::json> localModels;                  // 本地模型
-    std::unordered_map<std::string, nlohmann::json> localMcmetas;                 // 本地材质元数据
-    std::unordered_map<std::string, nlohmann::json> localBiomes;                  // 本地生物群系
-    std::unordered_map<std::string, std::vector<unsigned char>> localColormaps;   // 本地颜色映射
-};
+using TaskResult = ArchiveResources;
 
 //========== 辅助函数 ==========
 
@@ -172,8 +285,11 @@ void InitializeAllCaches() {
                                 std::string modStr = wstring_to_string(entry.path().filename().wstring());
                                 //判断是否以.jar结尾
                                 if (modStr.length() > 4 && modStr.substr(modStr.length() - 4) == ".jar") {
-                                    // 获取模组ID或使用文件名作为备用ID
-                                    std::string modid = GetModIdFromJar(modPath);
+                                    // 获取模组ID或使用文件名作为备用ID(优先读取持久化缓存,避免打开JAR)
+                                    std::string modid;
+                                    if (!AssetCache::TryLoadModId(modPath, modid)) {
+                                        modid = GetModIdFromJar(modPath);
+                                    }
                                     if (modid.empty()) {
                                         modid = modStr.substr(0, modStr.length() - 4); // 移除.jar后缀
                                     }
@@ -206,46 +322,173 @@ void InitializeAllCaches() {
         }
 
         size_t taskCount = jarPaths.size();
+        GlobalCache::archivePaths = jarPaths;
 
         // 用 vector 保存所有任务的结果,顺序与 jarPaths 和 jarOrder 对应
         std::vector<TaskResult> taskResults(taskCount);
-        std::atomic<size_t> atomicIndex{ 0 };
+        std::atomic<size_t> cachedArchives{ 0 };
+        const unsigned numThreads = std::max<unsigned>(1, std::thread::hardware_concurrency());
 
-        // 工作线程函数：处理JAR文件并提取资源
+        // 大归档按条目区间拆分为多个子任务:每个子任务使用独立的 zip 句柄写入独立的局部结果,
+        // 最后完成的子任务按区间顺序合并(与顺序读取时"先出现者优先"一致)并写入持久化缓存
+        constexpr zip_int64_t kSplitEntryCount = 4096;  // 超过该条目数的归档才拆分
+        struct ArchiveTask {
+            size_t archiveIndex = 0;
+            int rangeIndex = -1;          // -1 表示尚未拆分的整个归档
+            zip_int64_t entryBegin = 0;
+            zip_int64_t entryEnd = -1;
+        };
+        struct ArchiveSplitState {
+            std::vector<TaskResult> partials;
+            std::atomic<int> remaining{ 0 };
+        };
+        std::vector<ArchiveSplitState> splitStates(taskCount);
+        std::deque<ArchiveTask> taskQueue;
+        std::mutex taskQueueMutex;
+        std::condition_variable taskQueueCv;
+        size_t pendingSplits = 0;  // 正在决定是否拆分的归档数,期间空闲线程等待而不退出
+
+        // 按归档大小降序入队,让最大的归档尽早拆分,缩短关键路径
+        {
+            std::vector<std::pair<uintmax_t, size_t>> bySize;
+            bySize.reserve(taskCount);
+            for (size_t i = 0; i < taskCount; ++i) {
+                std::error_code ec;
+                uintmax_t size = std::filesystem::file_size(jarPaths[i], ec);
+                bySize.emplace_back(ec ? 0 : size, i);
+            }
+            std::stable_sort(bySize.begin(), bySize.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+            for (const auto& entry : bySize) {
+                ArchiveTask task;
+                task.archiveIndex = entry.second;
+                taskQueue.push_back(task);
+            }
+        }
+
+        // 子任务完成:最后一个完成的子任务负责合并并写入持久化缓存
+        auto finishRange = [&](size_t idx) {
+            ArchiveSplitState& state = splitStates[idx];
+            if (state.remaining.fetch_sub(1) != 1) return;
+
+            TaskResult& merged = taskResults[idx];
+            merged = std::move(state.partials[0]);
+            for (size_t r = 1; r < state.partials.size(); ++r) {
+                TaskResult& part = state.partials[r];
+                merged.localTextures.insert(part.localTextures.begin(), part.localTextures.end());
+                merged.localBlockstates.insert(std::make_move_iterator(part.localBlockstates.begin()), std::make_move_iterator(part.localBlockstates.end()));
+                merged.localModels.insert(std::make_move_iterator(part.localModels.begin()), std::make_move_iterator(part.localModels.end()));
+                merged.localMcmetas.insert(std::make_move_iterator(part.localMcmetas.begin()), std::make_move_iterator(part.localMcmetas.end()));
+                merged.localBiomes.insert(std::make_move_iterator(part.localBiomes.begin()), std::make_move_iterator(part.localBiomes.end()));
+                merged.localColormaps.insert(std::make_move_iterator(part.localColormaps.begin()), std::make_move_iterator(part.localColormaps.end()));
+            }
+            state.partials.clear();
+            state.partials.shrink_to_fit();
+            AssetCache::Store(jarPaths[idx], GlobalCache::jarOrder[idx], merged);
+        };
+
+        // 读取一个条目区间的资源
+        auto processRange = [&](const ArchiveTask& task, JarReader& reader) {
+            TaskResult& result = splitStates[task.archiveIndex].partials[task.rangeIndex];
+            try {
+                reader.cacheAllResources(
+                    result.localTextures,
+                    result.localBlockstates,
+                    result.localModels,
+                    result.localMcmetas,
+                    result.localBiomes,
+                    result.localColormaps,
+                    task.entryBegin,
+                    task.entryEnd
+                );
+            } catch (const std::exception& e) {
+                std::cerr << "Error processing jar file for " << GlobalCache::jarOrder[task.archiveIndex]
+                          << ": " << e.what() << std::endl;
+            }
+            finishRange(task.archiveIndex);
+        };
+
+        // 工作线程函数：处理JAR文件(或其条目区间)并提取资源
         auto worker = [&]() {
             while (true) {
-                size_t idx = atomicIndex.fetch_add(1);
-                if (idx >= taskCount)
-                    break;  // 所有任务已分配完毕
+                ArchiveTask task;
+                {
+                    std::unique_lock<std::mutex> lock(taskQueueMutex);
+                    taskQueueCv.wait(lock, [&]() { return !taskQueue.empty() || pendingSplits == 0; });
+                    if (taskQueue.empty())
+                        break;  // 所有任务已分配完毕
+                    task = taskQueue.front();
+                    taskQueue.pop_front();
+                    if (task.rangeIndex < 0) ++pendingSplits;
+                }
+
+                size_t idx = task.archiveIndex;
+                const std::wstring& jarPath = jarPaths[idx];
+                const std::string& currentModId = GlobalCache::jarOrder[idx];
 
-                std::wstring jarPath = jarPaths[idx];
-                std::string currentModId = GlobalCache::jarOrder[idx];
+                if (task.rangeIndex >= 0) {
+                    // 拆分出的子区间:使用独立句柄读取
+                    JarReader reader(jarPath);
+                    if (!reader.open()) {
+                        std::cerr << "Warning: Failed to open jar range, skipping resources for: " << currentModId << std::endl;
+                        finishRange(idx);
+                        continue;
+                    }
+                    processRange(task, reader);
+                    continue;
+                }
 
-                JarReader reader(jarPath);
-                if (!reader.open()) {
-                    std::cerr << "Warning: Failed to open jar, skipping resources for: " << currentModId << std::endl;
-                    continue;  // 跳过此JAR文件
+                // 整个归档:归档未变化时直接读取持久化缓存,跳过解压和JSON解析
+                std::unique_ptr<JarReader> reader;
+                zip_int64_t numEntries = 0;
+                std::string cachedModId;
+                if (AssetCache::TryLoad(jarPath, cachedModId, taskResults[idx]) && cachedModId == currentModId) {
+                    cachedArchives.fetch_add(1);
                 }
-                
-                try {
-                    // 读取所有资源类型并存入结果
-                    reader.cacheAllResources(
-                        taskResults[idx].localTextures,
-                        taskResults[idx].localBlockstates,
-                        taskResults[idx].localModels,
-                        taskResults[idx].localMcmetas,
-                        taskResults[idx].localBiomes,
-                        taskResults[idx].localColormaps
-                    );
-                } catch (const std::exception& e) {
-                    std::cerr << "Error processing jar file for " << currentModId 
-                              << ": " << e.what() << std::endl;
+                else {
+                    taskResults[idx] = TaskResult();
+                    reader = std::make_unique<JarReader>(jarPath);
+                    if (reader->open()) {
+                        numEntries = reader->getEntryCount();
+                    }
+                    else {
+                        std::cerr << "Warning: Failed to open jar, skipping resources for: " << currentModId << std::endl;
+                        reader.reset();  // 跳过此JAR文件
+                    }
+                }
+
+                int rangeCount = 1;
+                if (reader && numEntries > kSplitEntryCount) {
+                    rangeCount = static_cast<int>(std::min<zip_int64_t>(numThreads, (numEntries + kSplitEntryCount - 1) / kSplitEntryCount));
+                }
+                auto rangeBound = [&](int r) { return numEntries * r / rangeCount; };
+                if (reader) {
+                    splitStates[idx].partials.resize(rangeCount);
+                    splitStates[idx].remaining.store(rangeCount);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(taskQueueMutex);
+                    --pendingSplits;
+                    for (int r = 1; reader && r < rangeCount; ++r) {
+                        ArchiveTask sub;
+                        sub.archiveIndex = idx;
+                        sub.rangeIndex = r;
+                        sub.entryBegin = rangeBound(r);
+                        sub.entryEnd = rangeBound(r + 1);
+                        taskQueue.push_back(sub);
+                    }
+                }
+                taskQueueCv.notify_all();
+
+                if (reader) {
+                    task.rangeIndex = 0;
+                    task.entryBegin = 0;
+                    task.entryEnd = rangeBound(1);
+                    processRange(task, *reader);
                 }
             }
             };
 
         // 创建工作线程池
-        const unsigned numThreads = std::max<unsigned>(1, std::thread::hardware_concurrency());
         std::vector<std::thread> threads;
         threads.reserve(numThreads);
         GlobalCache::stopFlag.store(false);
@@ -278,7 +521,9 @@ void InitializeAllCaches() {
                 for (auto& pair : result.localTextures) {
                     std::string cacheKey = currentModId + ":" + pair.first;
                     if (GlobalCache::textures.find(cacheKey) == GlobalCache::textures.end()) {
-                        GlobalCache::textures.insert({ cacheKey, pair.second });
+                        ArchiveEntryRef ref = pair.second;
+                        ref.archiveIndex = static_cast<uint32_t>(i);
+                        GlobalCache::textures.insert({ cacheKey, ref });
                     }
                 }
                 // 合并方块状态
@@ -319,11 +564,26 @@ void InitializeAllCaches() {
             }
         }
 
+        // 解析覆盖关系,之后的资源查找只读且无需加锁
+        {
+            std::unordered_map<std::string, size_t> jarPriority;
+            for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
+                jarPriority.emplace(GlobalCache::jarOrder[i], i);  // 重复的模组ID以首次出现为准
+            }
+            BuildResolvedIndex(GlobalCache::textures, jarPriority, GlobalCache::resolvedTextures);
+            BuildResolvedIndex(GlobalCache::mcmetaCache, jarPriority, GlobalCache::resolvedMcmetas);
+            BuildResolvedIndex(GlobalCache::blockstates, jarPriority, GlobalCache::resolvedBlockstates);
+            BuildResolvedIndex(GlobalCache::models, jarPriority, GlobalCache::resolvedModels);
+            BuildResolvedIndex(GlobalCache::biomes, jarPriority, GlobalCache::resolvedBiomes);
+            BuildResolvedIndex(GlobalCache::colormaps, jarPriority, GlobalCache::resolvedColormaps);
+        }
+
         // 输出加载统计信息
         auto end = std::chrono::high_resolution_clock::now();
         auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         std::cout << "Parallel Cache Initialization Complete\n"
             << " - Used threads: " << numThreads << "\n"
+            << " - Archives from asset cache: " << cachedArchives.load() << "/" << taskCount << "\n"
             << " - Textures: " << GlobalCache::textures.size() << "\n"
             << " - Mcmetas: " << GlobalCache::mcmetaCache.size() << "\n"
             << " - Blockstates: " << GlobalCache::blockstates.size() << "\n"
@@ -1,3 +1,4 @@
+#pragma once
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -16,8 +17,8 @@ extern std::unordered_set<std::string> fluidBlocks;
 
 // ========= 全局缓存声明 =========
 namespace GlobalCache {
-	// 纹理缓存 [namespace:resource_path -> PNG数据]
-	extern std::unordered_map<std::string, std::vector<unsigned char>> textures;
+	// 纹理索引 [namespace:resource_path -> 归档内位置],数据通过 LoadTexture 按需解压
+	extern std::unordered_map<std::string, ArchiveEntryRef> textures;
 
 	//动态材质缓存 [namespace:resource_path -> JSON]
 	extern std::unordered_map<std::string, nlohmann::json> mcmetaCache;
@@ -38,6 +39,30 @@ namespace GlobalCache {
 	extern std::once_flag initFlag;
 	extern std::mutex cacheMutex;
 	extern std::vector<std::string> jarOrder;
+	extern std::vector<std::wstring> archivePaths;  // 与 jarOrder 对应的归档路径
+
+	// 覆盖关系解析后的资源索引 [namespace:resource_path -> 生效条目(完整缓存键, 数据)]
+	// 初始化时按 jarOrder 优先级一次性解析,之后只读,查找无需加锁
+	template <typename T>
+	using ResolvedIndex = std::unordered_map<std::string, const std::pair<const std::string, T>*>;
+
+	extern ResolvedIndex<ArchiveEntryRef> resolvedTextures;
+	extern ResolvedIndex<nlohmann::json> resolvedMcmetas;
+	extern ResolvedIndex<nlohmann::json> resolvedBlockstates;
+	extern ResolvedIndex<nlohmann::json> resolvedModels;
+	extern ResolvedIndex<nlohmann::json> resolvedBiomes;
+	extern ResolvedIndex<std::vector<unsigned char>> resolvedColormaps;
+
+	// 查找生效资源,未找到时返回 nullptr
+	template <typename T>
+	const std::pair<const std::string, T>* FindResolved(const ResolvedIndex<T>& index,
+		const std::string& namespaceName, const std::string& resourcePath) {
+		auto it = index.find(namespaceName + ":" + resourcePath);
+		return (it != index.end()) ? it->second : nullptr;
+	}
+
+	// 读取纹理PNG数据(首次使用时从归档解压,线程安全),未找到时返回 false
+	bool LoadTexture(const std::string& cacheKey, std::vector<unsigned char>& outData);
 }
 
 
@@ -12,6 +12,7 @@ extern "C" {
 #include <vector>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
 #include "include/json.hpp"
 #include "fileutils.h"
 namespace {
@@ -163,12 +164,14 @@ std::vector<unsigned char> JarReader::getBinaryFileContent(const std::string& fi
 }
 
 void JarReader::cacheAllResources(
-    std::unordered_map<std::string, std::vector<unsigned char>>& textureCache,
+    std::unordered_map<std::string, ArchiveEntryRef>& textureCache,
     std::unordered_map<std::string, nlohmann::json>& blockstateCache,
     std::unordered_map<std::string, nlohmann::json>& modelCache,
     std::unordered_map<std::string, nlohmann::json>& mcmetaCache,
     std::unordered_map<std::string, nlohmann::json>& biomeCache,
-    std::unordered_map<std::string, std::vector<unsigned char>>& colormapCache)
+    std::unordered_map<std::string, std::vector<unsigned char>>& colormapCache,
+    zip_int64_t entryBegin,
+    zip_int64_t entryEnd)
 {
     if (!zipFile) {
         std::cerr << "Zip file is not open." << std::endl;
@@ -177,7 +180,8 @@ void JarReader::cacheAllResources(
 
 
     zip_int64_t numEntries = zip_get_num_entries(zipFile, 0);
-    for (zip_int64_t i = 0; i < numEntries; ++i) {
+    if (entryEnd < 0 || entryEnd > numEntries) entryEnd = numEntries;
+    for (zip_int64_t i = std::max<zip_int64_t>(entryBegin, 0); i < entryEnd; ++i) {
         const char* name = zip_get_name(zipFile, i, 0);
         if (!name) continue;
 
@@ -217,17 +221,14 @@ void JarReader::cacheAllResources(
                     std::string resourcePath = filePath.substr(resStart, filePath.size() - resStart - 4);
                     std::string cacheKey = namespaceName + ":" + resourcePath;
 
+                    // 只记录条目位置,纹理数据在首次使用时再解压
                     if (textureCache.find(cacheKey) == textureCache.end()) {
-                        zip_file_t* file = zip_fopen_index(zipFile, i, 0);
-                        if (file) {
-                            zip_stat_t fileStat;
-                            if (zip_stat_index(zipFile, i, 0, &fileStat) == 0) {
-                                std::vector<unsigned char> data(fileStat.size);
-                                if (zip_fread(file, data.data(), fileStat.size) == fileStat.size) {
-                                    textureCache.emplace(cacheKey, std::move(data));
-                                }
-                            }
-                            zip_fclose(file);
+                        zip_stat_t fileStat;
+                        if (zip_stat_index(zipFile, i, 0, &fileStat) == 0 && (fileStat.valid & ZIP_STAT_SIZE)) {
+                            ArchiveEntryRef ref;
+                            ref.entryIndex = static_cast<uint64_t>(i);
+                            ref.size = static_cast<uint64_t>(fileStat.size);
+                            textureCache.emplace(cacheKey, ref);
                         }
                     }
                 }
@@ -543,6 +544,11 @@ std::string JarReader::cleanUpContent(const std::string& content) {
     return cleaned;
 }
 
+zip_int64_t JarReader::getEntryCount() {
+    if (!zipFile) return 0;
+    return zip_get_num_entries(zipFile, 0);
+}
+
 bool JarReader::open() {
     if (zipFile) return true;
     int error;
@@ -4,9 +4,18 @@
 #include <zip.h>
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <unordered_map>
 #include "fileutils.h"
 #include "include/json.hpp"
 
+// 归档内条目的位置(启动时只记录位置,首次使用时再解压)
+struct ArchiveEntryRef {
+    uint32_t archiveIndex = 0;  // 归档序号(与 GlobalCache::jarOrder 对应,合并时填写)
+    uint64_t entryIndex = 0;    // zip 条目序号
+    uint64_t size = 0;          // 解压后字节数
+};
+
 class JarReader {
 public:
     bool open();
@@ -19,12 +28,17 @@ public:
     };
 
 	void cacheAllResources(
-		std::unordered_map<std::string, std::vector<unsigned char>>& textureCache,
+		std::unordered_map<std::string, ArchiveEntryRef>& textureCache,
 		std::unordered_map<std::string, nlohmann::json>& blockstateCache,
 		std::unordered_map<std::string, nlohmann::json>& modelCache,
 		std::unordered_map<std::string, nlohmann::json>& mcmetaCache,
 		std::unordered_map<std::string, nlohmann::json>& biomeCache,
-		std::unordered_map<std::string, std::vector<unsigned char>>& colormapCache);
+		std::unordered_map<std::string, std::vector<unsigned char>>& colormapCache,
+		zip_int64_t entryBegin = 0,
+		zip_int64_t entryEnd = -1);  // 只处理 [entryBegin, entryEnd) 区间内的条目,-1 表示到末尾
+
+    // 获取归档中的条目数量
+    zip_int64_t getEntryCount();
 
     // 构造函数,接受 .jar 文件路径
     JarReader(const std::wstring& jarFilePath);
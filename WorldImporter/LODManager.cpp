@@ -15,20 +15,9 @@
 #include <iostream>
 #include <shared_mutex>
 #include <filesystem>
-
-#ifdef _WIN32
-// Windows平台需要的定义和函数声明
-extern "C" {
-    __declspec(dllimport) unsigned long __stdcall GetModuleFileNameA(void* hModule, char* lpFilename, unsigned long nSize);
-}
-#define MAX_PATH 260
-#elif defined(__unix__) || defined(__APPLE__)
-#include <limits.h>
-#define MAX_PATH PATH_MAX
-#ifdef __APPLE__
-#include <mach-o/dyld.h>
-#endif
-#endif
+#include <array>
+#include <algorithm>
+#include <climits>
 
 using namespace std;
 using namespace std::chrono;
@@ -38,94 +27,180 @@ std::unordered_map<std::tuple<int, int, int>, ChunkSectionInfo, TupleHash> g_chu
 // 线程安全:共享互斥量定义
 std::shared_mutex g_chunkSectionInfoMapMutex;
 
-// 缓存方块ID到颜色的映射
-std::unordered_map<std::string, std::string> blockColorCache;
+// 方块面颜色缓存条目:打包的平均颜色和该面使用的着色索引
+struct BlockColorCacheEntry {
+    uint32_t color;    // 0xRRGGBB
+    int8_t tintIndex;  // -1 表示不着色
+    uint16_t fluidId;  // 调色板流体ID,0 表示非流体
+};
+
+// 缓存 (方块ID, 面方向) 到颜色的映射
+std::unordered_map<uint64_t, BlockColorCacheEntry> blockColorCache;
 
 std::mutex blockColorCacheMutex;
 
-// 获取可执行文件路径的辅助函数
-std::string getExecutablePathForTexture() {
-    std::filesystem::path exePath;
-    
-    try {
-        #ifdef _WIN32
-        // Windows平台
-        char buffer[MAX_PATH] = { 0 };
-        if (GetModuleFileNameA(NULL, buffer, MAX_PATH) != 0) {
-            exePath = std::filesystem::path(buffer);
-        } else {
-            throw std::runtime_error("no exe");
-        }
-        #elif defined(__APPLE__)
-        // macOS平台
-        char buffer[MAX_PATH];
-        uint32_t size = sizeof(buffer);
-        if (_NSGetExecutablePath(buffer, &size) != 0) {
-            throw std::runtime_error("无法获取可执行文件路径");
-        }
-        exePath = std::filesystem::canonical(std::filesystem::path(buffer));
-        #else
-        // Linux平台
-        char buffer[MAX_PATH];
-        ssize_t len = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
-        if (len == -1) {
-            throw std::runtime_error("无法获取可执行文件路径");
-        }
-        buffer[len] = '\0';
-        exePath = std::filesystem::path(buffer);
-        #endif
-        
-        return exePath.string();
-    } catch (const std::exception& e) {
-        std::cerr << "获取可执行文件路径失败: " << e.what() << std::endl;
-        return std::filesystem::current_path().string(); // 失败时返回当前目录
+//============== LOD 颜色调色板 ==============//
+struct LODPaletteEntry {
+    uint32_t rgb;       // 0xRRGGBB
+    uint16_t fluidId;   // 0 表示非流体
+    Material material;  // 预生成的材质,名称沿用 "color#r g b=" / "color#r g b-流体名" 格式
+};
+
+static std::vector<LODPaletteEntry> lodPalette;
+static std::unordered_map<uint64_t, uint32_t> lodPaletteIndex; // (流体ID << 24 | 颜色) -> 调色板索引
+static std::vector<std::string> lodPaletteFluidNames{ "" };    // 流体ID -> 流体名称
+static std::unordered_map<std::string, uint16_t> lodPaletteFluidIds;
+static std::shared_mutex lodPaletteMutex;
+
+// 按配置的位数量化单个通道,并还原到 0-255 区间
+static inline uint32_t QuantizeLODChannel(uint32_t c, int bits) {
+    if (bits >= 8) return c;
+    const uint32_t levels = (1u << bits) - 1;
+    uint32_t q = (c * levels + 127) / 255;
+    return (q * 255 + levels / 2) / levels;
+}
+
+uint16_t LODManager::GetLODFluidId(const std::string& fluidName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(lodPaletteMutex);
+        auto it = lodPaletteFluidIds.find(fluidName);
+        if (it != lodPaletteFluidIds.end()) return it->second;
     }
+    std::unique_lock<std::shared_mutex> lock(lodPaletteMutex);
+    auto it = lodPaletteFluidIds.find(fluidName);
+    if (it != lodPaletteFluidIds.end()) return it->second;
+    uint16_t id = static_cast<uint16_t>(lodPaletteFluidNames.size());
+    lodPaletteFluidNames.push_back(fluidName);
+    lodPaletteFluidIds.emplace(fluidName, id);
+    return id;
 }
 
-std::string GetBlockAverageColor(int blockId, Block currentBlock, int x, int y, int z, const std::string& faceDirection, float gamma = 2.0) {
+uint32_t LODManager::GetLODColorIndex(uint32_t rgb, uint16_t fluidId) {
+    const int bits = std::clamp(config.lodColorQuantizeBits, 1, 8);
+    uint32_t r = QuantizeLODChannel((rgb >> 16) & 0xFF, bits);
+    uint32_t g = QuantizeLODChannel((rgb >> 8) & 0xFF, bits);
+    uint32_t b = QuantizeLODChannel(rgb & 0xFF, bits);
+    uint32_t quantized = (r << 16) | (g << 8) | b;
+    uint64_t key = (static_cast<uint64_t>(fluidId) << 24) | quantized;
 
-    Block b = GetBlockById(blockId);
-    std::string blockName = b.GetModifiedNameWithNamespace();
-    std::string ns = b.GetNamespace();
+    {
+        std::shared_lock<std::shared_mutex> lock(lodPaletteMutex);
+        auto it = lodPaletteIndex.find(key);
+        if (it != lodPaletteIndex.end()) return it->second;
+    }
 
-    size_t colonPos = blockName.find(':');
-    if (colonPos != std::string::npos) {
-        blockName = blockName.substr(colonPos + 1);
+    std::unique_lock<std::shared_mutex> lock(lodPaletteMutex);
+    auto it = lodPaletteIndex.find(key);
+    if (it != lodPaletteIndex.end()) return it->second;
+
+    // 调色板已满:优先映射到同一流体类型中最接近的颜色,没有同类颜色时退回任意类型中最接近的颜色
+    if (config.lodColorPaletteSize > 0 && lodPalette.size() >= static_cast<size_t>(config.lodColorPaletteSize)) {
+        uint32_t bestIndex = UINT32_MAX, bestAnyIndex = UINT32_MAX;
+        int bestDist = INT_MAX, bestAnyDist = INT_MAX;
+        for (size_t i = 0; i < lodPalette.size(); ++i) {
+            const LODPaletteEntry& e = lodPalette[i];
+            int dr = static_cast<int>((e.rgb >> 16) & 0xFF) - static_cast<int>(r);
+            int dg = static_cast<int>((e.rgb >> 8) & 0xFF) - static_cast<int>(g);
+            int db = static_cast<int>(e.rgb & 0xFF) - static_cast<int>(b);
+            int dist = dr * dr + dg * dg + db * db;
+            if (dist < bestAnyDist) {
+                bestAnyDist = dist;
+                bestAnyIndex = static_cast<uint32_t>(i);
+            }
+            if (e.fluidId == fluidId && dist < bestDist) {
+                bestDist = dist;
+                bestIndex = static_cast<uint32_t>(i);
+            }
+        }
+        if (bestIndex == UINT32_MAX) bestIndex = bestAnyIndex;
+        lodPaletteIndex.emplace(key, bestIndex);
+        return bestIndex;
     }
-    ModelData blockModel;
-    bool isFluid = (fluidDefinitions.find(currentBlock.GetNameAndNameSpaceWithoutState()) != fluidDefinitions.end());
-    if (isFluid && currentBlock.level > -1) {
-        AssignFluidMaterials(blockModel, currentBlock.name);
+
+    uint32_t index = static_cast<uint32_t>(lodPalette.size());
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(config.decimalPlaces);
+    oss << "color#" << r / 255.0f << " " << g / 255.0f << " " << b / 255.0f;
+    if (fluidId != 0) {
+        oss << "-" << lodPaletteFluidNames[fluidId];
     }
     else {
-        blockModel = GetRandomModelFromCache(ns, blockName);
+        oss << "=";
     }
-    std::string cacheKey = std::to_string(blockId) + ":" + faceDirection;
-    std::string textureAverage;
+    lodPalette.push_back({ quantized, fluidId, Material(oss.str(), "lodcolor#" + std::to_string(index), -1) });
+    lodPaletteIndex.emplace(key, index);
+    return index;
+}
+
+Material LODManager::GetLODColorMaterial(uint32_t index) {
+    std::shared_lock<std::shared_mutex> lock(lodPaletteMutex);
+    if (index < lodPalette.size()) return lodPalette[index].material;
+    return Material("default_color", "default_color", -1);
+}
+
+bool LODManager::GetLODPaletteColor(const std::string& texturePath, uint32_t& outRgb) {
+    static const std::string prefix = "lodcolor#";
+    if (texturePath.compare(0, prefix.size(), prefix) != 0) return false;
+    uint32_t index = 0;
+    for (size_t i = prefix.size(); i < texturePath.size(); ++i) {
+        char c = texturePath[i];
+        if (c < '0' || c > '9') return false;
+        index = index * 10 + static_cast<uint32_t>(c - '0');
+    }
+    std::shared_lock<std::shared_mutex> lock(lodPaletteMutex);
+    if (index >= lodPalette.size()) return false;
+    outRgb = lodPalette[index].rgb;
+    return true;
+}
+
+// 获取方块某个面的LOD颜色,返回调色板索引
+uint32_t GetBlockAverageColor(int blockId, int x, int y, int z, FaceType faceDirection) {
+    uint64_t cacheKey = (static_cast<uint64_t>(static_cast<uint32_t>(blockId)) << 8) | static_cast<uint64_t>(faceDirection);
+
+    BlockColorCacheEntry entry{ 0x808080u, -1, 0 };
+    bool cached = false;
 
     // 线程安全的缓存访问
     {
         std::lock_guard<std::mutex> lock(blockColorCacheMutex);
         auto it = blockColorCache.find(cacheKey);
         if (it != blockColorCache.end()) {
-            textureAverage = it->second;
+            entry = it->second;
+            cached = true;
         }
     }
 
-    // 声明materialIndex变量,使其在整个函数中可见
-    int materialIndex = -1;
-    
-    if (textureAverage.empty()) {
-        if (faceDirection == "none") {
+    if (!cached) {
+        Block b = GetBlockById(blockId);
+        std::string fluidName = b.GetNameAndNameSpaceWithoutState();
+        bool isFluid = (fluidDefinitions.find(fluidName) != fluidDefinitions.end());
+        if (isFluid) {
+            entry.fluidId = LODManager::GetLODFluidId(fluidName);
+        }
+
+        std::string blockName = b.GetModifiedNameWithNamespace();
+        std::string ns = b.GetNamespace();
+
+        size_t colonPos = blockName.find(':');
+        if (colonPos != std::string::npos) {
+            blockName = blockName.substr(colonPos + 1);
+        }
+        ModelData blockModel;
+        if (isFluid && b.level > -1) {
+            AssignFluidMaterials(blockModel, b.name);
+        }
+        else {
+            blockModel = GetRandomModelFromCache(ns, blockName);
+        }
+
+        int materialIndex = -1;
+        if (faceDirection == FaceType::UNKNOWN) {
             if (!blockModel.materials.empty()) materialIndex = 0;
         }
         else {
-            // 将字符串方向转换为枚举
-            FaceType targetType = StringToFaceType(faceDirection);
-            
             // 查找匹配的面
             for (size_t i = 0; i < blockModel.faces.size(); i++) {
-                if (blockModel.faces[i].faceDirection == targetType) {
+                if (blockModel.faces[i].faceDirection == faceDirection) {
                     materialIndex = blockModel.faces[i].materialIndex;
                     break;
                 }
@@ -133,119 +208,55 @@ std::string GetBlockAverageColor(int blockId, Block currentBlock, int x, int y,
         }
 
         if (materialIndex == -1 && !blockModel.materials.empty()) materialIndex = 0;
-        if (materialIndex == -1) return "color#0.50 0.50 0.50=";
-
-        std::string materialName = blockModel.materials[materialIndex].name;
-        std::string texturePath;
-        if (!blockModel.materials.empty()) texturePath = blockModel.materials[materialIndex].texturePath;
-
-        float r = 0.5f, g = 0.5f, b = 0.5f;
-        if (!texturePath.empty()) {
-            // 使用跨平台方式获取可执行文件路径
-            std::string exePath = getExecutablePathForTexture();
-            std::string exeDir = std::filesystem::path(exePath).parent_path().string();
-            texturePath = exeDir + "//" + texturePath;
-
-            int width, height, channels;
-            unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &channels, 0);
-            if (data) {
-                float sumR = 0, sumG = 0, sumB = 0;
-                int validPixelCount = 0;
-                for (int i = 0; i < width * height; ++i) {
-                    if (channels >= 4 && data[i * channels + 3] == 0) continue;
-                    float r_s = data[i * channels] / 255.0f;
-                    float g_s = data[i * channels + 1] / 255.0f;
-                    float b_s = data[i * channels + 2] / 255.0f;
-                    float r_lin = (r_s <= 0.04045f) ? (r_s / 12.92f) : pow((r_s + 0.055f) / 1.055f, 2.4f);
-                    float g_lin = (g_s <= 0.04045f) ? (g_s / 12.92f) : pow((g_s + 0.055f) / 1.055f, 2.4f);
-                    float b_lin = (b_s <= 0.04045f) ? (b_s / 12.92f) : pow((b_s + 0.055f) / 1.055f, 2.4f);
-                    sumR += r_lin;
-                    sumG += g_lin;
-                    sumB += b_lin;
-                    validPixelCount++;
-                }
-                if (validPixelCount > 0) {
-                    float avgR_lin = sumR / validPixelCount;
-                    float avgG_lin = sumG / validPixelCount;
-                    float avgB_lin = sumB / validPixelCount;
-                    avgR_lin = pow(avgR_lin, gamma);
-                    avgG_lin = pow(avgG_lin, gamma);
-                    avgB_lin = pow(avgB_lin, gamma);
-                    r = (avgR_lin <= 0.0031308f) ? (avgR_lin * 12.92f) : (1.055f * pow(avgR_lin, 1.0f / 2.4f) - 0.055f);
-                    g = (avgG_lin <= 0.0031308f) ? (avgG_lin * 12.92f) : (1.055f * pow(avgG_lin, 1.0f / 2.4f) - 0.055f);
-                    b = (avgB_lin <= 0.0031308f) ? (avgB_lin * 12.92f) : (1.055f * pow(avgB_lin, 1.0f / 2.4f) - 0.055f);
+        if (materialIndex >= 0 && materialIndex < static_cast<int>(blockModel.materials.size())) {
+            // 平均颜色在资源加载时已从内存中的纹理计算,缺失时使用中灰色
+            uint32_t packed;
+            int textureId = GetTextureIdFromMaterialPath(blockModel.materials[materialIndex].texturePath);
+            if (GetTextureAverageColor(textureId, packed)) {
+                entry.color = packed;
+            }
+
+            // 检查模型中是否有任何材质需要tint索引(群系着色),优先使用当前面的材质
+            entry.tintIndex = blockModel.materials[materialIndex].tintIndex;
+            if (entry.tintIndex == -1) {
+                for (const auto& material : blockModel.materials) {
+                    if (material.tintIndex != -1) {
+                        entry.tintIndex = material.tintIndex;
+                        break;
+                    }
                 }
-                stbi_image_free(data);
             }
         }
-
-        // 根据配置的小数位数格式化颜色字符串
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(config.decimalPlaces);
-        oss << r << " " << g << " " << b;
-        textureAverage = oss.str();
+        else {
+            // 没有可用材质:中灰色,且不区分流体
+            entry.fluidId = 0;
+        }
 
         // 更新缓存
         {
             std::lock_guard<std::mutex> lock(blockColorCacheMutex);
-            if (blockColorCache.find(cacheKey) == blockColorCache.end()) {
-                blockColorCache[cacheKey] = textureAverage;
-            }
+            blockColorCache.emplace(cacheKey, entry);
         }
     }
 
-    char finalColorStr[128];
-    // 检查模型中是否有任何材质需要tint索引(群系着色)
-    bool hasTintIndex = false;
-    short tintIndexValue = -1;
-    
-    // 首先检查当前使用的材质
-    if (!blockModel.materials.empty() && materialIndex >= 0 && materialIndex < blockModel.materials.size()) {
-        tintIndexValue = blockModel.materials[materialIndex].tintIndex;
-        hasTintIndex = (tintIndexValue != -1);
-    }
-    
-    // 如果当前材质不需要着色,检查模型中的所有其他材质
-    if (!hasTintIndex && !blockModel.materials.empty()) {
-        for (const auto& material : blockModel.materials) {
-            if (material.tintIndex != -1) {
-                hasTintIndex = true;
-                tintIndexValue = material.tintIndex;
-                break;
-            }
-        }
-    }
-    
-    if (hasTintIndex && config.useBiomeColors) {
-        float textureR, textureG, textureB;
-        sscanf(textureAverage.c_str(), "%f %f %f", &textureR, &textureG, &textureB);
-        uint32_t hexColor = Biome::GetBiomeColor(x, y, z,tintIndexValue == 2 ? BiomeColorType::Water : BiomeColorType::Foliage);
-        float biomeR = ((hexColor >> 16) & 0xFF) / 255.0f;
-        float biomeG = ((hexColor >> 8) & 0xFF) / 255.0f;
-        float biomeB = (hexColor & 0xFF) / 255.0f;
-        float finalR = biomeR * textureR;
-        float finalG = biomeG * textureG;
-        float finalB = biomeB * textureB;
-
-        // 根据配置的小数位数格式化最终颜色字符串
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(config.decimalPlaces);
-        if (isFluid) {
-            oss << "color#" << finalR << " " << finalG << " " << finalB << "-" << currentBlock.GetNameAndNameSpaceWithoutState().c_str();
-        }
-        else {
-            oss << "color#" << finalR << " " << finalG << " " << finalB << "=";
-        }
-        return oss.str();
-    }
-    else {
-        if (isFluid) {
-            return  + "color#" + textureAverage + "-" + currentBlock.GetNameAndNameSpaceWithoutState();
-        }
-        else {
-            return "color#" + textureAverage + "=";
-        }
+    uint32_t rgb = entry.color;
+    if (entry.tintIndex != -1 && config.useBiomeColors) {
+        uint32_t hexColor = Biome::GetBiomeColor(x, y, z, entry.tintIndex == 2 ? BiomeColorType::Water : BiomeColorType::Foliage);
+        // 逐通道相乘 (a * b / 255)
+        uint32_t r = (((rgb >> 16) & 0xFF) * ((hexColor >> 16) & 0xFF) + 127) / 255;
+        uint32_t g = (((rgb >> 8) & 0xFF) * ((hexColor >> 8) & 0xFF) + 127) / 255;
+        uint32_t b = ((rgb & 0xFF) * (hexColor & 0xFF) + 127) / 255;
+        rgb = (r << 16) | (g << 8) | b;
     }
+    return LODManager::GetLODColorIndex(rgb, entry.fluidId);
+}
+
+bool LODManager::IsHeightfieldChunk(int chunkX, int chunkZ) {
+    if (!config.activeLOD || !config.useHeightfieldLOD) return false;
+    // 同一区块所有 Section 的 LOD 相同,取起始 Section 即可
+    std::shared_lock<std::shared_mutex> lock(g_chunkSectionInfoMapMutex);
+    auto it = g_chunkSectionInfoMap.find(std::make_tuple(chunkX, config.sectionYStart, chunkZ));
+    return it != g_chunkSectionInfoMap.end() && it->second.lodLevel >= config.heightfieldMinLOD;
 }
 
 float LODManager::GetChunkLODAtBlock(int x, int y, int z) {
@@ -291,8 +302,194 @@ BlockType GetBlockType2(int x, int y, int z) {
     }
 }
 
+//============== LOD 金字塔 ==============//
+// 各级单元在 lodMips 中的偏移:2³ 共 8x8x8 个,4³ 共 4x4x4 个,8³ 共 2x2x2 个
+static constexpr size_t kLODMipCellCount = 512 + 64 + 8;
+
+static int LODMipOffset(int lodBlockSize) {
+    switch (lodBlockSize) {
+    case 2: return 0;
+    case 4: return 512;
+    case 8: return 576;
+    default: return -1;
+    }
+}
+
+// 六个面方向对应的相邻单元偏移:下、上、北、南、西、东
+static const int kLODFaceOffsets[6][3] = {
+    {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}, {-1, 0, 0}, {1, 0, 0}
+};
+
+std::vector<LODMipCell> LODManager::BuildSectionLODMips(const std::vector<int>& blockData) {
+    std::vector<LODMipCell> mips;
+    if (blockData.size() != 4096) return mips;
+
+    // 每种方块只解析一次类型,分别对应 GetBlockType 与 GetBlockType2 的分类
+    std::array<uint8_t, 4096> types;
+    std::array<uint8_t, 4096> types2;
+    std::unordered_map<int, std::pair<uint8_t, uint8_t>> typeCache;
+    for (int i = 0; i < 4096; ++i) {
+        int blockId = blockData[i];
+        auto it = typeCache.find(blockId);
+        if (it == typeCache.end()) {
+            uint8_t t1 = AIR, t2 = AIR;
+            if (blockId >= 0 && blockId < static_cast<int>(globalBlockPalette.size())) {
+                const Block& block = globalBlockPalette[blockId];
+                t1 = (block.name == "minecraft:air") ? AIR : (block.level > -1 ? FLUID : SOLID);
+                t2 = (!block.air && block.level == -1) ? SOLID : (block.level > -1 ? FLUID : AIR);
+            }
+            it = typeCache.emplace(blockId, std::make_pair(t1, t2)).first;
+        }
+        types[i] = it->second.first;
+        types2[i] = it->second.second;
+    }
+
+    mips.resize(kLODMipCellCount);
+    for (int size : { 2, 4, 8 }) {
+        const int dim = 16 / size;
+        const int offset = LODMipOffset(size);
+        for (int cy = 0; cy < dim; ++cy) {
+            for (int cz = 0; cz < dim; ++cz) {
+                for (int cx = 0; cx < dim; ++cx) {
+                    const int x0 = cx * size, y0 = cy * size, z0 = cz * size;
+                    LODMipCell& cell = mips[offset + (cy * dim + cz) * dim + cx];
+
+                    // 与 DetermineLODBlockType 相同的逐层判定(从上到下)
+                    int airLayers = 0, fluidLayers = 0;
+                    bool hasSolidBelow = false;
+                    bool decided = false;
+                    for (int dy = size - 1; dy >= 0 && !decided; --dy) {
+                        int currentAir = 0, currentFluid = 0, currentSolid = 0;
+                        for (int dx = 0; dx < size; ++dx) {
+                            for (int dz = 0; dz < size; ++dz) {
+                                uint8_t type = types[toYZX(x0 + dx, y0 + dy, z0 + dz)];
+                                if (type == AIR)        currentAir++;
+                                else if (type == FLUID) currentFluid++;
+                                else                    currentSolid++;
+                            }
+                        }
+
+                        bool isAirLayer = (currentAir == size * size);
+                        bool isFluidLayer = !isAirLayer && (currentFluid >= currentSolid);
+                        if (isAirLayer) {
+                            airLayers++;
+                        }
+                        else if (isFluidLayer) {
+                            fluidLayers++;
+                            if (hasSolidBelow) {
+                                cell.type = FLUID;
+                                cell.level = static_cast<uint8_t>(airLayers);
+                                for (int dx = 0; dx < size && !decided; ++dx) {
+                                    for (int dz = 0; dz < size; ++dz) {
+                                        int idx = toYZX(x0 + dx, y0 + dy, z0 + dz);
+                                        if (types[idx] == FLUID) {
+                                            cell.id = blockData[idx];
+                                            decided = true;
+                                            break;
+                                        }
+                                    }
+                                }
+                                decided = true;
+                            }
+                        }
+                        else {
+                            hasSolidBelow = true;
+                        }
+                    }
+
+                    if (!decided) {
+                        uint8_t result = (fluidLayers > 0) ? FLUID : (hasSolidBelow ? SOLID : AIR);
+                        cell.type = result;
+                        cell.level = static_cast<uint8_t>((result == SOLID) ? (airLayers + fluidLayers) : airLayers);
+                        cell.id = 0;
+                        bool found = false;
+                        for (int dy = size - 1; dy >= 0 && !found; --dy) {
+                            for (int dx = 0; dx < size && !found; ++dx) {
+                                for (int dz = 0; dz < size; ++dz) {
+                                    int idx = toYZX(x0 + dx, y0 + dy, z0 + dz);
+                                    if (types[idx] == result) {
+                                        cell.id = blockData[idx];
+                                        found = true;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    // 六个边界层的遮挡信息,供相邻单元的面剔除使用
+                    for (int face = 0; face < 6; ++face) {
+                        bool allSolid = true, noAir = true;
+                        for (int a = 0; a < size; ++a) {
+                            for (int b = 0; b < size; ++b) {
+                                int lx, ly, lz;
+                                switch (face) {
+                                case 0: lx = x0 + a; ly = y0;            lz = z0 + b; break;
+                                case 1: lx = x0 + a; ly = y0 + size - 1; lz = z0 + b; break;
+                                case 2: lx = x0 + a; ly = y0 + b; lz = z0;            break;
+                                case 3: lx = x0 + a; ly = y0 + b; lz = z0 + size - 1; break;
+                                case 4: lx = x0;            ly = y0 + a; lz = z0 + b; break;
+                                default: lx = x0 + size - 1; ly = y0 + a; lz = z0 + b; break;
+                                }
+                                uint8_t type = types2[toYZX(lx, ly, lz)];
+                                if (type != SOLID) allSolid = false;
+                                if (type == AIR) noAir = false;
+                            }
+                        }
+                        if (allSolid) cell.faceMask |= static_cast<uint16_t>(1u << face);
+                        if (noAir) cell.faceMask |= static_cast<uint16_t>(1u << (face + 6));
+                    }
+                }
+            }
+        }
+    }
+    return mips;
+}
+
+// 读取对齐的 LOD 金字塔单元;区域未对齐、Section 未加载或未计算金字塔时返回 false
+static bool FindLODMipCell(int x, int y, int z, int lodBlockSize, LODMipCell& outCell) {
+    int offset = LODMipOffset(lodBlockSize);
+    if (offset < 0) return false;
+
+    int lx = mod16(x), ly = mod16(y), lz = mod16(z);
+    if (((lx | ly | lz) & (lodBlockSize - 1)) != 0) return false;
+
+    int chunkX, chunkZ, sectionY;
+    blockToChunk(x, z, chunkX, chunkZ);
+    blockYToSectionY(y, sectionY);
+    auto it = sectionCache.find(std::make_tuple(chunkX, chunkZ, AdjustSectionY(sectionY)));
+    if (it == sectionCache.end() || it->second.lodMips.size() != kLODMipCellCount) return false;
+
+    int dim = 16 / lodBlockSize;
+    outCell = it->second.lodMips[offset + ((ly / lodBlockSize) * dim + lz / lodBlockSize) * dim + lx / lodBlockSize];
+    return true;
+}
+
+// 根据相邻单元朝向当前面的边界层判断遮挡,未命中金字塔时返回 false 并交由逐方块检测
+static bool TryLODMipFaceOcclusion(int faceDir, int x, int y, int z, int baseSize, bool requireSolid, bool& occluded) {
+    if (faceDir < 0 || faceDir > 5) return false;
+    LODMipCell neighbor;
+    if (!FindLODMipCell(x + kLODFaceOffsets[faceDir][0] * baseSize,
+        y + kLODFaceOffsets[faceDir][1] * baseSize,
+        z + kLODFaceOffsets[faceDir][2] * baseSize, baseSize, neighbor)) {
+        return false;
+    }
+    int layer = faceDir ^ 1; // 相邻单元中朝向当前单元的边界层
+    occluded = requireSolid ? (neighbor.faceMask & (1u << layer)) != 0
+                            : (neighbor.faceMask & (1u << (layer + 6))) != 0;
+    return true;
+}
+
 // 确定 LOD 块类型的函数
 BlockType DetermineLODBlockType(int x, int y, int z, int lodBlockSize, int* id = nullptr, int* level = nullptr) {
+    // 优先读取加载时预计算的金字塔单元
+    LODMipCell cell;
+    if (FindLODMipCell(x, y, z, lodBlockSize, cell)) {
+        if (id) *id = cell.id;
+        if (level) *level = cell.level;
+        return static_cast<BlockType>(cell.type);
+    }
+
     int airLayers = 0;          // 纯空气层数
     int fluidLayers = 0;        // 流体层数
     bool hasSolidBelow = false; // 当前层下方是否存在固体层
@@ -401,17 +598,19 @@ BlockType LODManager::DetermineLODBlockTypeWithUpperCheck(int x, int y, int z, i
     return currentType;
 }
 
-std::vector<std::string> LODManager::GetBlockColor(int x, int y, int z, int id, BlockType blockType) {
-    Block currentBlock = GetBlockById(id);
-
+LODBoxColors LODManager::GetBlockColor(int x, int y, int z, int id, BlockType blockType) {
+    LODBoxColors colors;
     if (blockType == FLUID) {
-        return {GetBlockAverageColor(id, currentBlock, x, y, z, "none") };
+        colors.count = 1;
+        colors.top = GetBlockAverageColor(id, x, y, z, FaceType::UNKNOWN);
+        colors.side = colors.top;
     }
     else {
-        std::string upColor = GetBlockAverageColor(id, currentBlock, x, y, z, "up");
-        std::string northColor = GetBlockAverageColor(id, currentBlock, x, y, z, "north");
-        return { upColor,northColor };  // 使用不同的颜色组合
+        colors.count = 2;  // 使用不同的颜色组合
+        colors.top = GetBlockAverageColor(id, x, y, z, FaceType::UP);
+        colors.side = GetBlockAverageColor(id, x, y, z, FaceType::NORTH);
     }
+    return colors;
 }
 
 // 修改后的 IsRegionEmpty 方法:增加 isFluid 参数(默认为 false,用于固体判断)
@@ -501,6 +700,12 @@ bool IsFluidTopRegionValid(int x, int y, int z, float lodSize, float h) {
 }
 
 bool IsFaceOccluded(int faceDir, int x, int y, int z, int baseSize) {
+    // 金字塔只覆盖 2³ 及以上的单元,此时只有空气会阻止剔除(水下LOD模式要求全为固体)
+    bool occluded = false;
+    if (TryLODMipFaceOcclusion(faceDir, x, y, z, baseSize, config.useUnderwaterLOD, occluded)) {
+        return occluded;
+    }
+
     int dxStart, dxEnd, dyStart, dyEnd, dzStart, dzEnd;
 
     // 根据面方向设置检测范围
@@ -584,6 +789,11 @@ bool IsFaceOccluded(int faceDir, int x, int y, int z, int baseSize) {
 }
 
 bool IsFluidFaceOccluded(int faceDir, int x, int y, int z, int baseSize) {
+    bool occluded = false;
+    if (TryLODMipFaceOcclusion(faceDir, x, y, z, baseSize, true, occluded)) {
+        return occluded;
+    }
+
     int dxStart, dxEnd, dyStart, dyEnd, dzStart, dzEnd;
 
     // 根据面方向设置检测范围
@@ -658,12 +868,12 @@ bool IsFluidFaceOccluded(int faceDir, int x, int y, int z, int baseSize) {
 
 // 修改后的 GenerateBox,增加了 boxHeight 参数 
 ModelData LODManager::GenerateBox(int x, int y, int z, int baseSize, float boxHeight,
-    const std::vector<std::string>& colors) {
+    const LODBoxColors& colors) {
     ModelData box;
 
     float size = static_cast<float>(baseSize);
     float height = static_cast<float>(boxHeight);
-    if (colors.size() == 1) {
+    if (colors.count == 1) {
         // 然后检查上方的 LOD 块 (y + 1)
         BlockType upperType = DetermineLODBlockType(x, y + baseSize, z, baseSize);
         // 如果上方的类型不是空气,则将 level 设置为 0
@@ -728,7 +938,7 @@ ModelData LODManager::GenerateBox(int x, int y, int z, int baseSize, float boxHe
     // 材质设置
     std::vector<int> materialIndices; // 临时材质索引数组
     
-    if (colors.empty()) {
+    if (colors.count == 0) {
         Material defaultMaterial;
         defaultMaterial.name = "default_color";
         defaultMaterial.texturePath = "default_color";
@@ -736,25 +946,12 @@ ModelData LODManager::GenerateBox(int x, int y, int z, int baseSize, float boxHe
         box.materials = { defaultMaterial };
         materialIndices = { 0, 0, 0, 0, 0, 0 }; // 临时数组,用于后续创建 Face 结构体
     }
-    else if (colors.size() == 1 || (colors.size() >= 2 && colors[0] == colors[1])) {
-        Material singleMaterial;
-        singleMaterial.name = colors[0];
-        singleMaterial.texturePath = colors[0];
-        singleMaterial.tintIndex = -1;
-        box.materials = { singleMaterial };
+    else if (colors.count == 1 || colors.top == colors.side) {
+        box.materials = { GetLODColorMaterial(colors.top) };
         materialIndices = { 0, 0, 0, 0, 0, 0 }; // 临时数组,用于后续创建 Face 结构体
     }
     else {
-        Material material1, material2;
-        material1.name = colors[0];
-        material1.texturePath = colors[0];
-        material1.tintIndex = -1;
-        
-        material2.name = colors[1];
-        material2.texturePath = colors[1];
-        material2.tintIndex = -1;
-        
-        box.materials = { material1, material2 };
+        box.materials = { GetLODColorMaterial(colors.top), GetLODColorMaterial(colors.side) };
         materialIndices = { 1, 0, 1, 1, 1, 1 }; // 临时数组,用于后续创建 Face 结构体
     }
 
@@ -763,7 +960,7 @@ ModelData LODManager::GenerateBox(int x, int y, int z, int baseSize, float boxHe
 
     // 面剔除逻辑
     std::vector<bool> validFaces(6, true);
-    if (colors.size() == 1) {
+    if (colors.count == 1) {
         // 顶面照常判断
         validFaces[1] = IsFluidTopRegionValid(x, y + baseSize, z, baseSize, boxHeight) ? false : true;
         // 下、东西、南北方向传入
@@ -773,7 +970,7 @@ ModelData LODManager::GenerateBox(int x, int y, int z, int baseSize, float boxHe
         validFaces[2] = IsFluidRegionValid(x, y, z - baseSize, baseSize, boxHeight) ? false : true; // 北面
         validFaces[3] = IsFluidRegionValid(x, y, z + baseSize, baseSize, boxHeight) ? false : true; // 南面
     }
-    else if (colors.size() >= 2) {
+    else if (colors.count >= 2) {
         // 顶面照常判断
         validFaces[1] = IsRegionValid(x, y + baseSize, z, baseSize) ? false : true;
         // 下、东西、南北方向传入
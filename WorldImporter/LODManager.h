@@ -59,22 +59,44 @@ enum BlockType {
     FLUID,
     SOLID
 };
+
+// LOD 方块盒颜色(调色板索引)
+struct LODBoxColors {
+    uint8_t count = 0;  // 0 默认颜色, 1 流体(仅使用 top), 2 固体(顶面/侧面)
+    uint32_t top = 0;   // 顶面颜色索引
+    uint32_t side = 0;  // 侧面颜色索引
+};
 class LODManager {
 public:
     // 获取指定块的 LOD 值
     static float GetChunkLODAtBlock(int x, int y, int z);
 
+    // 判断区块是否使用高度场远景地形(LOD 不低于 heightfieldMinLOD)
+    static bool IsHeightfieldChunk(int chunkX, int chunkZ);
+
     // 带上方检查的 LOD 块类型确定
     static BlockType DetermineLODBlockTypeWithUpperCheck(int x, int y, int z, int lodBlockSize, int* id = nullptr, int* level = nullptr);
 
     // 获取块颜色
-    static std::vector<std::string> GetBlockColor(int x, int y, int z, int id, BlockType blockType);
+    static LODBoxColors GetBlockColor(int x, int y, int z, int id, BlockType blockType);
 
     // 生成包围盒模型并剔除不需要的面
-    static ModelData GenerateBox(int x, int y, int z, int baseSize, float boxHeight, const std::vector<std::string>& colors);
+    static ModelData GenerateBox(int x, int y, int z, int baseSize, float boxHeight, const LODBoxColors& colors);
+
+    // LOD 颜色调色板:按 (颜色, 流体类型) 去重,可按配置量化,大小受 lodColorPaletteSize 限制
+    static uint32_t GetLODColorIndex(uint32_t rgb, uint16_t fluidId);
+    // 获取流体名称对应的调色板流体ID(0 表示非流体)
+    static uint16_t GetLODFluidId(const std::string& fluidName);
+    // 获取调色板颜色对应的材质
+    static Material GetLODColorMaterial(uint32_t index);
+    // 解析调色板材质路径("lodcolor#索引")并取出颜色 (0xRRGGBB)
+    static bool GetLODPaletteColor(const std::string& texturePath, uint32_t& outRgb);
     
     // 检查方块是否应该使用原始模型
     static bool ShouldUseOriginalModel(const std::string& blockName);
+
+    // 根据 Section 的全局方块ID(YZX顺序)计算 LOD 金字塔(2³/4³/8³)
+    static std::vector<LODMipCell> BuildSectionLODMips(const std::vector<int>& blockData);
 };
 
 #endif // LOD_MANAGER_H
\ No newline at end of file
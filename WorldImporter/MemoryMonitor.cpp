@@ -79,6 +79,7 @@ size_t estimate_section_cache_entry_memory(const SectionCacheEntry& entry) {
     memory += estimate_vector_memory(entry.blockData);
     memory += estimate_vector_memory(entry.biomeData);
     memory += estimate_vector_memory(entry.blockPalette); // vector<string>
+    memory += estimate_vector_memory(entry.lodMips);
     return memory;
 }
 
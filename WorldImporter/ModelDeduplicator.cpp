@@ -11,6 +11,7 @@
 #include <string>
 #include <set>
 #include "TaskMonitor.h"
+#include "VertexKeySort.h"
 #include <future> // 新增: 用于 std::async, std::future
 #include <mutex>  // 新增: 用于 std::mutex, std::lock_guard
 #include <vector> 
@@ -21,6 +22,7 @@
 #include <thread> // 新增: 用于 std::thread::hardware_concurrency()
 #include <chrono> // 新增: 用于性能计时
 #include <functional> // 新增: 用于 std::function
+#include <limits>
 #undef max
 #undef min
 // 2x2矩阵结构体,用于UV坐标变换
@@ -89,46 +91,17 @@ void ModelDeduplicator::DeduplicateVertices(ModelData& data) {
     using Ms = std::chrono::duration<double, std::milli>;
     auto t0 = Clock::now();
 
-    // 使用简单的KeyAndIndex结构进行排序和去重
-    struct KeyAndIndex { VertexKey key; int oldIndex; };
-    std::vector<KeyAndIndex> keys(vertCount);
-
     // 并行计算顶点键
     unsigned int numThreads = std::thread::hardware_concurrency();
     if (numThreads == 0) numThreads = 1;
-    std::vector<std::thread> threads;
-    threads.reserve(numThreads);
-    size_t chunk = (vertCount + numThreads - 1) / numThreads;
-    
-    for (unsigned int t = 0; t < numThreads; ++t) {
-        size_t start = t * chunk;
-        size_t end = std::min(start + chunk, vertCount);
-        threads.emplace_back([&, start, end]() {
-            for (size_t i = start; i < end; ++i) {
-                float x = data.vertices[3*i];
-                float y = data.vertices[3*i + 1];
-                float z = data.vertices[3*i + 2];
-                
-                // 确保精确的量化，使用相同的舍入方法
-                int rx = static_cast<int>(std::round(x * 10000.0f));
-                int ry = static_cast<int>(std::round(y * 10000.0f));
-                int rz = static_cast<int>(std::round(z * 10000.0f));
-                
-                keys[i] = { VertexKey{rx, ry, rz}, static_cast<int>(i) };
-            }
-        });
-    }
-    for (auto &th : threads) th.join();
+    std::vector<VertexKeyAndIndex> keys;
+    ComputeVertexKeys(data.vertices, keys, numThreads);
 
     auto t1 = Clock::now();
     std::cerr << "计算顶点键: " << Ms(t1 - t0).count() << " ms\n";
 
-    // 使用稳定排序，相同键的情况下保持原顺序
-    std::stable_sort(keys.begin(), keys.end(), [](const KeyAndIndex &a, const KeyAndIndex &b) {
-        if (a.key.x != b.key.x) return a.key.x < b.key.x;
-        if (a.key.y != b.key.y) return a.key.y < b.key.y;
-        return a.key.z < b.key.z;
-    });
+    // 并行基数排序(稳定),相同键的情况下保持原顺序
+    SortVertexKeysRadix(keys, numThreads);
 
     auto t2 = Clock::now();
     std::cerr << "排序顶点键: " << Ms(t2 - t1).count() << " ms\n";
@@ -169,8 +142,9 @@ void ModelDeduplicator::DeduplicateVertices(ModelData& data) {
     // 并行更新面索引
     const size_t faceCount = data.faces.size();
     if (faceCount > 0) {
-        threads.clear();
-        chunk = (faceCount + numThreads - 1) / numThreads;
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        size_t chunk = (faceCount + numThreads - 1) / numThreads;
         for (unsigned int t = 0; t < numThreads; ++t) {
             size_t start = t * chunk;
             size_t end = std::min(start + chunk, faceCount);
@@ -249,39 +223,84 @@ void ModelDeduplicator::DeduplicateUV(ModelData& model) {
 }
 
 void ModelDeduplicator::DeduplicateFaces(ModelData& data) {
-    size_t faceCountNum = data.faces.size();
-    std::vector<FaceKey> keys;
-    keys.reserve(faceCountNum);
-
-    // 第一次遍历:计算每个面的规范化键并存入数组(避免重复排序)
-    for (size_t i = 0; i < data.faces.size(); i++) {
-        const auto& face = data.faces[i];
-        std::array<int, 4> faceArray = {
-            face.vertexIndices[0], face.vertexIndices[1],
-            face.vertexIndices[2], face.vertexIndices[3]
-        };
-        std::array<int, 4> sorted = faceArray;
-        std::sort(sorted.begin(), sorted.end());
-        int matIndex = config.strictDeduplication ? face.materialIndex : -1;
-        keys.push_back(FaceKey{ sorted, matIndex });
-    }
+    const size_t faceCountNum = data.faces.size();
+    if (faceCountNum == 0) return;
 
-    // 使用预分配容量的 unordered_map 来统计每个 FaceKey 的出现次数
-    std::unordered_map<FaceKey, int, FaceKeyHasher> freq;
-    freq.reserve(faceCountNum);
-    for (const auto& key : keys) {
-        freq[key]++;
-    }
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1;
+    numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, faceCountNum / 16384 + 1));
+    const size_t chunk = (faceCountNum + numThreads - 1) / numThreads;
+    auto runParallel = [numThreads](auto&& body) {
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads);
+        for (unsigned int t = 0; t < numThreads; ++t) {
+            threads.emplace_back(body, t);
+        }
+        for (auto& th : threads) th.join();
+    };
 
-    // 第二次遍历:过滤只出现一次的面
-    std::vector<Face> newFaces;
-    newFaces.reserve(data.faces.size());
+    // 按哈希高位分片,每个分片独立计数
+    constexpr int kShardBits = 6;
+    constexpr size_t kShardCount = size_t(1) << kShardBits;
+
+    // 1. 并行计算每个面的规范化键,并按分片记录面索引
+    std::vector<FaceKey> keys(faceCountNum);
+    std::vector<std::vector<std::vector<uint32_t>>> shardFaces(numThreads, std::vector<std::vector<uint32_t>>(kShardCount));
+    runParallel([&](unsigned int t) {
+        FaceKeyHasher hasher;
+        size_t start = t * chunk;
+        size_t end = std::min(start + chunk, faceCountNum);
+        for (size_t i = start; i < end; ++i) {
+            const auto& face = data.faces[i];
+            std::array<int, 4> sorted = {
+                face.vertexIndices[0], face.vertexIndices[1],
+                face.vertexIndices[2], face.vertexIndices[3]
+            };
+            std::sort(sorted.begin(), sorted.end());
+            int matIndex = config.strictDeduplication ? face.materialIndex : -1;
+            keys[i] = FaceKey{ sorted, matIndex };
+            size_t shard = static_cast<uint64_t>(hasher(keys[i])) >> (64 - kShardBits);
+            shardFaces[t][shard].push_back(static_cast<uint32_t>(i));
+        }
+    });
 
-    for (size_t i = 0; i < keys.size(); i++) {
-        if (freq[keys[i]] == 1) {
-            newFaces.push_back(data.faces[i]);
+    // 2. 并行统计各分片内键的出现次数,标记只出现一次的面
+    std::vector<uint8_t> keep(faceCountNum, 0);
+    std::atomic<size_t> nextShard{ 0 };
+    runParallel([&](unsigned int) {
+        std::unordered_map<FaceKey, int, FaceKeyHasher> freq;
+        for (size_t shard = nextShard++; shard < kShardCount; shard = nextShard++) {
+            size_t shardSize = 0;
+            for (unsigned int t = 0; t < numThreads; ++t) shardSize += shardFaces[t][shard].size();
+            freq.clear();
+            freq.reserve(shardSize);
+            for (unsigned int t = 0; t < numThreads; ++t) {
+                for (uint32_t i : shardFaces[t][shard]) freq[keys[i]]++;
+            }
+            for (unsigned int t = 0; t < numThreads; ++t) {
+                for (uint32_t i : shardFaces[t][shard]) keep[i] = freq[keys[i]] == 1;
+            }
         }
-    }
+    });
+
+    // 3. 并行压缩:先统计各段保留数量,再按前缀和写入,保持原有顺序
+    std::vector<size_t> offsets(numThreads + 1, 0);
+    runParallel([&](unsigned int t) {
+        size_t start = t * chunk;
+        size_t end = std::min(start + chunk, faceCountNum);
+        offsets[t + 1] = std::count(keep.begin() + std::min(start, faceCountNum), keep.begin() + end, uint8_t(1));
+    });
+    for (unsigned int t = 0; t < numThreads; ++t) offsets[t + 1] += offsets[t];
+
+    std::vector<Face> newFaces(offsets[numThreads]);
+    runParallel([&](unsigned int t) {
+        size_t start = t * chunk;
+        size_t end = std::min(start + chunk, faceCountNum);
+        size_t out = offsets[t];
+        for (size_t i = start; i < end; ++i) {
+            if (keep[i]) newFaces[out++] = std::move(data.faces[i]);
+        }
+    });
 
     data.faces.swap(newFaces);
 }
@@ -913,6 +932,571 @@ void ModelDeduplicator::GreedyMesh(ModelData& data) {
 }
 
 // 综合去重和优化方法
+// 二次误差度量(QEM)网格简化:半边折叠到相邻顶点,开放边界/材质边界/分组包围盒上的顶点锁定,
+// 保证相邻分组之间的接缝不产生裂缝。结果重新配对为四边形,无法配对的三角形以三角形面输出(第4个索引与第3个相同)
+void ModelDeduplicator::SimplifyMesh(ModelData& data, float targetRatio, float maxError) {
+    const size_t vertCount = data.vertices.size() / 3;
+    if (vertCount == 0 || data.faces.empty()) return;
+
+    using Clock = std::chrono::high_resolution_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto t0 = Clock::now();
+
+    struct Vec3 { double x, y, z; };
+    auto position = [&](int idx) {
+        return Vec3{ data.vertices[3 * idx], data.vertices[3 * idx + 1], data.vertices[3 * idx + 2] };
+    };
+    auto sub = [](const Vec3& a, const Vec3& b) { return Vec3{ a.x - b.x, a.y - b.y, a.z - b.z }; };
+    auto cross = [](const Vec3& a, const Vec3& b) {
+        return Vec3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+    };
+    auto dot = [](const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; };
+
+    // 对称4x4二次型:a2 ab ac ad b2 bc bd c2 cd d2
+    struct Quadric {
+        double q[10] = {};
+        void AddPlane(double a, double b, double c, double d, double w) {
+            q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+            q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+            q[7] += w * c * c; q[8] += w * c * d; q[9] += w * d * d;
+        }
+        void Add(const Quadric& o) { for (int i = 0; i < 10; ++i) q[i] += o.q[i]; }
+        double Eval(const Vec3& v) const {
+            return q[0] * v.x * v.x + 2 * q[1] * v.x * v.y + 2 * q[2] * v.x * v.z + 2 * q[3] * v.x
+                + q[4] * v.y * v.y + 2 * q[5] * v.y * v.z + 2 * q[6] * v.y
+                + q[7] * v.z * v.z + 2 * q[8] * v.z + q[9];
+        }
+    };
+
+    struct Triangle {
+        std::array<int, 3> v;
+        std::array<int, 3> uv;
+        int materialIndex;
+        FaceType faceDirection;
+        bool alive;
+    };
+
+    // 1. 四边形拆分为三角形(跳过退化三角形)
+    std::vector<Triangle> tris;
+    tris.reserve(data.faces.size() * 2);
+    for (const auto& face : data.faces) {
+        const int corners[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+        for (const auto& c : corners) {
+            int a = face.vertexIndices[c[0]], b = face.vertexIndices[c[1]], d = face.vertexIndices[c[2]];
+            if (a == b || b == d || a == d) continue;
+            tris.push_back({ { a, b, d },
+                { face.uvIndices[c[0]], face.uvIndices[c[1]], face.uvIndices[c[2]] },
+                face.materialIndex, face.faceDirection, true });
+        }
+    }
+    const size_t originalTriCount = tris.size();
+
+    // 2. 锁定顶点:非纯色材质、材质边界、开放/非流形边、分组包围盒侧面
+    std::vector<uint8_t> locked(vertCount, 0);
+    std::vector<int> vertexMaterial(vertCount, -2);
+    auto isColorMaterial = [&](int matIndex) {
+        if (matIndex < 0 || matIndex >= static_cast<int>(data.materials.size())) return false;
+        const std::string& path = data.materials[matIndex].texturePath;
+        return path == "default_color" || path.rfind("lodcolor#", 0) == 0;
+    };
+    for (const auto& t : tris) {
+        bool colorMaterial = isColorMaterial(t.materialIndex);
+        for (int v : t.v) {
+            if (!colorMaterial) locked[v] = 1;
+            if (vertexMaterial[v] == -2) vertexMaterial[v] = t.materialIndex;
+            else if (vertexMaterial[v] != t.materialIndex) locked[v] = 1;
+        }
+    }
+
+    auto edgeKey = [](int a, int b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+    };
+    {
+        std::vector<uint64_t> edges;
+        edges.reserve(tris.size() * 3);
+        for (const auto& t : tris) {
+            for (int k = 0; k < 3; ++k) edges.push_back(edgeKey(t.v[k], t.v[(k + 1) % 3]));
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();) {
+            size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i]) ++j;
+            if (j - i != 2) {
+                locked[static_cast<uint32_t>(edges[i] >> 32)] = 1;
+                locked[static_cast<uint32_t>(edges[i])] = 1;
+            }
+            i = j;
+        }
+    }
+
+    float minX = std::numeric_limits<float>::max(), maxX = std::numeric_limits<float>::lowest();
+    float minZ = std::numeric_limits<float>::max(), maxZ = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < vertCount; ++i) {
+        minX = std::min(minX, data.vertices[3 * i]); maxX = std::max(maxX, data.vertices[3 * i]);
+        minZ = std::min(minZ, data.vertices[3 * i + 2]); maxZ = std::max(maxZ, data.vertices[3 * i + 2]);
+    }
+    const float boundsEps = 1e-4f;
+    for (size_t i = 0; i < vertCount; ++i) {
+        float x = data.vertices[3 * i], z = data.vertices[3 * i + 2];
+        if (x - minX < boundsEps || maxX - x < boundsEps || z - minZ < boundsEps || maxZ - z < boundsEps) {
+            locked[i] = 1;
+        }
+    }
+
+    // 3. 每个顶点累加相邻三角形平面的二次型(按面积加权)
+    std::vector<Quadric> quadrics(vertCount);
+    for (const auto& t : tris) {
+        Vec3 p0 = position(t.v[0]), p1 = position(t.v[1]), p2 = position(t.v[2]);
+        Vec3 n = cross(sub(p1, p0), sub(p2, p0));
+        double len = std::sqrt(dot(n, n));
+        if (len < 1e-12) continue;
+        double a = n.x / len, b = n.y / len, c = n.z / len;
+        double d = -(a * p0.x + b * p0.y + c * p0.z);
+        for (int v : t.v) quadrics[v].AddPlane(a, b, c, d, len * 0.5);
+    }
+
+    // 4. 按代价分趟折叠,每趟中被修改的一环邻域不再参与本趟
+    const size_t targetTris = static_cast<size_t>(originalTriCount * std::clamp(targetRatio, 0.0f, 1.0f));
+    const double maxCost = static_cast<double>(maxError) * maxError;
+    size_t liveTris = originalTriCount;
+
+    struct Collapse { double cost; int from; int to; };
+    std::vector<Collapse> candidates;
+    std::vector<uint32_t> adjacencyOffsets(vertCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<uint8_t> touched(vertCount);
+    std::vector<int> ringMark(vertCount, -1);
+
+    while (liveTris > targetTris) {
+        // 构建顶点到三角形的邻接表
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (const auto& t : tris) {
+            if (!t.alive) continue;
+            for (int v : t.v) adjacencyOffsets[v + 1]++;
+        }
+        for (size_t i = 0; i < vertCount; ++i) adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        adjacency.resize(adjacencyOffsets[vertCount]);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t ti = 0; ti < tris.size(); ++ti) {
+                if (!tris[ti].alive) continue;
+                for (int v : tris[ti].v) adjacency[fill[v]++] = ti;
+            }
+        }
+
+        candidates.clear();
+        for (const auto& t : tris) {
+            if (!t.alive) continue;
+            for (int k = 0; k < 3; ++k) {
+                int a = t.v[k], b = t.v[(k + 1) % 3];
+                if (!locked[a]) {
+                    double cost = quadrics[a].Eval(position(b));
+                    if (cost <= maxCost) candidates.push_back({ cost, a, b });
+                }
+                if (!locked[b]) {
+                    double cost = quadrics[b].Eval(position(a));
+                    if (cost <= maxCost) candidates.push_back({ cost, b, a });
+                }
+            }
+        }
+        if (candidates.empty()) break;
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) {
+            return a.cost < b.cost;
+        });
+
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t collapsed = 0;
+        int ringStamp = 0;
+        for (const auto& c : candidates) {
+            if (liveTris <= targetTris) break;
+            const int u = c.from, v = c.to;
+            if (touched[u] || touched[v]) continue;
+
+            // 拓扑检查:u、v 的公共邻点数必须等于共享该边的三角形数(链接条件)
+            ++ringStamp;
+            int sharedTris = 0;
+            for (uint32_t i = adjacencyOffsets[u]; i < adjacencyOffsets[u + 1]; ++i) {
+                const auto& t = tris[adjacency[i]];
+                bool hasV = t.v[0] == v || t.v[1] == v || t.v[2] == v;
+                if (hasV) ++sharedTris;
+                for (int w : t.v) if (w != u && w != v) ringMark[w] = ringStamp;
+            }
+            int commonNeighbors = 0;
+            for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v + 1]; ++i) {
+                for (int w : tris[adjacency[i]].v) {
+                    if (w != u && w != v && ringMark[w] == ringStamp) {
+                        ringMark[w] = -1;
+                        ++commonNeighbors;
+                    }
+                }
+            }
+            if (sharedTris == 0 || commonNeighbors != sharedTris) continue;
+
+            // 几何检查:折叠后剩余三角形不能翻转或退化
+            Vec3 target = position(v);
+            bool valid = true;
+            for (uint32_t i = adjacencyOffsets[u]; i < adjacencyOffsets[u + 1] && valid; ++i) {
+                const auto& t = tris[adjacency[i]];
+                if (t.v[0] == v || t.v[1] == v || t.v[2] == v) continue;
+                Vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = position(t.v[k]);
+                    q[k] = t.v[k] == u ? target : p[k];
+                }
+                Vec3 before = cross(sub(p[1], p[0]), sub(p[2], p[0]));
+                Vec3 after = cross(sub(q[1], q[0]), sub(q[2], q[0]));
+                double afterLen2 = dot(after, after);
+                if (afterLen2 < 1e-10 || dot(before, after) < 0.25 * std::sqrt(dot(before, before) * afterLen2)) {
+                    valid = false;
+                }
+            }
+            if (!valid) continue;
+
+            // 执行折叠
+            for (uint32_t i = adjacencyOffsets[u]; i < adjacencyOffsets[u + 1]; ++i) {
+                auto& t = tris[adjacency[i]];
+                for (int w : t.v) touched[w] = 1;
+                if (t.v[0] == v || t.v[1] == v || t.v[2] == v) {
+                    t.alive = false;
+                    --liveTris;
+                } else {
+                    for (int& w : t.v) if (w == u) w = v;
+                }
+            }
+            quadrics[v].Add(quadrics[u]);
+            touched[u] = touched[v] = 1;
+            ++collapsed;
+        }
+        if (collapsed == 0) break;
+    }
+
+    // 5. 重新配对为四边形:共享一条边、材质与朝向相同、共面且凸
+    std::vector<uint32_t> alive;
+    alive.reserve(liveTris);
+    for (uint32_t ti = 0; ti < tris.size(); ++ti) {
+        if (tris[ti].alive) alive.push_back(ti);
+    }
+    struct EdgeRef { uint64_t key; uint32_t tri; int corner; };
+    std::vector<EdgeRef> edgeRefs;
+    edgeRefs.reserve(alive.size() * 3);
+    for (uint32_t ti : alive) {
+        for (int k = 0; k < 3; ++k) edgeRefs.push_back({ edgeKey(tris[ti].v[k], tris[ti].v[(k + 1) % 3]), ti, k });
+    }
+    std::sort(edgeRefs.begin(), edgeRefs.end(), [](const EdgeRef& a, const EdgeRef& b) {
+        return a.key != b.key ? a.key < b.key : a.tri < b.tri;
+    });
+
+    std::vector<Face> newFaces;
+    newFaces.reserve(alive.size());
+    std::vector<uint8_t> paired(tris.size(), 0);
+    for (size_t i = 0; i + 1 < edgeRefs.size(); ++i) {
+        if (edgeRefs[i].key != edgeRefs[i + 1].key) continue;
+        if (i > 0 && edgeRefs[i - 1].key == edgeRefs[i].key) continue;
+        if (i + 2 < edgeRefs.size() && edgeRefs[i + 2].key == edgeRefs[i].key) continue;
+        const EdgeRef& e0 = edgeRefs[i];
+        const EdgeRef& e1 = edgeRefs[i + 1];
+        const Triangle& t0 = tris[e0.tri];
+        const Triangle& t1 = tris[e1.tri];
+        if (paired[e0.tri] || paired[e1.tri]) continue;
+        if (t0.materialIndex != t1.materialIndex || t0.faceDirection != t1.faceDirection) continue;
+        // t0 的边 (a,b) 在 t1 中必须反向出现
+        int a = t0.v[e0.corner], b = t0.v[(e0.corner + 1) % 3], c = t0.v[(e0.corner + 2) % 3];
+        if (t1.v[e1.corner] != b || t1.v[(e1.corner + 1) % 3] != a) continue;
+        int d = t1.v[(e1.corner + 2) % 3];
+
+        // 四边形 (b, c, a, d) 须共面且凸
+        const int quad[4] = { b, c, a, d };
+        Vec3 n0 = cross(sub(position(b), position(a)), sub(position(c), position(a)));
+        Vec3 n1 = cross(sub(position(a), position(b)), sub(position(d), position(b)));
+        double l0 = std::sqrt(dot(n0, n0)), l1 = std::sqrt(dot(n1, n1));
+        if (l0 < 1e-12 || l1 < 1e-12 || dot(n0, n1) < 0.9999 * l0 * l1) continue;
+        bool convex = true;
+        for (int k = 0; k < 4 && convex; ++k) {
+            Vec3 e = sub(position(quad[(k + 1) % 4]), position(quad[k]));
+            Vec3 f = sub(position(quad[(k + 2) % 4]), position(quad[(k + 1) % 4]));
+            if (dot(cross(e, f), n0) <= 0.0) convex = false;
+        }
+        if (!convex) continue;
+
+        auto uvOf = [](const Triangle& t, int vertex) {
+            for (int k = 0; k < 3; ++k) if (t.v[k] == vertex) return t.uv[k];
+            return t.uv[0];
+        };
+        Face face;
+        face.vertexIndices = { b, c, a, d };
+        face.uvIndices = { uvOf(t0, b), uvOf(t0, c), uvOf(t0, a), uvOf(t1, d) };
+        face.materialIndex = t0.materialIndex;
+        face.faceDirection = t0.faceDirection;
+        newFaces.push_back(face);
+        paired[e0.tri] = paired[e1.tri] = 1;
+    }
+    for (uint32_t ti : alive) {
+        if (paired[ti]) continue;
+        const Triangle& t = tris[ti];
+        Face face;
+        face.vertexIndices = { t.v[0], t.v[1], t.v[2], t.v[2] };
+        face.uvIndices = { t.uv[0], t.uv[1], t.uv[2], t.uv[2] };
+        face.materialIndex = t.materialIndex;
+        face.faceDirection = t.faceDirection;
+        newFaces.push_back(face);
+    }
+
+    // 6. 移除不再被引用的顶点
+    std::vector<int> vertexRemap(vertCount, -1);
+    std::vector<float> newVertices;
+    newVertices.reserve(data.vertices.size());
+    for (auto& face : newFaces) {
+        for (int& idx : face.vertexIndices) {
+            if (vertexRemap[idx] < 0) {
+                vertexRemap[idx] = static_cast<int>(newVertices.size() / 3);
+                newVertices.insert(newVertices.end(), data.vertices.begin() + 3 * idx, data.vertices.begin() + 3 * idx + 3);
+            }
+            idx = vertexRemap[idx];
+        }
+    }
+
+    const size_t originalFaceCount = data.faces.size();
+    data.vertices.swap(newVertices);
+    data.faces.swap(newFaces);
+
+    auto t1 = Clock::now();
+    std::cerr << "SimplifyMesh: 原始面数 " << originalFaceCount << " (三角形 " << originalTriCount
+              << "), 简化后面数 " << data.faces.size() << " (三角形 " << liveTris
+              << "), 耗时 " << Ms(t1 - t0).count() << " ms\n";
+}
+
+namespace {
+    // 平均缓存未命中率(ACMR):按扇形三角化后用FIFO缓存模拟顶点变换,返回每个三角形的平均未命中数
+    double ComputeACMR(const std::vector<Face>& faces, size_t vertCount, int cacheSize) {
+        std::vector<int64_t> insertedAt(vertCount, -1);
+        int64_t cacheClock = 0;
+        size_t misses = 0, triangles = 0;
+        for (const auto& face : faces) {
+            int corners = FaceCornerCount(face);
+            for (int t = 1; t + 1 < corners; ++t) {
+                const int tri[3] = { face.vertexIndices[0], face.vertexIndices[t], face.vertexIndices[t + 1] };
+                for (int v : tri) {
+                    if (v < 0 || static_cast<size_t>(v) >= vertCount) continue;
+                    if (insertedAt[v] < 0 || cacheClock - insertedAt[v] >= cacheSize) {
+                        insertedAt[v] = cacheClock++;
+                        ++misses;
+                    }
+                }
+                ++triangles;
+            }
+        }
+        return triangles ? static_cast<double>(misses) / triangles : 0.0;
+    }
+}
+
+// Forsyth 顶点缓存优化:按材质分组对面重新排序以提高变换后顶点缓存命中率,
+// 再按首次使用顺序重排顶点和UV以提高取数局部性
+void ModelDeduplicator::OptimizeVertexCache(ModelData& data) {
+    const size_t vertCount = data.vertices.size() / 3;
+    const size_t faceCount = data.faces.size();
+    if (vertCount == 0 || faceCount == 0) return;
+
+    using Clock = std::chrono::high_resolution_clock;
+    using Ms = std::chrono::duration<double, std::milli>;
+    auto t0 = Clock::now();
+
+    constexpr int kCacheSize = 32;
+    constexpr int kLastFaceSize = 4;
+    constexpr float kCacheDecayPower = 1.5f;
+    constexpr float kLastFaceScore = 0.75f;
+    constexpr float kValenceBoostScale = 2.0f;
+    constexpr float kValenceBoostPower = 0.5f;
+    constexpr int kACMRCacheSize = 16;
+
+    const double acmrBefore = ComputeACMR(data.faces, vertCount, kACMRCacheSize);
+
+    // 预计算缓存位置得分
+    float cachePositionScore[kCacheSize];
+    for (int i = 0; i < kCacheSize; ++i) {
+        cachePositionScore[i] = i < kLastFaceSize ? kLastFaceScore :
+            std::pow(1.0f - static_cast<float>(i - kLastFaceSize) / (kCacheSize - kLastFaceSize), kCacheDecayPower);
+    }
+
+    // 按材质分组(保持材质出现顺序不变,与导出时分组一致)
+    std::vector<std::vector<uint32_t>> materialFaces(data.materials.size() + 1);
+    for (uint32_t fi = 0; fi < faceCount; ++fi) {
+        int mat = data.faces[fi].materialIndex;
+        size_t slot = (mat >= 0 && static_cast<size_t>(mat) < data.materials.size()) ? static_cast<size_t>(mat) : data.materials.size();
+        materialFaces[slot].push_back(fi);
+    }
+
+    std::vector<Face> newFaces;
+    newFaces.reserve(faceCount);
+    std::vector<int> localIndex(vertCount, -1);
+
+    for (const auto& group : materialFaces) {
+        if (group.empty()) continue;
+        const size_t groupSize = group.size();
+
+        // 组内顶点使用局部编号,避免每组都遍历全部顶点
+        std::vector<int> groupVerts;
+        std::vector<std::array<int, 4>> localFaces(groupSize);
+        std::vector<int> localCorners(groupSize);
+        for (size_t f = 0; f < groupSize; ++f) {
+            const Face& face = data.faces[group[f]];
+            localCorners[f] = FaceCornerCount(face);
+            for (int k = 0; k < localCorners[f]; ++k) {
+                int v = face.vertexIndices[k];
+                if (v < 0 || static_cast<size_t>(v) >= vertCount) {
+                    localFaces[f][k] = -1;
+                    continue;
+                }
+                if (localIndex[v] < 0) {
+                    localIndex[v] = static_cast<int>(groupVerts.size());
+                    groupVerts.push_back(v);
+                }
+                localFaces[f][k] = localIndex[v];
+            }
+        }
+        const size_t localVertCount = groupVerts.size();
+
+        // 顶点到面的邻接表
+        std::vector<uint32_t> adjacencyOffsets(localVertCount + 1, 0);
+        for (size_t f = 0; f < groupSize; ++f) {
+            for (int k = 0; k < localCorners[f]; ++k) {
+                if (localFaces[f][k] >= 0) adjacencyOffsets[localFaces[f][k] + 1]++;
+            }
+        }
+        for (size_t i = 0; i < localVertCount; ++i) adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        std::vector<uint32_t> adjacency(adjacencyOffsets[localVertCount]);
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (uint32_t f = 0; f < groupSize; ++f) {
+                for (int k = 0; k < localCorners[f]; ++k) {
+                    if (localFaces[f][k] >= 0) adjacency[fill[localFaces[f][k]]++] = f;
+                }
+            }
+        }
+
+        std::vector<int> remaining(localVertCount);
+        std::vector<int> cachePosition(localVertCount, -1);
+        std::vector<float> vertexScore(localVertCount);
+        auto scoreVertex = [&](int v) {
+            if (remaining[v] == 0) return -1.0f;
+            float score = cachePosition[v] >= 0 ? cachePositionScore[cachePosition[v]] : 0.0f;
+            return score + kValenceBoostScale * std::pow(static_cast<float>(remaining[v]), -kValenceBoostPower);
+        };
+        for (size_t v = 0; v < localVertCount; ++v) {
+            remaining[v] = static_cast<int>(adjacencyOffsets[v + 1] - adjacencyOffsets[v]);
+            vertexScore[v] = scoreVertex(static_cast<int>(v));
+        }
+        std::vector<float> faceScore(groupSize, 0.0f);
+        std::vector<uint8_t> emitted(groupSize, 0);
+        for (size_t f = 0; f < groupSize; ++f) {
+            for (int k = 0; k < localCorners[f]; ++k) {
+                if (localFaces[f][k] >= 0) faceScore[f] += vertexScore[localFaces[f][k]];
+            }
+        }
+
+        std::vector<int> cache;
+        std::vector<int> newCache;
+        cache.reserve(kCacheSize + kLastFaceSize);
+        newCache.reserve(kCacheSize + kLastFaceSize);
+        size_t scanCursor = 0;
+        int bestFace = -1;
+        for (size_t emittedCount = 0; emittedCount < groupSize; ++emittedCount) {
+            // 缓存中没有候选面时按原顺序取下一个未输出的面
+            if (bestFace < 0) {
+                while (emitted[scanCursor]) ++scanCursor;
+                bestFace = static_cast<int>(scanCursor);
+            }
+
+            newFaces.push_back(data.faces[group[bestFace]]);
+            emitted[bestFace] = 1;
+
+            // 更新剩余面数并从邻接表中移除该面,将该面顶点移到缓存最前
+            newCache.clear();
+            for (int k = 0; k < localCorners[bestFace]; ++k) {
+                int v = localFaces[bestFace][k];
+                if (v < 0) continue;
+                uint32_t begin = adjacencyOffsets[v], end = begin + remaining[v];
+                for (uint32_t i = begin; i < end; ++i) {
+                    if (adjacency[i] == static_cast<uint32_t>(bestFace)) {
+                        std::swap(adjacency[i], adjacency[end - 1]);
+                        break;
+                    }
+                }
+                remaining[v]--;
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+            }
+            for (int v : cache) {
+                if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+            }
+            for (size_t i = 0; i < newCache.size(); ++i) {
+                cachePosition[newCache[i]] = i < kCacheSize ? static_cast<int>(i) : -1;
+            }
+
+            // 重新计算缓存内顶点得分并同步到相邻面,选出下一个最佳面
+            for (int v : newCache) {
+                float newScore = scoreVertex(v);
+                float delta = newScore - vertexScore[v];
+                vertexScore[v] = newScore;
+                for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v] + remaining[v]; ++i) {
+                    faceScore[adjacency[i]] += delta;
+                }
+            }
+            bestFace = -1;
+            float bestScore = -1.0f;
+            for (int v : newCache) {
+                if (cachePosition[v] < 0) continue;
+                for (uint32_t i = adjacencyOffsets[v]; i < adjacencyOffsets[v] + remaining[v]; ++i) {
+                    if (faceScore[adjacency[i]] > bestScore) {
+                        bestScore = faceScore[adjacency[i]];
+                        bestFace = static_cast<int>(adjacency[i]);
+                    }
+                }
+            }
+            if (newCache.size() > kCacheSize) newCache.resize(kCacheSize);
+            cache.swap(newCache);
+        }
+
+        for (int v : groupVerts) localIndex[v] = -1;
+    }
+
+    // 按首次使用顺序重排顶点和UV
+    std::vector<int> vertexRemap(vertCount, -1);
+    std::vector<float> newVertices;
+    newVertices.reserve(data.vertices.size());
+    const size_t uvCount = data.uvCoordinates.size() / 2;
+    std::vector<int> uvRemap(uvCount, -1);
+    std::vector<float> newUVs;
+    newUVs.reserve(data.uvCoordinates.size());
+    for (auto& face : newFaces) {
+        for (int& idx : face.vertexIndices) {
+            if (idx < 0 || static_cast<size_t>(idx) >= vertCount) continue;
+            if (vertexRemap[idx] < 0) {
+                vertexRemap[idx] = static_cast<int>(newVertices.size() / 3);
+                newVertices.insert(newVertices.end(), data.vertices.begin() + 3 * idx, data.vertices.begin() + 3 * idx + 3);
+            }
+            idx = vertexRemap[idx];
+        }
+        for (int& idx : face.uvIndices) {
+            if (idx < 0 || static_cast<size_t>(idx) >= uvCount) continue;
+            if (uvRemap[idx] < 0) {
+                uvRemap[idx] = static_cast<int>(newUVs.size() / 2);
+                newUVs.push_back(data.uvCoordinates[2 * idx]);
+                newUVs.push_back(data.uvCoordinates[2 * idx + 1]);
+            }
+            idx = uvRemap[idx];
+        }
+    }
+
+    data.faces.swap(newFaces);
+    data.vertices.swap(newVertices);
+    data.uvCoordinates.swap(newUVs);
+
+    const double acmrAfter = ComputeACMR(data.faces, data.vertices.size() / 3, kACMRCacheSize);
+    auto t1 = Clock::now();
+    std::cerr << "OptimizeVertexCache: 面数 " << faceCount << ", ACMR(FIFO " << kACMRCacheSize << ") "
+              << acmrBefore << " -> " << acmrAfter << ", 耗时 " << Ms(t1 - t0).count() << " ms\n";
+}
+
 void ModelDeduplicator::DeduplicateModel(ModelData& data) {
     using Clock = std::chrono::high_resolution_clock;
     using Ms = std::chrono::duration<double, std::milli>;
@@ -943,7 +1527,7 @@ void ModelDeduplicator::DeduplicateModel(ModelData& data) {
         std::cerr << "DeduplicateFaces: " << Ms(t5 - t4).count() << " ms\n";
     }
 
-    if (config.useGreedyMesh) {
+    if (config.useGreedyMesh && !config.useTextureAtlas) {
         monitor.SetStatus(TaskStatus::GREEDY_MESHING, "GreedyMesh");
         {
             auto tg0 = Clock::now();
@@ -19,6 +19,12 @@ public:
     //贪心网格算法
     static void GreedyMesh(ModelData& data);
 
+    // 二次误差网格简化(锁定边界顶点),targetRatio 为目标三角形比例,maxError 为允许的最大偏移距离
+    static void SimplifyMesh(ModelData& data, float targetRatio, float maxError);
+
+    // 顶点缓存优化:按材质组以 Forsyth 算法重排面,再按首次使用顺序重排顶点/UV,并输出前后 ACMR
+    static void OptimizeVertexCache(ModelData& data);
+
     // 综合去重和优化方法
     static void DeduplicateModel(ModelData& data);
 
@@ -76,15 +76,18 @@ const std::vector<char>& GetRegionFromCache(int regionX, int regionZ) {
     return it->second;
 }
 
+// 判断指定 region 文件是否存在
+bool HasRegionFile(int regionX, int regionZ) {
+    std::ostringstream filePathStream;
+    filePathStream << GetRegionDirectory() << "/r." << regionX << "." << regionZ << ".mca";
+    return std::filesystem::exists(filePathStream.str());
+}
+
 // 新增:判断指定 chunk 是否存在于 region 文件中
 bool HasChunk(int chunkX, int chunkZ) {
     int regionX, regionZ;
     chunkToRegion(chunkX, chunkZ, regionX, regionZ);
-    std::string regionDir = GetRegionDirectory();
-    std::ostringstream filePathStream;
-    filePathStream << regionDir << "/r." << regionX << "." << regionZ << ".mca";
-    std::string filePath = filePathStream.str();
-    if (!std::filesystem::exists(filePath)) {
+    if (!HasRegionFile(regionX, regionZ)) {
         return false;
     }
     const auto& data = GetRegionFromCache(regionX, regionZ);
@@ -100,4 +103,4 @@ bool HasChunk(int chunkX, int chunkZ) {
     const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
     uint32_t offset = ((uint32_t)bytes[index] << 16) | ((uint32_t)bytes[index + 1] << 8) | (uint32_t)bytes[index + 2];
     return offset != 0;
-}
\ No newline at end of file
+}
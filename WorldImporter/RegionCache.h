@@ -9,5 +9,8 @@
 extern std::unordered_map<std::pair<int, int>, std::vector<char>, pair_hash> regionCache;
 const std::vector<char>& GetRegionFromCache(int regionX, int regionZ);
 
+// 判断指定 region 文件是否存在
+bool HasRegionFile(int regionX, int regionZ);
+
 // 新增:判断指定 chunk 是否存在于 region 文件中
 bool HasChunk(int chunkX, int chunkZ);
\ No newline at end of file
@@ -20,6 +20,8 @@
 #include <shared_mutex>
 #include "block.h"
 #include "TaskMonitor.h"
+#include "TextureAtlas.h"
+#include "TextureWriter.h"
 using namespace std;
 using namespace std::chrono;  // 新增:方便使用 chrono
 
@@ -125,6 +127,11 @@ void RegionModelExporter::ExportModels(const string& outputName) {
             // LOD0 禁用时,将中央区块按 LOD1 生成
             return ChunkGenerator::GenerateLODChunkModel(task.chunkX, task.sectionY, task.chunkZ, 1.0f);
         }
+        // 高度场远景区块:只在起始 Section 的任务中生成一次整列地形
+        if (config.useHeightfieldLOD && task.lodLevel >= config.heightfieldMinLOD) {
+            if (task.sectionY != config.sectionYStart) return ModelData();
+            return ChunkGenerator::GenerateHeightfieldChunkModel(task.chunkX, task.chunkZ);
+        }
         if (task.lodLevel == 0.0f) {
             return ChunkGenerator::GenerateChunkModel(task.chunkX, task.sectionY, task.chunkZ);
         } else {
@@ -174,14 +181,24 @@ void RegionModelExporter::ExportModels(const string& outputName) {
         std::tie(bExpXStart, bExpXEnd, bExpZStart, bExpZEnd) = get_batch_expanded_coords(batch);
 
         size_t beforeLoad = CountLoadedChunks();
+        BeginBlockstateCompilation();
         ChunkLoader::LoadChunks(bExpXStart, bExpXEnd, bExpZStart, bExpZEnd,
                                 sectionYStart, sectionYEnd);
         size_t afterLoad = CountLoadedChunks();
         size_t newlyLoaded = (afterLoad > beforeLoad) ? (afterLoad - beforeLoad) : 0;
 
+        // 等待加载期间发现的方块状态编译完成
+        monitor.SetStatus(TaskStatus::LOADING_CHUNKS, "编译批次 " + to_string(batchId) + " 方块状态");
+        WaitForBlockstateCompilation();
+
         // 处理天空光照邻居标志(在模型线程前执行,避免写冲突)
         UpdateSkyLightNeighborFlags();
 
+        // 预计算当前批次的群系颜色网格(LOD着色时直接查表)
+        if (config.activeLOD && config.useBiomeColors) {
+            Biome::BuildBiomeColorGrid(bExpXStart * 16, bExpZStart * 16, bExpXEnd * 16 + 15, bExpZEnd * 16 + 15);
+        }
+
         // ---------- 处理当前批次 ----------
         monitor.SetStatus(TaskStatus::GENERATING_MODELS, "生成批次 " + to_string(batchId) + " 模型");
         const auto& groupsInBatch = batch.groups;
@@ -220,18 +237,19 @@ void RegionModelExporter::ExportModels(const string& outputName) {
                     for (const auto& task : group.tasks) {
                         // 为当前区块生成生物群系地图数据 (如果尚未生成)
                         std::pair<int, int> chunkKey = {task.chunkX, task.chunkZ};
+                        bool claimBiomeChunk = false;
                         {
                             std::lock_guard<std::mutex> lock(biomeMutex);
-                            if (processedBiomeChunks.find(chunkKey) == processedBiomeChunks.end()) {
-                                // 计算当前区块的方块坐标范围
-                                int blockXStart = task.chunkX * 16;
-                                int blockXEnd = blockXStart + 15;
-                                int blockZStart = task.chunkZ * 16;
-                                int blockZEnd = blockZStart + 15;
-                                // 生成该区块的生物群系地图数据
-                                Biome::GenerateBiomeMap(blockXStart, blockZStart, blockXEnd, blockZEnd);
-                                processedBiomeChunks.insert(chunkKey);
-                            }
+                            claimBiomeChunk = processedBiomeChunks.insert(chunkKey).second;
+                        }
+                        if (claimBiomeChunk) {
+                            // 计算当前区块的方块坐标范围
+                            int blockXStart = task.chunkX * 16;
+                            int blockXEnd = blockXStart + 15;
+                            int blockZStart = task.chunkZ * 16;
+                            int blockZEnd = blockZStart + 15;
+                            // 生成该区块的生物群系地图数据(内部按瓦片加锁,可并行)
+                            Biome::GenerateBiomeMap(blockXStart, blockZStart, blockXEnd, blockZEnd);
                         }
 
                         ModelData chunkModel;
@@ -286,11 +304,34 @@ void RegionModelExporter::ExportModels(const string& outputName) {
                             monitor.SetStatus(TaskStatus::DEDUPLICATING_FACES, "DeduplicateFaces");
                             ModelDeduplicator::DeduplicateFaces(groupModel);
                             
-                            if (config.useGreedyMesh) {
+                            // 组内最精细的LOD等级决定简化强度
+                            float groupLOD = std::numeric_limits<float>::max();
+                            for (const auto& task : group.tasks) groupLOD = std::min(groupLOD, task.lodLevel);
+
+                            // 远景组使用网格简化(贪心合并产生的T形接点会被视为开放边界而锁定)
+                            if (config.activeLOD && config.useLODSimplify && groupLOD > 1.0f) {
+                                monitor.SetStatus(TaskStatus::GREEDY_MESHING, "SimplifyMesh");
+                                if (groupLOD <= 2.0f) {
+                                    ModelDeduplicator::SimplifyMesh(groupModel, config.LOD2simplifyRatio, config.LOD2simplifyError);
+                                } else if (groupLOD <= 4.0f) {
+                                    ModelDeduplicator::SimplifyMesh(groupModel, config.LOD3simplifyRatio, config.LOD3simplifyError);
+                                } else {
+                                    ModelDeduplicator::SimplifyMesh(groupModel, config.LOD4simplifyRatio, config.LOD4simplifyError);
+                                }
+                            }
+                            // 图集模式下合并面会产生平铺UV,无法放入图集
+                            else if (config.useGreedyMesh && !config.useTextureAtlas) {
                                 monitor.SetStatus(TaskStatus::GREEDY_MESHING, "GreedyMesh");
                                 ModelDeduplicator::GreedyMesh(groupModel);
                             }
                         }
+
+                        if (config.useTextureAtlas) {
+                            TextureAtlas::RemapModel(groupModel);
+                        }
+                        if (config.optimizeVertexCache) {
+                            ModelDeduplicator::OptimizeVertexCache(groupModel);
+                        }
                         
                         const string groupFileName = outputName +
                             "_x" + to_string(group.startX) +
@@ -304,6 +345,7 @@ void RegionModelExporter::ExportModels(const string& outputName) {
         for (auto& t : threads) {
             if (t.joinable()) t.join();
         }
+        Biome::ClearBiomeColorGrid();
 
         // ---------- 卸载当前批次 ----------
         size_t beforeUnload = CountLoadedChunks();
@@ -330,18 +372,18 @@ void RegionModelExporter::ExportModels(const string& outputName) {
 
     // 导出不同类型的生物群系颜色图片
     monitor.SetStatus(TaskStatus::EXPORTING_MODELS, "BiomeExportToPNG");
-    Biome::ExportToPNG("foliage.png", BiomeColorType::Foliage);
-    Biome::ExportToPNG("dry_foliage.png", BiomeColorType::DryFoliage);
-    Biome::ExportToPNG("water.png", BiomeColorType::Water);
-    Biome::ExportToPNG("grass.png", BiomeColorType::Grass);
-    Biome::ExportToPNG("waterFog.png", BiomeColorType::WaterFog);
-    Biome::ExportToPNG("fog.png", BiomeColorType::Fog);
-    Biome::ExportToPNG("sky.png", BiomeColorType::Sky);
+    Biome::ExportAllToPNG();
     // 最终导出处理
     if (config.exportFullModel && !finalMergedModel.vertices.empty()) {
         monitor.SetStatus(TaskStatus::DEDUPLICATING_VERTICES, "DeduplicateModel");
         ModelDeduplicator::DeduplicateModel(finalMergedModel);
         
+        if (config.useTextureAtlas) {
+            TextureAtlas::RemapModel(finalMergedModel);
+        }
+        if (config.optimizeVertexCache) {
+            ModelDeduplicator::OptimizeVertexCache(finalMergedModel);
+        }
         monitor.SetStatus(TaskStatus::EXPORTING_MODELS, "CreateModelFiles");
         CreateModelFiles(finalMergedModel, outputName);
     }
@@ -349,6 +391,16 @@ void RegionModelExporter::ExportModels(const string& outputName) {
         monitor.SetStatus(TaskStatus::EXPORTING_MODELS, "CreateSharedMtlFile");
         CreateSharedMtlFile(uniqueMaterials, outputName);
     }
+
+    // 所有模型写出后合成纹理图集
+    if (config.useTextureAtlas) {
+        monitor.SetStatus(TaskStatus::EXPORTING_MODELS, "TextureAtlas");
+        TextureAtlas::ExportPages();
+    }
+
+    // 等待后台纹理写出完成
+    monitor.SetStatus(TaskStatus::EXPORTING_MODELS, "FlushTextures");
+    TextureWriter::Flush();
     
     monitor.SetStatus(TaskStatus::COMPLETED, "Finished");
 }
@@ -0,0 +1,323 @@
+// TextureAtlas.cpp
+#include "TextureAtlas.h"
+#include "texture.h"
+#include "config.h"
+#include "TextureWriter.h"
+#include "objExporter.h"
+#include "include/stb_image.h"
+#include "include/stb_image_write.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+    // 纹理在图集中的位置(page 为 -1 表示不参与打包)
+    struct AtlasEntry {
+        int page = -1;
+        int x = 0, y = 0;          // 含边缘扩展区域的左上角
+        int width = 0, height = 0; // 纹理原始尺寸
+    };
+
+    // 单个图集页的 skyline(bottom-left)打包器
+    class SkylinePacker {
+    public:
+        explicit SkylinePacker(int size) : size(size) {
+            skyline.push_back({ 0, 0, size });
+        }
+
+        bool Insert(int width, int height, int& outX, int& outY) {
+            int bestIndex = -1;
+            int bestTop = INT_MAX, bestSegmentWidth = INT_MAX;
+            for (size_t i = 0; i < skyline.size(); ++i) {
+                int y = Fit(i, width, height);
+                if (y < 0) continue;
+                // 优先放在最低处,其次选择最窄的线段以减少浪费
+                if (y + height < bestTop || (y + height == bestTop && skyline[i].width < bestSegmentWidth)) {
+                    bestIndex = static_cast<int>(i);
+                    bestTop = y + height;
+                    bestSegmentWidth = skyline[i].width;
+                }
+            }
+            if (bestIndex < 0) return false;
+
+            outX = skyline[bestIndex].x;
+            outY = bestTop - height;
+            skyline.insert(skyline.begin() + bestIndex, { outX, bestTop, width });
+
+            // 裁剪被新线段覆盖的后续线段
+            for (size_t i = bestIndex + 1; i < skyline.size();) {
+                const Segment& prev = skyline[i - 1];
+                int overlap = prev.x + prev.width - skyline[i].x;
+                if (overlap <= 0) break;
+                skyline[i].x += overlap;
+                skyline[i].width -= overlap;
+                if (skyline[i].width > 0) break;
+                skyline.erase(skyline.begin() + i);
+            }
+
+            // 合并等高的相邻线段
+            for (size_t i = 0; i + 1 < skyline.size();) {
+                if (skyline[i].y == skyline[i + 1].y) {
+                    skyline[i].width += skyline[i + 1].width;
+                    skyline.erase(skyline.begin() + i + 1);
+                }
+                else {
+                    ++i;
+                }
+            }
+            return true;
+        }
+
+    private:
+        struct Segment {
+            int x, y, width;
+        };
+
+        // 以第 index 条线段为左端放置矩形时的 y 坐标,放不下时返回 -1
+        int Fit(size_t index, int width, int height) const {
+            int x = skyline[index].x;
+            if (x + width > size) return -1;
+            int y = skyline[index].y;
+            int widthLeft = width;
+            for (size_t i = index; widthLeft > 0 && i < skyline.size(); ++i) {
+                y = std::max(y, skyline[i].y);
+                if (y + height > size) return -1;
+                widthLeft -= skyline[i].width;
+            }
+            return y;
+        }
+
+        int size;
+        std::vector<Segment> skyline;
+    };
+
+    std::mutex atlasMutex;
+    std::vector<SkylinePacker> pages;
+    std::unordered_map<std::string, AtlasEntry> entries; // 纹理路径 -> 图集位置
+
+    int GetPageSize() {
+        // 向上取整到2的幂,并限制在 [256, 16384]
+        int requested = std::clamp(config.textureAtlasSize, 256, 16384);
+        int size = 256;
+        while (size < requested) size <<= 1;
+        return size;
+    }
+
+    int GetPadding() {
+        return std::clamp(config.textureAtlasPadding, 0, 16);
+    }
+
+    std::string GetPageTexturePath(int page) {
+        return "textures/atlas/atlas_" + std::to_string(page) + ".png";
+    }
+
+    AtlasEntry GetEntry(const Material& material) {
+        // 动态/连接纹理需要整张贴图,不参与打包
+        if (material.type != NORMAL || material.texturePath.compare(0, 9, "textures/") != 0) {
+            return AtlasEntry();
+        }
+        {
+            std::lock_guard<std::mutex> lock(atlasMutex);
+            auto it = entries.find(material.texturePath);
+            if (it != entries.end()) return it->second;
+        }
+
+        // 锁外解压并读取尺寸
+        AtlasEntry entry;
+        std::vector<unsigned char> pngData;
+        int width = 0, height = 0, channels = 0;
+        bool loaded = LoadTextureByMaterialPath(material.texturePath, pngData) &&
+            stbi_info_from_memory(pngData.data(), static_cast<int>(pngData.size()), &width, &height, &channels);
+
+        std::lock_guard<std::mutex> lock(atlasMutex);
+        auto it = entries.find(material.texturePath);
+        if (it != entries.end()) return it->second;
+
+        const int pageSize = GetPageSize();
+        const int padding = GetPadding();
+        int paddedWidth = width + padding * 2;
+        int paddedHeight = height + padding * 2;
+        if (loaded && width > 0 && height > 0 && paddedWidth <= pageSize && paddedHeight <= pageSize) {
+            entry.width = width;
+            entry.height = height;
+            for (size_t i = 0; i < pages.size() && entry.page < 0; ++i) {
+                if (pages[i].Insert(paddedWidth, paddedHeight, entry.x, entry.y)) {
+                    entry.page = static_cast<int>(i);
+                }
+            }
+            if (entry.page < 0) {
+                pages.emplace_back(pageSize);
+                pages.back().Insert(paddedWidth, paddedHeight, entry.x, entry.y);
+                entry.page = static_cast<int>(pages.size() - 1);
+            }
+        }
+        entries.emplace(material.texturePath, entry);
+        return entry;
+    }
+}
+
+namespace TextureAtlas {
+    void RemapModel(ModelData& data) {
+        if (data.materials.empty()) return;
+
+        std::vector<AtlasEntry> materialEntries(data.materials.size());
+        for (size_t i = 0; i < data.materials.size(); ++i) {
+            materialEntries[i] = GetEntry(data.materials[i]);
+        }
+
+        const float pageSize = static_cast<float>(GetPageSize());
+        const int padding = GetPadding();
+        const float eps = 1e-4f;
+
+        std::vector<Material> newMaterials;
+        std::vector<int> keptMaterials(data.materials.size(), -1);   // 原材质索引 -> 新索引
+        std::map<std::pair<int, int>, int> atlasMaterials;           // (图集页, tint) -> 新索引
+        std::vector<float> newUVs;
+        newUVs.reserve(data.uvCoordinates.size());
+        std::unordered_map<uint64_t, int> uvRemap;                   // (原UV索引, 图集材质+1) -> 新UV索引
+
+        for (auto& face : data.faces) {
+            int matIndex = face.materialIndex;
+            bool validMaterial = matIndex >= 0 && matIndex < static_cast<int>(data.materials.size());
+            const AtlasEntry* entry = (validMaterial && materialEntries[matIndex].page >= 0) ? &materialEntries[matIndex] : nullptr;
+
+            // UV 超出 [0,1] 的面使用了平铺,无法放入图集
+            if (entry) {
+                for (int uvIdx : face.uvIndices) {
+                    float u = data.uvCoordinates[uvIdx * 2];
+                    float v = data.uvCoordinates[uvIdx * 2 + 1];
+                    if (u < -eps || u > 1.0f + eps || v < -eps || v > 1.0f + eps) {
+                        entry = nullptr;
+                        break;
+                    }
+                }
+            }
+
+            if (entry) {
+                const Material& source = data.materials[matIndex];
+                auto key = std::make_pair(entry->page, static_cast<int>(source.tintIndex));
+                auto it = atlasMaterials.find(key);
+                if (it == atlasMaterials.end()) {
+                    std::string name = "atlas_" + std::to_string(entry->page);
+                    if (source.tintIndex != -1) name += "_tint" + std::to_string(source.tintIndex);
+                    it = atlasMaterials.emplace(key, static_cast<int>(newMaterials.size())).first;
+                    newMaterials.emplace_back(name, GetPageTexturePath(entry->page), source.tintIndex);
+                }
+                face.materialIndex = it->second;
+            }
+            else if (validMaterial) {
+                if (keptMaterials[matIndex] < 0) {
+                    keptMaterials[matIndex] = static_cast<int>(newMaterials.size());
+                    newMaterials.push_back(data.materials[matIndex]);
+                    // 未打包的纹理仍引用单独文件,首次保留时写出
+                    WriteDeferredTexture(data.materials[matIndex].texturePath);
+                }
+                face.materialIndex = keptMaterials[matIndex];
+            }
+
+            uint32_t remapTag = entry ? static_cast<uint32_t>(matIndex + 1) : 0;
+            for (int& uvIdx : face.uvIndices) {
+                uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(uvIdx)) << 32) | remapTag;
+                auto [it, inserted] = uvRemap.try_emplace(key, static_cast<int>(newUVs.size() / 2));
+                if (inserted) {
+                    float u = data.uvCoordinates[uvIdx * 2];
+                    float v = data.uvCoordinates[uvIdx * 2 + 1];
+                    if (entry) {
+                        // 纹理空间(v 向上)-> 图集像素(y 向下)-> 图集 UV
+                        u = std::clamp(u, 0.0f, 1.0f);
+                        v = std::clamp(v, 0.0f, 1.0f);
+                        float px = entry->x + padding + u * entry->width;
+                        float py = entry->y + padding + (1.0f - v) * entry->height;
+                        u = px / pageSize;
+                        v = 1.0f - py / pageSize;
+                    }
+                    newUVs.push_back(u);
+                    newUVs.push_back(v);
+                }
+                uvIdx = it->second;
+            }
+        }
+
+        data.materials.swap(newMaterials);
+        data.uvCoordinates.swap(newUVs);
+    }
+
+    void ExportPages() {
+        std::vector<std::vector<std::pair<std::string, AtlasEntry>>> pageEntries;
+        {
+            std::lock_guard<std::mutex> lock(atlasMutex);
+            pageEntries.resize(pages.size());
+            for (const auto& pair : entries) {
+                if (pair.second.page >= 0) {
+                    pageEntries[pair.second.page].push_back(pair);
+                }
+            }
+        }
+        if (pageEntries.empty()) return;
+
+        namespace fs = std::filesystem;
+        const int pageSize = GetPageSize();
+        const int padding = GetPadding();
+        std::string exeDir = getExecutableDir();
+
+        // 每个线程独立合成一页(单页占用 size*size*4 字节)
+        unsigned numThreads = std::min<unsigned>(std::max<unsigned>(1, std::thread::hardware_concurrency()),
+            static_cast<unsigned>(pageEntries.size()));
+        std::atomic<size_t> nextPage{ 0 };
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < numThreads; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<unsigned char> pixels;
+                std::vector<unsigned char> pngData;
+                for (size_t page = nextPage.fetch_add(1); page < pageEntries.size(); page = nextPage.fetch_add(1)) {
+                    pixels.assign(static_cast<size_t>(pageSize) * pageSize * 4, 0);
+                    for (const auto& [texturePath, entry] : pageEntries[page]) {
+                        int width = 0, height = 0, channels = 0;
+                        if (!LoadTextureByMaterialPath(texturePath, pngData)) continue;
+                        unsigned char* source = stbi_load_from_memory(pngData.data(), static_cast<int>(pngData.size()),
+                            &width, &height, &channels, 4);
+                        if (!source) continue;
+                        if (width == entry.width && height == entry.height) {
+                            // 复制纹理,并将边缘像素扩展到四周的填充区域
+                            for (int dy = -padding; dy < height + padding; ++dy) {
+                                int sy = std::clamp(dy, 0, height - 1);
+                                unsigned char* dst = pixels.data() +
+                                    (static_cast<size_t>(entry.y + padding + dy) * pageSize + entry.x) * 4;
+                                for (int dx = -padding; dx < width + padding; ++dx) {
+                                    int sx = std::clamp(dx, 0, width - 1);
+                                    std::memcpy(dst + (dx + padding) * 4, source + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                                }
+                            }
+                        }
+                        stbi_image_free(source);
+                    }
+
+                    // 编码到内存后交给 TextureWriter 写出,与其他纹理共用写出队列
+                    std::vector<unsigned char> encoded;
+                    stbi_write_png_to_func([](void* context, void* data, int size) {
+                        auto* out = static_cast<std::vector<unsigned char>*>(context);
+                        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                        out->insert(out->end(), bytes, bytes + size);
+                    }, &encoded, pageSize, pageSize, 4, pixels.data(), pageSize * 4);
+                    fs::path filePath = fs::path(exeDir) / GetPageTexturePath(static_cast<int>(page));
+                    if (encoded.empty()) {
+                        std::cerr << "Error: Failed to encode texture atlas " << filePath.string() << std::endl;
+                        continue;
+                    }
+                    TextureWriter::Enqueue(filePath, std::move(encoded));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::cout << "Texture atlas: " << pageEntries.size() << " pages (" << pageSize << "x" << pageSize << ")" << std::endl;
+    }
+}
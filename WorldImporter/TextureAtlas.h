@@ -0,0 +1,16 @@
+#pragma once
+
+#include "model.h"
+
+// ========= 纹理图集 =========
+// 将引用到的非动态方块纹理在线打包进固定边长(2的幂)的图集页(skyline 算法)。
+// 纹理首次被引用时即确定位置,各分组模型可立即重映射 UV 并写出,
+// 所有模型导出完成后再由 ExportPages 合成图集 PNG
+namespace TextureAtlas {
+    // 将模型中可打包的纹理材质替换为图集材质(按图集页与 tint 区分),并重映射面 UV(线程安全)
+    // UV 超出单张纹理范围的面(平铺)保留原材质
+    void RemapModel(ModelData& data);
+
+    // 合成所有图集页,交由 TextureWriter 写入 textures/atlas/ 目录(需随后调用 TextureWriter::Flush)
+    void ExportPages();
+}
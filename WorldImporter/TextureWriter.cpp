@@ -0,0 +1,221 @@
+// TextureWriter.cpp
+#include "TextureWriter.h"
+#include "config.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    struct WriteTask {
+        fs::path filePath;
+        std::vector<unsigned char> data;
+    };
+
+    // 内容指纹:FNV-1a 64 位哈希 + 长度
+    struct ContentKey {
+        uint64_t hash;
+        size_t size;
+        bool operator==(const ContentKey& other) const { return hash == other.hash && size == other.size; }
+    };
+
+    struct ContentKeyHasher {
+        size_t operator()(const ContentKey& key) const {
+            return static_cast<size_t>(key.hash ^ (static_cast<uint64_t>(key.size) * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    ContentKey HashContent(const std::vector<unsigned char>& data) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return { hash, data.size() };
+    }
+
+    // 逐字节比较磁盘上已写出的文件与待写内容(避免哈希碰撞链接到错误的纹理)
+    bool FileContentEquals(const fs::path& filePath, const std::vector<unsigned char>& data) {
+        std::error_code ec;
+        if (fs::file_size(filePath, ec) != data.size() || ec) return false;
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file.is_open()) return false;
+        std::vector<unsigned char> buffer(64 * 1024);
+        size_t offset = 0;
+        while (offset < data.size()) {
+            size_t chunk = std::min(buffer.size(), data.size() - offset);
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(chunk));
+            if (static_cast<size_t>(file.gcount()) != chunk) return false;
+            if (std::memcmp(buffer.data(), data.data() + offset, chunk) != 0) return false;
+            offset += chunk;
+        }
+        return true;
+    }
+
+    class TextureWriteQueue {
+    public:
+        ~TextureWriteQueue() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            taskCv.notify_all();
+            for (auto& worker : workers) {
+                if (worker.joinable()) worker.join();
+            }
+        }
+
+        void Enqueue(const fs::path& filePath, std::vector<unsigned char> data) {
+            std::unique_lock<std::mutex> lock(mutex);
+            // 同一路径只写一次(多个调用方可能重复保存同一纹理)
+            if (!requestedPaths.insert(filePath.generic_string()).second) return;
+
+            if (workers.empty()) {
+                // 写文件以磁盘IO为主,少量线程即可
+                unsigned numThreads = std::clamp<unsigned>(std::thread::hardware_concurrency() / 2, 1, 4);
+                for (unsigned i = 0; i < numThreads; ++i) {
+                    workers.emplace_back([this]() { WorkerLoop(); });
+                }
+            }
+
+            const size_t capacity = static_cast<size_t>(std::max(1, config.textureWriteQueueSize));
+            spaceCv.wait(lock, [&]() { return pending.size() < capacity; });
+            pending.push_back({ filePath, std::move(data) });
+            lock.unlock();
+            taskCv.notify_one();
+        }
+
+        void Flush() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idleCv.wait(lock, [this]() { return pending.empty() && inFlight == 0; });
+            // 写出完成后释放内容指纹表
+            std::lock_guard<std::mutex> contentLock(contentMutex);
+            writtenContent.clear();
+        }
+
+    private:
+        void WorkerLoop() {
+            while (true) {
+                WriteTask task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    taskCv.wait(lock, [this]() { return stopping || !pending.empty(); });
+                    if (pending.empty()) return; // stopping 且队列已清空
+                    task = std::move(pending.front());
+                    pending.pop_front();
+                    ++inFlight;
+                }
+                spaceCv.notify_one();
+
+                Write(task);
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    --inFlight;
+                    if (pending.empty() && inFlight == 0) idleCv.notify_all();
+                }
+            }
+        }
+
+        void Write(const WriteTask& task) {
+            EnsureDirectory(task.filePath.parent_path());
+
+            // 先删除旧文件:上次导出可能把该路径硬链接到其他文件,直接截断写入会改写所有链接到同一 inode 的文件
+            std::error_code ec;
+            fs::remove(task.filePath, ec);
+
+            // 内容相同的文件已写出时尝试创建硬链接,失败则正常写入;
+            // 只记录指纹与路径,指纹相同时读取磁盘上的文件逐字节确认
+            const std::vector<unsigned char>& data = task.data;
+            ContentKey key = HashContent(data);
+            std::vector<fs::path> candidates;
+            {
+                std::lock_guard<std::mutex> lock(contentMutex);
+                auto it = writtenContent.find(key);
+                if (it != writtenContent.end()) candidates = it->second;
+            }
+            bool duplicate = false;
+            for (const auto& existing : candidates) {
+                if (!FileContentEquals(existing, data)) continue;
+                duplicate = true;
+                fs::create_hard_link(existing, task.filePath, ec);
+                if (!ec) return;
+                break;
+            }
+
+            std::ofstream file(task.filePath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Failed to save texture: " << task.filePath.string() << std::endl;
+                return;
+            }
+            file.write(reinterpret_cast<const char*>(data.data()), data.size());
+            file.close();
+            if (!file) {
+                std::cerr << "Failed to save texture: " << task.filePath.string() << std::endl;
+                return;
+            }
+
+            // 相同内容只需记录一个源文件(同一指纹下仅哈希碰撞时才会有多个文件)
+            if (duplicate) return;
+            std::lock_guard<std::mutex> lock(contentMutex);
+            writtenContent[key].push_back(task.filePath);
+        }
+
+        // 目录只创建一次
+        void EnsureDirectory(const fs::path& directory) {
+            if (directory.empty()) return;
+            std::string key = directory.generic_string();
+            {
+                std::lock_guard<std::mutex> lock(directoryMutex);
+                if (createdDirectories.count(key)) return;
+            }
+            std::error_code ec;
+            fs::create_directories(directory, ec);
+            if (ec) {
+                std::cerr << "Failed to create directory: " << key << " (" << ec.message() << ")" << std::endl;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(directoryMutex);
+            createdDirectories.insert(std::move(key));
+        }
+
+        std::mutex mutex;
+        std::condition_variable taskCv;
+        std::condition_variable spaceCv;
+        std::condition_variable idleCv;
+        std::deque<WriteTask> pending;
+        size_t inFlight = 0;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+        std::unordered_set<std::string> requestedPaths;
+
+        std::mutex directoryMutex;
+        std::unordered_set<std::string> createdDirectories;
+
+        std::mutex contentMutex;
+        std::unordered_map<ContentKey, std::vector<fs::path>, ContentKeyHasher> writtenContent; // 内容指纹 -> 已写出的文件
+    };
+
+    TextureWriteQueue& GetTextureWriteQueue() {
+        static TextureWriteQueue queue;
+        return queue;
+    }
+}
+
+namespace TextureWriter {
+    void Enqueue(const std::filesystem::path& filePath, std::vector<unsigned char> data) {
+        GetTextureWriteQueue().Enqueue(filePath, std::move(data));
+    }
+
+    void Flush() {
+        GetTextureWriteQueue().Flush();
+    }
+}
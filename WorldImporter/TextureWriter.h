@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// ========= 异步纹理写出 =========
+// 纹理及其 .mcmeta / PBR 附属文件通过有界队列交给后台线程写出,导出纹理与生成模型并行。
+// 同一路径只写一次;内容相同的文件优先以硬链接代替重复写入;目录只创建一次
+namespace TextureWriter {
+    // 提交写出请求(队列已满时阻塞调用方,直到有空位)
+    void Enqueue(const std::filesystem::path& filePath, std::vector<unsigned char> data);
+
+    // 等待已提交的文件全部写出
+    void Flush();
+}
@@ -0,0 +1,136 @@
+// VertexKeySort.cpp
+#include "VertexKeySort.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <thread>
+
+void ComputeVertexKeys(const std::vector<float>& vertices, std::vector<VertexKeyAndIndex>& keys, unsigned int numThreads) {
+    const size_t vertCount = vertices.size() / 3;
+    keys.resize(vertCount);
+    if (vertCount == 0) return;
+    if (numThreads == 0) numThreads = 1;
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    size_t chunk = (vertCount + numThreads - 1) / numThreads;
+
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        size_t start = t * chunk;
+        size_t end = std::min(start + chunk, vertCount);
+        threads.emplace_back([&, start, end]() {
+            for (size_t i = start; i < end; ++i) {
+                // 确保精确的量化，使用相同的舍入方法
+                int rx = static_cast<int>(std::round(vertices[3 * i] * 10000.0f));
+                int ry = static_cast<int>(std::round(vertices[3 * i + 1] * 10000.0f));
+                int rz = static_cast<int>(std::round(vertices[3 * i + 2] * 10000.0f));
+                keys[i] = { VertexKey{ rx, ry, rz }, static_cast<int>(i) };
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+}
+
+// 原实现:按 x,y,z 字典序稳定排序
+void SortVertexKeysStable(std::vector<VertexKeyAndIndex>& keys) {
+    std::stable_sort(keys.begin(), keys.end(), [](const VertexKeyAndIndex& a, const VertexKeyAndIndex& b) {
+        if (a.key.x != b.key.x) return a.key.x < b.key.x;
+        if (a.key.y != b.key.y) return a.key.y < b.key.y;
+        return a.key.z < b.key.z;
+    });
+}
+
+// 并行LSD基数排序:各轴减去最小值后只排序实际用到的位,
+// 依次按 z、y、x 的低位到高位分趟,结果与稳定字典序排序完全一致
+void SortVertexKeysRadix(std::vector<VertexKeyAndIndex>& keys, unsigned int numThreads) {
+    constexpr int kDigitBits = 11;
+    constexpr uint32_t kBuckets = 1u << kDigitBits;
+    const size_t count = keys.size();
+    if (count < 2) return;
+    numThreads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(numThreads, count / 65536 + 1)));
+
+    int minX = INT_MAX, minY = INT_MAX, minZ = INT_MAX;
+    int maxX = INT_MIN, maxY = INT_MIN, maxZ = INT_MIN;
+    for (const auto& k : keys) {
+        minX = std::min(minX, k.key.x); maxX = std::max(maxX, k.key.x);
+        minY = std::min(minY, k.key.y); maxY = std::max(maxY, k.key.y);
+        minZ = std::min(minZ, k.key.z); maxZ = std::max(maxZ, k.key.z);
+    }
+    auto bitWidth = [](int lo, int hi) {
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(hi) - lo);
+        int bits = 0;
+        while (range) { ++bits; range >>= 1; }
+        return bits;
+    };
+
+    // 每一趟:轴、最小值、位移
+    struct Pass { int axis; int minValue; int shift; };
+    std::vector<Pass> passes;
+    const int axisMin[3] = { minZ, minY, minX };
+    const int axisBits[3] = { bitWidth(minZ, maxZ), bitWidth(minY, maxY), bitWidth(minX, maxX) };
+    const int axisIndex[3] = { 2, 1, 0 };
+    for (int a = 0; a < 3; ++a) {
+        for (int shift = 0; shift < axisBits[a]; shift += kDigitBits) {
+            passes.push_back({ axisIndex[a], axisMin[a], shift });
+        }
+    }
+    if (passes.empty()) return;
+
+    std::vector<VertexKeyAndIndex> buffer(count);
+    std::vector<VertexKeyAndIndex>* src = &keys;
+    std::vector<VertexKeyAndIndex>* dst = &buffer;
+    std::vector<uint32_t> histograms(static_cast<size_t>(numThreads) * kBuckets);
+    const size_t chunk = (count + numThreads - 1) / numThreads;
+
+    for (const Pass& pass : passes) {
+        auto digitOf = [&pass](const VertexKeyAndIndex& k) {
+            int v = pass.axis == 0 ? k.key.x : (pass.axis == 1 ? k.key.y : k.key.z);
+            uint32_t offset = static_cast<uint32_t>(static_cast<int64_t>(v) - pass.minValue);
+            return (offset >> pass.shift) & (kBuckets - 1);
+        };
+        auto runParallel = [&](auto&& body) {
+            std::vector<std::thread> threads;
+            threads.reserve(numThreads);
+            for (unsigned int t = 0; t < numThreads; ++t) {
+                threads.emplace_back(body, t);
+            }
+            for (auto& th : threads) th.join();
+        };
+
+        // 1. 各线程统计本段直方图
+        std::fill(histograms.begin(), histograms.end(), 0u);
+        runParallel([&](unsigned int t) {
+            uint32_t* hist = histograms.data() + static_cast<size_t>(t) * kBuckets;
+            size_t start = t * chunk;
+            size_t end = std::min(start + chunk, count);
+            for (size_t i = start; i < end; ++i) {
+                ++hist[digitOf((*src)[i])];
+            }
+        });
+
+        // 2. 按(桶,线程)顺序求前缀和,保证稳定性
+        uint32_t offset = 0;
+        for (uint32_t b = 0; b < kBuckets; ++b) {
+            for (unsigned int t = 0; t < numThreads; ++t) {
+                uint32_t& slot = histograms[static_cast<size_t>(t) * kBuckets + b];
+                uint32_t c = slot;
+                slot = offset;
+                offset += c;
+            }
+        }
+
+        // 3. 各线程将本段元素散列到目标位置
+        runParallel([&](unsigned int t) {
+            uint32_t* hist = histograms.data() + static_cast<size_t>(t) * kBuckets;
+            size_t start = t * chunk;
+            size_t end = std::min(start + chunk, count);
+            for (size_t i = start; i < end; ++i) {
+                const VertexKeyAndIndex& k = (*src)[i];
+                (*dst)[hist[digitOf(k)]++] = k;
+            }
+        });
+        std::swap(src, dst);
+    }
+    if (src != &keys) {
+        keys.swap(buffer);
+    }
+}
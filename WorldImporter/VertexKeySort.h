@@ -0,0 +1,23 @@
+// VertexKeySort.h
+#ifndef VERTEX_KEY_SORT_H
+#define VERTEX_KEY_SORT_H
+
+#include <vector>
+#include "model.h"
+
+// 量化后的顶点键与原始顶点索引
+struct VertexKeyAndIndex {
+    VertexKey key;
+    int oldIndex;
+};
+
+// 并行计算顶点键(坐标乘以10000后四舍五入)
+void ComputeVertexKeys(const std::vector<float>& vertices, std::vector<VertexKeyAndIndex>& keys, unsigned int numThreads);
+
+// 原实现:按 x,y,z 字典序稳定排序
+void SortVertexKeysStable(std::vector<VertexKeyAndIndex>& keys);
+
+// 并行LSD基数排序,结果与 SortVertexKeysStable 完全一致
+void SortVertexKeysRadix(std::vector<VertexKeyAndIndex>& keys, unsigned int numThreads);
+
+#endif // VERTEX_KEY_SORT_H
@@ -0,0 +1,104 @@
+// VertexDedupBenchmark.cpp
+// 顶点键排序基准:读取导出的OBJ模型(v 行即 ModelData::vertices),
+// 比较 SortVertexKeysRadix 与 SortVertexKeysStable 的吞吐量(keys/s)
+//
+// 用法: VertexDedupBenchmark <model.obj> [model2.obj ...] [--repeat N] [--threads N]
+#include "../VertexKeySort.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // 读取OBJ中的全部顶点坐标
+    bool LoadObjVertices(const std::string& path, std::vector<float>& vertices) {
+        std::ifstream file(path);
+        if (!file) return false;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.size() < 2 || line[0] != 'v' || line[1] != ' ') continue;
+            float x, y, z;
+            if (std::sscanf(line.c_str() + 2, "%f %f %f", &x, &y, &z) == 3) {
+                vertices.push_back(x);
+                vertices.push_back(y);
+                vertices.push_back(z);
+            }
+        }
+        return true;
+    }
+
+    // 多次运行取最短耗时(毫秒),每次在原始键的副本上排序
+    template <typename SortFn>
+    double MeasureBest(const std::vector<VertexKeyAndIndex>& source, std::vector<VertexKeyAndIndex>& result, int repeat, SortFn sortFn) {
+        using Clock = std::chrono::high_resolution_clock;
+        double best = 0.0;
+        for (int r = 0; r < repeat; ++r) {
+            result = source;
+            auto t0 = Clock::now();
+            sortFn(result);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            if (r == 0 || ms < best) best = ms;
+        }
+        return best;
+    }
+
+    double KeysPerSecond(size_t count, double ms) {
+        return ms > 0.0 ? count / (ms / 1000.0) : 0.0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    int repeat = 5;
+    unsigned int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "用法: VertexDedupBenchmark <model.obj> [model2.obj ...] [--repeat N] [--threads N]" << std::endl;
+        return 1;
+    }
+
+    bool allIdentical = true;
+    for (const auto& path : files) {
+        std::vector<float> vertices;
+        if (!LoadObjVertices(path, vertices) || vertices.empty()) {
+            std::cerr << "无法读取模型顶点: " << path << std::endl;
+            continue;
+        }
+
+        std::vector<VertexKeyAndIndex> keys;
+        ComputeVertexKeys(vertices, keys, numThreads);
+
+        std::vector<VertexKeyAndIndex> stableResult, radixResult;
+        double stableMs = MeasureBest(keys, stableResult, repeat, [](std::vector<VertexKeyAndIndex>& k) {
+            SortVertexKeysStable(k);
+        });
+        double radixMs = MeasureBest(keys, radixResult, repeat, [numThreads](std::vector<VertexKeyAndIndex>& k) {
+            SortVertexKeysRadix(k, numThreads);
+        });
+        bool identical = std::equal(stableResult.begin(), stableResult.end(), radixResult.begin(),
+            [](const VertexKeyAndIndex& a, const VertexKeyAndIndex& b) { return a.oldIndex == b.oldIndex; });
+        allIdentical = allIdentical && identical;
+
+        std::printf("%s\n", path.c_str());
+        std::printf("  keys: %zu, threads: %u, repeat: %d\n", keys.size(), numThreads, repeat);
+        std::printf("  SortVertexKeysStable: %10.2f ms  %14.0f keys/s\n", stableMs, KeysPerSecond(keys.size(), stableMs));
+        std::printf("  SortVertexKeysRadix:  %10.2f ms  %14.0f keys/s\n", radixMs, KeysPerSecond(keys.size(), radixMs));
+        std::printf("  speedup: %.2fx, result %s\n", radixMs > 0.0 ? stableMs / radixMs : 0.0,
+            identical ? "identical" : "MISMATCH");
+    }
+    return allIdentical ? 0 : 2;
+}
@@ -6,12 +6,20 @@
 #include "block.h"
 #include "GlobalCache.h"
 #include "locutil.h"
+#include "LODManager.h"
 #include <iostream>
 #include <stdexcept>
 #include <filesystem>
 #include <fstream>
 #include <string>
 #include "hashutils.h"
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+#include <climits>
+#include <zlib.h>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -65,60 +73,6 @@ static std::string getExecutableDir() {
     }
 }
 
-bool SaveColormapToFile(const std::vector<unsigned char>& pixelData,const std::string& namespaceName,const std::string& colormapName,std::string& savePath) {
-    // 检查是否找到了纹理数据
-    if (!pixelData.empty()) {
-
-        // 获取当前工作目录(即 exe 所在的目录)
-        std::string exePath = getExecutableDir();
-
-        // 获取 exe 所在目录
-        size_t pos = exePath.find_last_of("\\/");
-        std::string exeDir = exePath.substr(0, pos);
-
-        // 如果传入了 savePath, 则使用 savePath 作为保存目录,否则默认使用当前 exe 目录
-        if (savePath.empty()) {
-            savePath = exeDir + "\\colormap";  // 默认保存到 exe 目录下的 textures 文件夹
-        }
-        else {
-            savePath = exeDir + "\\" + savePath;  // 使用提供的 savePath 路径
-        }
-
-        // 创建保存目录(如果不存在)
-        if (!std::filesystem::exists(savePath)) {
-            // 文件夹不存在,创建它
-            if (!std::filesystem::create_directories(savePath)) {
-                std::cerr << "Failed to create directory: " << savePath << std::endl;
-                return false;
-            }
-        }
-
-        // 处理 blockId,去掉路径部分,保留最后的文件名
-        size_t lastSlashPos = colormapName.find_last_of("/\\");
-        std::string fileName = (lastSlashPos == std::string::npos) ? colormapName : colormapName.substr(lastSlashPos + 1);
-
-        // 构建保存路径,使用处理后的 blockId 作为文件名
-        std::string filePath = savePath + "\\" + fileName + ".png";
-        std::ofstream outputFile(filePath, std::ios::binary);
-
-        //返回savePath,作为value
-        savePath = filePath;
-
-        if (outputFile.is_open()) {
-            outputFile.write(reinterpret_cast<const char*>(pixelData.data()), pixelData.size());
-        }
-        else {
-            std::cerr << "Failed to open output file!" << std::endl;
-            return false;
-        }
-    }
-    else {
-        std::cerr << "Failed to retrieve texture for " << colormapName << std::endl;
-        return false;
-    }
-    return true;
-}
-
 int GetBiomeId(int blockX, int blockY, int blockZ) {
     // 将世界坐标转换为区块坐标
     int chunkX, chunkZ;
@@ -133,7 +87,8 @@ int GetBiomeId(int blockX, int blockY, int blockZ) {
 
     // 检查 SectionCache 中是否存在对应的区块数据,如果没有则加载
     if (sectionCache.find(blockKey) == sectionCache.end()) {
-        LoadAndCacheBlockData(chunkX, chunkZ);
+        // 与 ChunkLoader 使用相同的加载方式,避免把高度场远景区块升级为完整加载
+        LoadAndCacheBlockData(chunkX, chunkZ, LODManager::IsHeightfieldChunk(chunkX, chunkZ));
     }
 
     const auto& biomeData = sectionCache[blockKey].biomeData;
@@ -150,48 +105,64 @@ int GetBiomeId(int blockX, int blockY, int blockZ) {
 }
 
 // 初始化静态成员
-std::unordered_map<std::string, BiomeInfo> Biome::biomeRegistry;
+std::unordered_map<std::string, int> Biome::biomeRegistry;
 std::shared_mutex Biome::registryMutex;
 
+// 按ID索引的只追加群系表,读取无需加锁
+static constexpr size_t kMaxBiomeCount = 8192;
+static std::atomic<const BiomeInfo*> biomeTable[kMaxBiomeCount];
+static std::atomic<int> biomeCount{ 0 };
+
 nlohmann::json Biome::GetBiomeJson(const std::string& namespaceName, const std::string& biomeId) {
-    std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-
-    // 按照 JAR 文件的加载顺序逐个查找
-    for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-        const std::string& modId = GlobalCache::jarOrder[i];
-        std::string cacheKey = modId + ":" + namespaceName + ":" + biomeId;
-        auto it = GlobalCache::biomes.find(cacheKey);
-        if (it != GlobalCache::biomes.end()) {
-            return it->second;
-        }
+    // 覆盖关系已在初始化时解析,直接查找生效版本
+    if (auto entry = GlobalCache::FindResolved(GlobalCache::resolvedBiomes, namespaceName, biomeId)) {
+        return entry->second;
     }
 
     std::cerr << "Biome JSON not found: " << namespaceName << ":" << biomeId << std::endl;
     return nlohmann::json();
 }
 
-std::string Biome::GetColormapData(const std::string& namespaceName, const std::string& colormapName) {
-    std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-
-    // 按照 JAR 文件的加载顺序逐个查找
-    for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-        const std::string& modId = GlobalCache::jarOrder[i];
-        std::string cacheKey = modId + ":" + namespaceName + ":" + colormapName;
-        auto it = GlobalCache::colormaps.find(cacheKey);
-        if (it != GlobalCache::colormaps.end()) {
-            std::string filePath;
-            if (SaveColormapToFile(it->second, namespaceName, colormapName, filePath)) {
-                return filePath;
-            }
-            else {
-                std::cerr << "Failed to save colormap: " << cacheKey << std::endl;
-                return "";
-            }
+// 已解码的色图缓存("命名空间:名称" -> RGB 像素),首次使用时从 GlobalCache::colormaps 解码
+static std::unordered_map<std::string, DecodedColormap> decodedColormaps;
+static std::mutex decodedColormapsMutex;
+
+const DecodedColormap* Biome::GetColormap(const std::string& namespaceName, const std::string& colormapName) {
+    const std::string key = namespaceName + ":" + colormapName;
+    std::lock_guard<std::mutex> decodedLock(decodedColormapsMutex);
+    auto decodedIt = decodedColormaps.find(key);
+    if (decodedIt != decodedColormaps.end()) {
+        return decodedIt->second.pixels.empty() ? nullptr : &decodedIt->second;
+    }
+
+    DecodedColormap& decoded = decodedColormaps[key]; // 失败时缓存空条目,避免重复查找
+
+    // 覆盖关系已在初始化时解析,直接取生效版本
+    if (auto it = GlobalCache::FindResolved(GlobalCache::resolvedColormaps, namespaceName, colormapName)) {
+        const std::string& cacheKey = it->first;
+        int width, height, channels;
+        unsigned char* data = stbi_load_from_memory(it->second.data(), static_cast<int>(it->second.size()),
+            &width, &height, &channels, 3);
+        if (!data) {
+            std::cerr << "Failed to decode colormap: " << cacheKey
+                << ", error: " << stbi_failure_reason() << std::endl;
+            return nullptr;
+        }
+        // 验证尺寸
+        if (width != 256 || height != 256) {
+            std::cerr << "Invalid colormap size: " << cacheKey
+                << " (expected 256x256, got "
+                << width << "x" << height << ")" << std::endl;
+            stbi_image_free(data);
+            return nullptr;
         }
+        decoded.pixels.assign(data, data + static_cast<size_t>(width) * height * 3);
+        stbi_image_free(data);
+        return &decoded;
     }
 
-    std::cerr << "Colormap not found: " << namespaceName << ":" << colormapName << std::endl;
-    return "";
+    std::cerr << "Colormap not found: " << key << std::endl;
+    return nullptr;
 }
 
 BiomeColors Biome::ParseBiomeColors(const nlohmann::json& biomeJson) {
@@ -204,7 +175,7 @@ BiomeColors Biome::ParseBiomeColors(const nlohmann::json& biomeJson) {
             int directColor = biomeJson["effects"].value(key, -1);
             if (directColor != -1) return directColor;
 
-            auto colormap = GetColormapData("minecraft", colormapType);
+            const DecodedColormap* colormap = GetColormap("minecraft", colormapType);
             return CalculateColorFromColormap(colormap,colors.adjTemperature * tempMod,colors.adjDownfall * downfallMod);
         };
 
@@ -244,8 +215,8 @@ BiomeColors Biome::ParseBiomeColors(const nlohmann::json& biomeJson) {
             colors.dryFoliage = directDryFoliageColor;
         } else {
             // 尝试使用dry_foliage.png文件
-            auto dryFoliageColormap = GetColormapData("minecraft", "dry_foliage");
-            if (!dryFoliageColormap.empty()) {
+            const DecodedColormap* dryFoliageColormap = GetColormap("minecraft", "dry_foliage");
+            if (dryFoliageColormap) {
                 // 如果找到dry_foliage.png,使用它来计算颜色
                 colors.dryFoliage = CalculateColorFromColormap(dryFoliageColormap,
                     colors.adjTemperature,
@@ -263,68 +234,228 @@ BiomeColors Biome::ParseBiomeColors(const nlohmann::json& biomeJson) {
 }
 
 int Biome::GetId(const std::string& fullName) {
-    std::unique_lock<std::shared_mutex> lock(registryMutex);
+    // 线程本地缓存:命中时完全无锁
+    thread_local std::unordered_map<std::string, int> localIds;
+    auto localIt = localIds.find(fullName);
+    if (localIt != localIds.end()) {
+        return localIt->second;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(registryMutex);
+        auto it = biomeRegistry.find(fullName);
+        // 已存在直接返回
+        if (it != biomeRegistry.end()) {
+            localIds.emplace(fullName, it->second);
+            return it->second;
+        }
+    }
 
     // 验证命名格式
     const size_t colonPos = fullName.find(':');
     if (colonPos == std::string::npos) {
         throw std::invalid_argument("Invalid biome format: " + fullName);
     }
+
+    // 在注册锁外解析颜色数据(色图已在内存中解码),已注册群系的查询不会被阻塞
+    const auto& biomeJson = GetBiomeJson(fullName.substr(0, colonPos), fullName.substr(colonPos + 1));
+    BiomeColors colors = ParseBiomeColors(biomeJson);
+
+    std::unique_lock<std::shared_mutex> lock(registryMutex);
     auto it = biomeRegistry.find(fullName);
-    // 已存在直接返回
     if (it != biomeRegistry.end()) {
-        return it->second.id;
+        // 其他线程已先完成注册
+        localIds.emplace(fullName, it->second);
+        return it->second;
     }
 
-    // 获取生物群系配置数据
-    const auto& biomeJson = GetBiomeJson(fullName.substr(0, colonPos), fullName.substr(colonPos + 1));
+    // 溢出的群系也记入注册表(映射到 0),因此新ID取自已分配的数量而不是注册表大小
+    int id = biomeCount.load(std::memory_order_relaxed);
+    if (id >= static_cast<int>(kMaxBiomeCount)) {
+        std::cerr << "Error: biome table is full, " << fullName << " mapped to id 0" << std::endl;
+        biomeRegistry.emplace(fullName, 0);
+        localIds.emplace(fullName, 0);
+        return 0;
+    }
 
-    // 提前解析颜色数据
-    BiomeColors colors = ParseBiomeColors(biomeJson);
+    // 追加到按ID索引的表中,发布后不再修改
+    auto* newBiome = new BiomeInfo(id, std::move(colors));
+    newBiome->namespaceName = fullName.substr(0, colonPos);
+    newBiome->biomeName = fullName.substr(colonPos + 1);
+    biomeTable[id].store(newBiome, std::memory_order_release);
+    biomeCount.store(id + 1, std::memory_order_release);
+    biomeRegistry.emplace(fullName, id);
 
-    // 原子化注册操作
-    auto& newBiome = biomeRegistry.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(fullName),
-        std::forward_as_tuple(
-            static_cast<int>(biomeRegistry.size()),
-            std::move(colors)
-        )
-    ).first->second;
-
-    // 设置基础信息
-    newBiome.namespaceName = fullName.substr(0, colonPos);
-    newBiome.biomeName = fullName.substr(colonPos + 1);
-
-    return newBiome.id;
+    localIds.emplace(fullName, id);
+    return id;
 }
 
-int Biome::GetColor(int biomeId, BiomeColorType colorType) {
-    // 共享读锁
-    std::shared_lock<std::shared_mutex> lock(registryMutex);
+const BiomeInfo* Biome::GetInfo(int biomeId) {
+    if (biomeId < 0 || biomeId >= static_cast<int>(kMaxBiomeCount)) return nullptr;
+    return biomeTable[biomeId].load(std::memory_order_acquire);
+}
 
-    auto it = std::find_if(biomeRegistry.begin(), biomeRegistry.end(),
-        [biomeId](const auto& entry) { return entry.second.id == biomeId; });
+int Biome::GetCount() {
+    return biomeCount.load(std::memory_order_acquire);
+}
 
-    if (it == biomeRegistry.end()) return 0xFFFFFF;
+int Biome::GetColor(int biomeId, BiomeColorType colorType) {
+    const BiomeInfo* info = GetInfo(biomeId);
+    if (!info) return 0xFFFFFF;
 
-    // 获取独立颜色锁
-    std::lock_guard<std::mutex> colorLock(it->second.colorMutex);
     switch (colorType) {
-    case BiomeColorType::Foliage: return it->second.colors.foliage;
-    case BiomeColorType::DryFoliage: return it->second.colors.dryFoliage;
-    case BiomeColorType::Grass: return it->second.colors.grass;
-    case BiomeColorType::Fog:    return it->second.colors.fog;
-    case BiomeColorType::Sky:    return it->second.colors.sky;
-    case BiomeColorType::Water:  return it->second.colors.water;
-    case BiomeColorType::WaterFog: return it->second.colors.waterFog;
+    case BiomeColorType::Foliage: return info->colors.foliage;
+    case BiomeColorType::DryFoliage: return info->colors.dryFoliage;
+    case BiomeColorType::Grass: return info->colors.grass;
+    case BiomeColorType::Fog:    return info->colors.fog;
+    case BiomeColorType::Sky:    return info->colors.sky;
+    case BiomeColorType::Water:  return info->colors.water;
+    case BiomeColorType::WaterFog: return info->colors.waterFog;
     default: return 0xFFFFFF; // 白色作为默认错误颜色
     }
 }
 
+//============== 批次群系颜色网格 ==============//
+// 生物群系过渡距离(与逐方块采样保持一致)
+static constexpr int kBiomeBlurRadius = 4;
+// 网格中预计算的颜色类型(着色相关)
+static constexpr BiomeColorType kGridColorTypes[] = {
+    BiomeColorType::Foliage, BiomeColorType::DryFoliage, BiomeColorType::Grass, BiomeColorType::Water
+};
+static constexpr size_t kGridColorTypeCount = sizeof(kGridColorTypes) / sizeof(kGridColorTypes[0]);
+
+struct BiomeColorGrid {
+    int minX = 0, minZ = 0;
+    int width = 0, depth = 0;
+    std::array<std::vector<uint32_t>, kGridColorTypeCount> colors; // [类型][z * width + x] = 0xRRGGBB
+};
+static BiomeColorGrid g_biomeColorGrid;
+
+static int GridColorTypeIndex(BiomeColorType colorType) {
+    for (size_t i = 0; i < kGridColorTypeCount; ++i) {
+        if (kGridColorTypes[i] == colorType) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void Biome::BuildBiomeColorGrid(int minX, int minZ, int maxX, int maxZ) {
+    const int width = maxX - minX + 1;
+    const int depth = maxZ - minZ + 1;
+    if (width <= 0 || depth <= 0) return;
+
+    // 群系ID -> 各类型颜色
+    std::vector<std::array<int, kGridColorTypeCount>> colorsById(GetCount() + 1);
+    for (size_t id = 0; id < colorsById.size(); ++id) {
+        for (size_t t = 0; t < kGridColorTypeCount; ++t) {
+            colorsById[id][t] = GetColor(static_cast<int>(id), kGridColorTypes[t]);
+        }
+    }
+
+    // 每列的地表群系ID(取 MOTION_BLOCKING 高度处)
+    std::vector<int> columnBiome(static_cast<size_t>(width) * depth, 0);
+    {
+        std::shared_lock<std::shared_mutex> sectionLock(sectionCacheMutex);
+        std::shared_lock<std::shared_mutex> heightLock(heightMapCacheMutex);
+        int chunkXStart, chunkZStart, chunkXEnd, chunkZEnd;
+        blockToChunk(minX, minZ, chunkXStart, chunkZStart);
+        blockToChunk(maxX, maxZ, chunkXEnd, chunkZEnd);
+        for (int cx = chunkXStart; cx <= chunkXEnd; ++cx) {
+            for (int cz = chunkZStart; cz <= chunkZEnd; ++cz) {
+                const std::vector<int>* heights = nullptr;
+                auto hmIt = heightMapCache.find(std::make_pair(cx, cz));
+                if (hmIt != heightMapCache.end()) {
+                    auto typeIt = hmIt->second.find("MOTION_BLOCKING");
+                    if (typeIt != hmIt->second.end() && typeIt->second.size() >= 256) heights = &typeIt->second;
+                }
+                for (int lz = 0; lz < 16; ++lz) {
+                    int z = cz * 16 + lz;
+                    if (z < minZ || z > maxZ) continue;
+                    for (int lx = 0; lx < 16; ++lx) {
+                        int x = cx * 16 + lx;
+                        if (x < minX || x > maxX) continue;
+                        int y = minSectionY * 16 + (heights ? std::max((*heights)[lx + lz * 16] - 1, 0) : 0);
+                        int sectionY;
+                        blockYToSectionY(y, sectionY);
+                        auto secIt = sectionCache.find(std::make_tuple(cx, cz, AdjustSectionY(sectionY)));
+                        if (secIt == sectionCache.end()) continue;
+                        const auto& biomeData = secIt->second.biomeData;
+                        int index = 16 * (mod16(y) / 4) + 4 * (lz / 4) + (lx / 4);
+                        if (index < static_cast<int>(biomeData.size())) {
+                            columnBiome[static_cast<size_t>(z - minZ) * width + (x - minX)] = biomeData[index];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 可分离盒式模糊:先沿X求窗口和,再沿Z求窗口和,边界处按实际覆盖的列数求平均
+    const size_t cellCount = static_cast<size_t>(width) * depth;
+    std::vector<uint32_t> rowSum(cellCount * 3);
+    BiomeColorGrid grid;
+    grid.minX = minX;
+    grid.minZ = minZ;
+    grid.width = width;
+    grid.depth = depth;
+    for (size_t t = 0; t < kGridColorTypeCount; ++t) {
+        auto channel = [&](size_t cell, int shift) -> uint32_t {
+            int id = columnBiome[cell];
+            int color = (id >= 0 && id < static_cast<int>(colorsById.size())) ? colorsById[id][t] : 0xFFFFFF;
+            return (static_cast<uint32_t>(color) >> shift) & 0xFF;
+        };
+        for (int z = 0; z < depth; ++z) {
+            size_t row = static_cast<size_t>(z) * width;
+            for (int c = 0; c < 3; ++c) {
+                int shift = 16 - c * 8;
+                uint32_t sum = 0;
+                for (int x = 0; x < std::min(kBiomeBlurRadius, width); ++x) sum += channel(row + x, shift);
+                for (int x = 0; x < width; ++x) {
+                    if (x + kBiomeBlurRadius < width) sum += channel(row + x + kBiomeBlurRadius, shift);
+                    if (x - kBiomeBlurRadius - 1 >= 0) sum -= channel(row + x - kBiomeBlurRadius - 1, shift);
+                    rowSum[(row + x) * 3 + c] = sum;
+                }
+            }
+        }
+        std::vector<uint32_t>& out = grid.colors[t];
+        out.assign(cellCount, 0);
+        for (int x = 0; x < width; ++x) {
+            int countX = std::min(x + kBiomeBlurRadius, width - 1) - std::max(x - kBiomeBlurRadius, 0) + 1;
+            uint32_t sum[3] = { 0, 0, 0 };
+            for (int z = 0; z < std::min(kBiomeBlurRadius, depth); ++z) {
+                for (int c = 0; c < 3; ++c) sum[c] += rowSum[(static_cast<size_t>(z) * width + x) * 3 + c];
+            }
+            for (int z = 0; z < depth; ++z) {
+                for (int c = 0; c < 3; ++c) {
+                    if (z + kBiomeBlurRadius < depth) sum[c] += rowSum[(static_cast<size_t>(z + kBiomeBlurRadius) * width + x) * 3 + c];
+                    if (z - kBiomeBlurRadius - 1 >= 0) sum[c] -= rowSum[(static_cast<size_t>(z - kBiomeBlurRadius - 1) * width + x) * 3 + c];
+                }
+                int countZ = std::min(z + kBiomeBlurRadius, depth - 1) - std::max(z - kBiomeBlurRadius, 0) + 1;
+                uint32_t count = static_cast<uint32_t>(countX * countZ);
+                out[static_cast<size_t>(z) * width + x] = ((sum[0] / count) << 16) | ((sum[1] / count) << 8) | (sum[2] / count);
+            }
+        }
+    }
+    g_biomeColorGrid = std::move(grid);
+}
+
+void Biome::ClearBiomeColorGrid() {
+    g_biomeColorGrid = BiomeColorGrid();
+}
+
 int Biome::GetBiomeColor(int blockX, int blockY, int blockZ, BiomeColorType colorType) {
+    // 网格内的列直接查表
+    const BiomeColorGrid& grid = g_biomeColorGrid;
+    int gx = blockX - grid.minX;
+    int gz = blockZ - grid.minZ;
+    if (gx >= 0 && gx < grid.width && gz >= 0 && gz < grid.depth) {
+        int typeIndex = GridColorTypeIndex(colorType);
+        if (typeIndex >= 0) {
+            return static_cast<int>(grid.colors[typeIndex][static_cast<size_t>(gz) * grid.width + gx]);
+        }
+    }
+
     // 生物群系过渡距离,默认值为4,可根据需要调整
-    const int biomeTransitionDistance = 4;
+    const int biomeTransitionDistance = kBiomeBlurRadius;
     int count = 0;
     unsigned int rSum = 0, gSum = 0, bSum = 0;
 
@@ -347,7 +478,7 @@ int Biome::GetBiomeColor(int blockX, int blockY, int blockZ, BiomeColorType colo
 
             // 检查 SectionCache 中是否存在对应的区块数据,否则加载
             if (sectionCache.find(blockKey) == sectionCache.end()) {
-                LoadAndCacheBlockData(chunkX, chunkZ);
+                LoadAndCacheBlockData(chunkX, chunkZ, LODManager::IsHeightfieldChunk(chunkX, chunkZ));
             }
 
             const auto& biomeData = sectionCache[blockKey].biomeData;
@@ -361,43 +492,8 @@ int Biome::GetBiomeColor(int blockX, int blockY, int blockZ, BiomeColorType colo
             // 获取生物群系ID(若超出范围,则默认为0)
             int biomeId = (index < biomeData.size()) ? biomeData[index] : 0;
 
-            // 共享读锁确保 biomeRegistry 的线程安全
-            std::shared_lock<std::shared_mutex> lock(registryMutex);
-            auto it = std::find_if(biomeRegistry.begin(), biomeRegistry.end(),
-                [biomeId](const auto& entry) { return entry.second.id == biomeId; });
-
-            // 默认颜色设置为白色
-            int color = 0xFFFFFF;
-            if (it != biomeRegistry.end()) {
-                // 获取独立颜色锁,确保颜色数据读取安全
-                std::lock_guard<std::mutex> colorLock(it->second.colorMutex);
-                switch (colorType) {
-                case BiomeColorType::Foliage:
-                    color = it->second.colors.foliage;
-                    break;
-                case BiomeColorType::DryFoliage:
-                    color = it->second.colors.dryFoliage;
-                    break;
-                case BiomeColorType::Grass:
-                    color = it->second.colors.grass;
-                    break;
-                case BiomeColorType::Fog:
-                    color = it->second.colors.fog;
-                    break;
-                case BiomeColorType::Sky:
-                    color = it->second.colors.sky;
-                    break;
-                case BiomeColorType::Water:
-                    color = it->second.colors.water;
-                    break;
-                case BiomeColorType::WaterFog:
-                    color = it->second.colors.waterFog;
-                    break;
-                default:
-                    color = 0xFFFFFF;
-                    break;
-                }
-            }
+            // 无锁读取群系颜色(不存在时为白色)
+            int color = GetColor(biomeId, colorType);
 
             // 将颜色分解为RGB分量并累加
             int r = (color >> 16) & 0xFF;
@@ -419,43 +515,11 @@ int Biome::GetBiomeColor(int blockX, int blockY, int blockZ, BiomeColorType colo
     return finalColor;
 }
 
-int Biome::CalculateColorFromColormap(const std::string& filePath,float adjTemperature,float adjDownfall) {
-    if (filePath.empty()) {
+int Biome::CalculateColorFromColormap(const DecodedColormap* colormap, float adjTemperature, float adjDownfall) {
+    if (!colormap || colormap->pixels.empty()) {
         return 0x00FF00; // 错误颜色
     }
 
-    // 加载图片数据
-    int width, height, channels;
-    unsigned char* data = stbi_load(filePath.c_str(),
-        &width,
-        &height,
-        &channels,
-        0); // 0表示保留原始通道数
-
-    if (!data) {
-        std::cerr << "Failed to load colormap: " << filePath
-            << ", error: " << stbi_failure_reason() << std::endl;
-        return 0x00FF00;
-    }
-
-    // 验证尺寸
-    if (width != 256 || height != 256) {
-        std::cerr << "Invalid colormap size: " << filePath
-            << " (expected 256x256, got "
-            << width << "x" << height << ")" << std::endl;
-        stbi_image_free(data);
-        return 0x00FF00;
-    }
-
-    // 确保有足够的颜色通道
-    const bool hasColorChannels = (channels >= 3);
-    if (!hasColorChannels) {
-        std::cerr << "Unsupported channel format: " << filePath
-            << " (channels: " << channels << ")" << std::endl;
-        stbi_image_free(data);
-        return 0x00FF00;
-    }
-
     // 温度和降水值钳位到0.0~1.0范围
     adjTemperature = BiomeUtils::clamp(adjTemperature, 0.0f, 1.0f);
     adjDownfall = BiomeUtils::clamp(adjDownfall, 0.0f, 1.0f);
@@ -484,109 +548,216 @@ int Biome::CalculateColorFromColormap(const std::string& filePath,float adjTempe
     // y:直接使用降水映射(已经是从上往下的递增)
     int y = downfallCoord;
 
-    // 计算像素偏移 - 使用图片坐标系
-    const size_t pixelOffset = (y * width + x) * channels;
-
-    // 根据图片通道数提取颜色
-    uint8_t r = data[pixelOffset];
-    uint8_t g = data[pixelOffset + (channels >= 2 ? 1 : 0)]; // 单通道时复用R
-    uint8_t b = data[pixelOffset + (channels >= 3 ? 2 : 0)]; // 双通道时复用R
-
-    stbi_image_free(data);
+    // 从已解码的 256x256 RGB 数据中取色
+    const size_t pixelOffset = (static_cast<size_t>(y) * 256 + x) * 3;
+    uint8_t r = colormap->pixels[pixelOffset];
+    uint8_t g = colormap->pixels[pixelOffset + 1];
+    uint8_t b = colormap->pixels[pixelOffset + 2];
 
     return (r << 16) | (g << 8) | b;
 }
 
-// 添加全局地图的最小X和最小Z坐标，用于计算偏移量
-int g_biomeMapMinX = 0;
-int g_biomeMapMinZ = 0;
+// ========== 分块群系地图 ==========
+// 群系在存档中以 4x4x4 为单位存储,地图按 4x4 群系单元保存群系ID,
+// 单元再分组为 64x64 的瓦片按需分配,内存只与实际生成的区块数量成正比
+namespace {
+    constexpr int kBiomeCellSize = 4;          // 群系单元边长(方块)
+    constexpr int kBiomeTileCells = 64;        // 瓦片边长(单元)
+    constexpr uint16_t kNoBiome = 0xFFFF;      // 未生成的单元
+
+    struct BiomeMapTiles {
+        int minX = 0, minZ = 0, maxX = -1, maxZ = -1;  // 导出范围(方块坐标,闭区间)
+        std::unordered_map<long long, std::vector<uint16_t>> tiles;
+        std::mutex mutex;
+    };
+    BiomeMapTiles g_biomeMap;
+
+    inline int FloorDiv(int a, int b) {
+        return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+    }
 
-// 初始化生物群系地图尺寸和偏移量
-void Biome::InitializeBiomeMap(int minX, int minZ, int maxX, int maxZ) {
-    int width = maxX - minX + 1;
-    int height = maxZ - minZ + 1;
-    g_biomeMap.resize(height, std::vector<int>(width));
-    g_biomeMapMinX = minX;
-    g_biomeMapMinZ = minZ;
-}
+    inline long long TileKey(int tileX, int tileZ) {
+        return (static_cast<long long>(tileX) << 32) | static_cast<uint32_t>(tileZ);
+    }
 
-void Biome::GenerateBiomeMap(int minX, int minZ, int maxX, int maxZ) {
-    // 确保全局地图已初始化
-    if (g_biomeMap.empty() || g_biomeMap[0].empty()) {
-        std::cerr << "Error: g_biomeMap not initialized in GenerateBiomeMap!\n";
-        return;
-    }
-
-    int globalMinX = g_biomeMapMinX;
-    int globalMinZ = g_biomeMapMinZ;
-    size_t mapWidth = g_biomeMap[0].size();
-    size_t mapHeight = g_biomeMap.size();
-
-    for (int x = minX; x <= maxX; ++x) {
-        for (int z = minZ; z <= maxZ; ++z) {
-            // 检查当前方块坐标是否在全局生物群系地图范围内
-            int mapX = x - globalMinX;
-            int mapZ = z - globalMinZ;
-
-            if (mapX >= 0 && mapX < mapWidth && mapZ >= 0 && mapZ < mapHeight) {
-                int currentY = GetHeightMapY(x, z, "MOTION_BLOCKING");
-                int biomeId = GetBiomeId(x, currentY, z);
-                // 将生物群系ID写入全局地图的对应位置
-                g_biomeMap[mapZ][mapX] = biomeId;
-            }
+    // 流式PNG写入器:逐行压缩并分段写出IDAT,内存占用与图片高度无关
+    class StreamingPngWriter {
+    public:
+        ~StreamingPngWriter() {
+            if (deflateReady) deflateEnd(&stream);
         }
-    }
-}
 
-bool Biome::ExportToPNG(const std::string& filename, BiomeColorType colorType)
-{
-    // 生成颜色映射
-    std::map<int, std::tuple<uint8_t, uint8_t, uint8_t>> colorMap;
+        bool Open(const std::string& filePath, int width, int height) {
+            file.open(filePath, std::ios::binary);
+            if (!file) return false;
+
+            static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+            file.write(reinterpret_cast<const char*>(signature), 8);
+
+            unsigned char ihdr[13];
+            WriteBE32(ihdr, static_cast<uint32_t>(width));
+            WriteBE32(ihdr + 4, static_cast<uint32_t>(height));
+            ihdr[8] = 8;   // 位深
+            ihdr[9] = 2;   // RGB
+            ihdr[10] = 0;  // 压缩方式
+            ihdr[11] = 0;  // 滤波方式
+            ihdr[12] = 0;  // 无隔行
+            WriteChunk("IHDR", ihdr, sizeof(ihdr));
+
+            if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) return false;
+            deflateReady = true;
+            outBuffer.resize(1 << 16);
+            return static_cast<bool>(file);
+        }
 
-    for (const auto& entry : biomeRegistry) {
-        int colorValue = GetColor(entry.second.id, colorType);
-        uint8_t r = (colorValue >> 16) & 0xFF;
-        uint8_t g = (colorValue >> 8) & 0xFF;
-        uint8_t b = colorValue & 0xFF;
-        colorMap[entry.second.id] = std::make_tuple(r, g, b);
-    }
+        // 写入一行RGB数据(行首需预留1字节滤波类型)
+        bool WriteRow(std::vector<unsigned char>& row) {
+            row[0] = 0; // 不使用行滤波,群系图大面积同色,直接由deflate压缩
+            return Deflate(row.data(), row.size(), Z_NO_FLUSH);
+        }
 
-    if (g_biomeMap.empty()) return false;
+        bool Finish() {
+            if (!Deflate(nullptr, 0, Z_FINISH)) return false;
+            WriteChunk("IEND", nullptr, 0);
+            file.close();
+            return !file.fail();
+        }
 
-    const int height = g_biomeMap.size();
-    const int width = g_biomeMap[0].size();
+    private:
+        static void WriteBE32(unsigned char* dst, uint32_t v) {
+            dst[0] = static_cast<unsigned char>(v >> 24);
+            dst[1] = static_cast<unsigned char>(v >> 16);
+            dst[2] = static_cast<unsigned char>(v >> 8);
+            dst[3] = static_cast<unsigned char>(v);
+        }
 
-    // 尺寸校验
-    for (const auto& row : g_biomeMap) {
-        if (row.size() != static_cast<size_t>(width)) {
-            std::cerr << "Error: Invalid biome map dimensions" << std::endl;
-            return false;
+        void WriteChunk(const char* type, const unsigned char* data, size_t size) {
+            unsigned char header[8];
+            WriteBE32(header, static_cast<uint32_t>(size));
+            std::memcpy(header + 4, type, 4);
+            file.write(reinterpret_cast<const char*>(header), 8);
+            if (size > 0) file.write(reinterpret_cast<const char*>(data), size);
+
+            uLong crc = crc32(0L, Z_NULL, 0);
+            crc = crc32(crc, header + 4, 4);
+            if (size > 0) crc = crc32(crc, data, static_cast<uInt>(size));
+            unsigned char crcBytes[4];
+            WriteBE32(crcBytes, static_cast<uint32_t>(crc));
+            file.write(reinterpret_cast<const char*>(crcBytes), 4);
         }
-    }
 
-    std::vector<uint8_t> imageData(width * height * 3);
+        bool Deflate(const unsigned char* data, size_t size, int flush) {
+            stream.next_in = const_cast<Bytef*>(data);
+            stream.avail_in = static_cast<uInt>(size);
+            do {
+                stream.next_out = outBuffer.data();
+                stream.avail_out = static_cast<uInt>(outBuffer.size());
+                int ret = deflate(&stream, flush);
+                if (ret == Z_STREAM_ERROR) return false;
+                size_t produced = outBuffer.size() - stream.avail_out;
+                if (produced > 0) WriteChunk("IDAT", outBuffer.data(), produced);
+                if (flush == Z_FINISH && ret == Z_STREAM_END) break;
+            } while (stream.avail_out == 0 || stream.avail_in > 0 || flush == Z_FINISH);
+            return static_cast<bool>(file);
+        }
 
-    // 构建颜色映射(包含默认随机颜色生成)
-    std::map<int, std::tuple<uint8_t, uint8_t, uint8_t>> finalColorMap = colorMap;
+        std::ofstream file;
+        z_stream stream{};
+        bool deflateReady = false;
+        std::vector<unsigned char> outBuffer;
+    };
+}
 
-    // 解决方案:添加维度校验
-    for (const auto& row : g_biomeMap) {
-        if (row.size() != static_cast<size_t>(width)) {
-            std::cerr << "Error: Biome map is not rectangular\n";
-            return false;
+// 初始化生物群系地图范围(清空之前的瓦片)
+void Biome::InitializeBiomeMap(int minX, int minZ, int maxX, int maxZ) {
+    std::lock_guard<std::mutex> lock(g_biomeMap.mutex);
+    g_biomeMap.tiles.clear();
+    g_biomeMap.minX = minX;
+    g_biomeMap.minZ = minZ;
+    g_biomeMap.maxX = maxX;
+    g_biomeMap.maxZ = maxZ;
+}
+
+// 为方块范围内的群系单元采样群系ID(线程安全),每个单元取中心列的地表群系
+void Biome::GenerateBiomeMap(int minX, int minZ, int maxX, int maxZ) {
+    minX = std::max(minX, g_biomeMap.minX);
+    minZ = std::max(minZ, g_biomeMap.minZ);
+    maxX = std::min(maxX, g_biomeMap.maxX);
+    maxZ = std::min(maxZ, g_biomeMap.maxZ);
+    if (minX > maxX || minZ > maxZ) return;
+
+    const int cellMinX = FloorDiv(minX, kBiomeCellSize);
+    const int cellMinZ = FloorDiv(minZ, kBiomeCellSize);
+    const int cellMaxX = FloorDiv(maxX, kBiomeCellSize);
+    const int cellMaxZ = FloorDiv(maxZ, kBiomeCellSize);
+    const int cellsX = cellMaxX - cellMinX + 1;
+
+    // 先在地图锁外完成高度图与群系查询(只读缓存,不触发加载,可多线程并行)
+    std::vector<uint16_t> ids(static_cast<size_t>(cellsX) * (cellMaxZ - cellMinZ + 1), kNoBiome);
+    {
+        std::shared_lock<std::shared_mutex> sectionLock(sectionCacheMutex);
+        std::shared_lock<std::shared_mutex> heightLock(heightMapCacheMutex);
+        for (int cz = cellMinZ; cz <= cellMaxZ; ++cz) {
+            for (int cx = cellMinX; cx <= cellMaxX; ++cx) {
+                int x = cx * kBiomeCellSize + kBiomeCellSize / 2;
+                int z = cz * kBiomeCellSize + kBiomeCellSize / 2;
+                int chunkX, chunkZ;
+                blockToChunk(x, z, chunkX, chunkZ);
+                int lx = mod16(x), lz = mod16(z);
+
+                const std::vector<int>* heights = nullptr;
+                auto hmIt = heightMapCache.find(std::make_pair(chunkX, chunkZ));
+                if (hmIt != heightMapCache.end()) {
+                    auto typeIt = hmIt->second.find("MOTION_BLOCKING");
+                    if (typeIt != hmIt->second.end() && typeIt->second.size() >= 256) heights = &typeIt->second;
+                }
+                int y = minSectionY * 16 + (heights ? std::max((*heights)[lx + lz * 16] - 1, 0) : 0);
+                int sectionY;
+                blockYToSectionY(y, sectionY);
+                auto secIt = sectionCache.find(std::make_tuple(chunkX, chunkZ, AdjustSectionY(sectionY)));
+                if (secIt == sectionCache.end()) continue;
+                const auto& biomeData = secIt->second.biomeData;
+                int index = 16 * (mod16(y) / 4) + 4 * (lz / 4) + (lx / 4);
+                if (index < static_cast<int>(biomeData.size()) && biomeData[index] >= 0 && biomeData[index] < kNoBiome) {
+                    ids[static_cast<size_t>(cz - cellMinZ) * cellsX + (cx - cellMinX)] = static_cast<uint16_t>(biomeData[index]);
+                }
+            }
         }
     }
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            int biomeId = g_biomeMap[y][x];
 
-            auto& color = finalColorMap[biomeId];
-            int index = (y * width + x) * 3;
-            imageData[index] = std::get<0>(color);  // R
-            imageData[index + 1] = std::get<1>(color);  // G
-            imageData[index + 2] = std::get<2>(color);  // B
+    std::lock_guard<std::mutex> lock(g_biomeMap.mutex);
+    for (int cz = cellMinZ; cz <= cellMaxZ; ++cz) {
+        for (int cx = cellMinX; cx <= cellMaxX; ++cx) {
+            int tileX = FloorDiv(cx, kBiomeTileCells);
+            int tileZ = FloorDiv(cz, kBiomeTileCells);
+            auto& tile = g_biomeMap.tiles[TileKey(tileX, tileZ)];
+            if (tile.empty()) {
+                tile.assign(static_cast<size_t>(kBiomeTileCells) * kBiomeTileCells, kNoBiome);
+            }
+            int localX = cx - tileX * kBiomeTileCells;
+            int localZ = cz - tileZ * kBiomeTileCells;
+            tile[static_cast<size_t>(localZ) * kBiomeTileCells + localX] =
+                ids[static_cast<size_t>(cz - cellMinZ) * cellsX + (cx - cellMinX)];
         }
     }
+}
+
+bool Biome::ExportToPNG(const std::string& filename, BiomeColorType colorType)
+{
+    const int width = g_biomeMap.maxX - g_biomeMap.minX + 1;
+    const int height = g_biomeMap.maxZ - g_biomeMap.minZ + 1;
+    if (width <= 0 || height <= 0 || g_biomeMap.tiles.empty()) return false;
+
+    // 群系ID -> 颜色查找表,未生成的单元输出黑色
+    const int biomeCount = GetCount();
+    std::vector<uint32_t> palette(static_cast<size_t>(biomeCount) + 1, 0);
+    for (int id = 0; id < biomeCount; ++id) {
+        palette[id] = static_cast<uint32_t>(GetColor(id, colorType)) & 0xFFFFFF;
+    }
+    auto lookupColor = [&](uint16_t id) -> uint32_t {
+        return (id < biomeCount) ? palette[id] : 0;
+    };
+
     std::string exePath = getExecutableDir();
     size_t pos = exePath.find_last_of("\\/");
     std::string exeDir = exePath.substr(0, pos);
@@ -596,15 +767,81 @@ bool Biome::ExportToPNG(const std::string& filename, BiomeColorType colorType)
     // 创建完整的文件夹路径
     std::string folderPath = exeDir + "\\" + exportFolderName;
 
-    // 创建文件夹(如果不存在)
+    // 创建文件夹(如果不存在),多张图并行导出时可能同时创建
+    std::error_code ec;
+    std::filesystem::create_directories(folderPath, ec);
     if (!std::filesystem::exists(folderPath)) {
-        if (!std::filesystem::create_directory(folderPath)) {
-            std::cerr << "Error: Failed to create directory " << folderPath << std::endl;
+        std::cerr << "Error: Failed to create directory " << folderPath << std::endl;
+        return false;
+    }
+
+    // 创建完整的文件路径
+    std::string filePath = folderPath + "\\" + filename;
+    StreamingPngWriter writer;
+    if (!writer.Open(filePath, width, height)) {
+        std::cerr << "Error: Failed to open " << filePath << std::endl;
+        return false;
+    }
+
+    // 逐行展开:同一单元行内的4行方块颜色相同,只在进入新单元行时重新查瓦片
+    std::vector<unsigned char> row(1 + static_cast<size_t>(width) * 3);
+    int builtCellZ = INT_MIN;
+    for (int y = 0; y < height; ++y) {
+        int blockZ = g_biomeMap.minZ + y;
+        int cellZ = FloorDiv(blockZ, kBiomeCellSize);
+        if (cellZ != builtCellZ) {
+            builtCellZ = cellZ;
+            int tileZ = FloorDiv(cellZ, kBiomeTileCells);
+            int localZ = cellZ - tileZ * kBiomeTileCells;
+
+            const std::vector<uint16_t>* tile = nullptr;
+            int currentTileX = INT_MIN;
+            for (int x = 0; x < width; ++x) {
+                int cellX = FloorDiv(g_biomeMap.minX + x, kBiomeCellSize);
+                int tileX = FloorDiv(cellX, kBiomeTileCells);
+                if (tileX != currentTileX) {
+                    currentTileX = tileX;
+                    auto it = g_biomeMap.tiles.find(TileKey(tileX, tileZ));
+                    tile = (it != g_biomeMap.tiles.end()) ? &it->second : nullptr;
+                }
+                uint16_t id = tile ? (*tile)[static_cast<size_t>(localZ) * kBiomeTileCells + (cellX - tileX * kBiomeTileCells)] : kNoBiome;
+                uint32_t color = lookupColor(id);
+                unsigned char* px = &row[1 + static_cast<size_t>(x) * 3];
+                px[0] = static_cast<unsigned char>((color >> 16) & 0xFF); // R
+                px[1] = static_cast<unsigned char>((color >> 8) & 0xFF);  // G
+                px[2] = static_cast<unsigned char>(color & 0xFF);         // B
+            }
+        }
+        if (!writer.WriteRow(row)) {
+            std::cerr << "Error: Failed to write " << filePath << std::endl;
             return false;
         }
     }
+    return writer.Finish();
+}
 
-    // 创建完整的文件路径
-    std::string filePath = folderPath + "\\" + filename;    // 写入PNG文件
-    return stbi_write_png(filePath.c_str(), width, height, 3, imageData.data(), width * 3);
+// 并行导出全部群系颜色图(地图生成结束后瓦片只读,各图独立编码)
+void Biome::ExportAllToPNG() {
+    const std::vector<std::pair<std::string, BiomeColorType>> exports = {
+        { "foliage.png", BiomeColorType::Foliage },
+        { "dry_foliage.png", BiomeColorType::DryFoliage },
+        { "water.png", BiomeColorType::Water },
+        { "grass.png", BiomeColorType::Grass },
+        { "waterFog.png", BiomeColorType::WaterFog },
+        { "fog.png", BiomeColorType::Fog },
+        { "sky.png", BiomeColorType::Sky }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(exports.size());
+    for (const auto& entry : exports) {
+        workers.emplace_back([&entry]() {
+            if (!ExportToPNG(entry.first, entry.second)) {
+                std::cerr << "Error: Failed to export biome map " << entry.first << std::endl;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
 }
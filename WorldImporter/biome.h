@@ -2,6 +2,7 @@
 #include <string>
 #include <unordered_map>
 #include <map>
+#include <vector>
 #include <mutex>
 #include <shared_mutex>
 #include "include/json.hpp"
@@ -31,6 +32,11 @@ struct BiomeColors {
     float adjDownfall = 0.0f;
 };
 
+// 已解码的色图(256x256,RGB)
+struct DecodedColormap {
+    std::vector<unsigned char> pixels;
+};
+
 namespace BiomeUtils {
     template<typename T>
     constexpr const T& clamp(const T& v, const T& lo, const T& hi) {
@@ -38,6 +44,7 @@ namespace BiomeUtils {
     }
 }
 
+// 群系信息:注册后不再修改,可无锁读取
 struct BiomeInfo {
     explicit BiomeInfo(int id, BiomeColors&& initialColors)
         : id(id), colors(std::move(initialColors)) {
@@ -47,17 +54,11 @@ struct BiomeInfo {
     std::string namespaceName;
     std::string biomeName;
     BiomeColors colors;
-    mutable std::mutex colorMutex;
 };
 
-    // 全局生物群系地图数据
-    static std::vector<std::vector<int>> g_biomeMap;
-    extern int g_biomeMapMinX;
-    extern int g_biomeMapMinZ;
-
 class Biome {
 public:
-    // 初始化生物群系地图尺寸
+    // 初始化生物群系地图范围(地图按 4x4 群系单元分瓦片存储)
     static void InitializeBiomeMap(int minX, int minZ, int maxX, int maxZ);
 public:
     // 获取或注册群系ID(线程安全)
@@ -65,22 +66,40 @@ public:
 
     static int GetColor(int biomeId, BiomeColorType colorType);
 
+    // 按ID获取群系信息(无锁),不存在时返回 nullptr
+    static const BiomeInfo* GetInfo(int biomeId);
+
+    // 已注册的群系数量
+    static int GetCount();
+
     static int GetBiomeColor(int blockX, int blockY, int blockZ, BiomeColorType colorType);
 
+    // 批次颜色网格:在区块加载后按列(地表群系)解析颜色并做 9x9 可分离盒式模糊,
+    // 模型生成期间 GetBiomeColor 对网格内的列直接查表(网格在生成期间只读)
+    static void BuildBiomeColorGrid(int minX, int minZ, int maxX, int maxZ);
+    static void ClearBiomeColorGrid();
+
+    // 为方块范围采样群系单元(线程安全)
     static void GenerateBiomeMap(int minX, int minZ, int maxX, int maxZ);
 
+    // 逐行流式编码导出单张群系颜色图
     static bool ExportToPNG(const std::string& filename, BiomeColorType colorType);
 
+    // 并行导出全部群系颜色图
+    static void ExportAllToPNG();
+
     static nlohmann::json GetBiomeJson(const std::string& namespaceName, const std::string& biomeId);
 
-    static std::string GetColormapData(const std::string& namespaceName, const std::string& colormapName);
+    // 获取内存中已解码的色图,首次调用时从资源缓存解码,未找到时返回 nullptr
+    static const DecodedColormap* GetColormap(const std::string& namespaceName, const std::string& colormapName);
 
 
 
 private:
-    static std::unordered_map<std::string, BiomeInfo> biomeRegistry;
+    // 名称 -> ID 的字符串驻留表(仅注册时加写锁,线程本地缓存在前)
+    static std::unordered_map<std::string, int> biomeRegistry;
     static std::shared_mutex registryMutex; // 改用读写锁
-    static int CalculateColorFromColormap(const std::string& filePath,float temperature,float downfall);
+    static int CalculateColorFromColormap(const DecodedColormap* colormap,float temperature,float downfall);
     static BiomeColors ParseBiomeColors(const nlohmann::json& biomeJson);
 
 
@@ -1,6 +1,8 @@
 ﻿// --- C++ 标准库头文件 ---
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <climits>
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -27,6 +29,7 @@
 #include "decompressor.h"
 #include "locutil.h"
 #include "hashutils.h"
+#include "LODManager.h"
 
 using namespace std;
 
@@ -51,6 +54,13 @@ std::unordered_map<std::pair<int, int>, std::unordered_map<std::string, std::vec
 
 std::vector<Block> globalBlockPalette;
 
+// 仅加载地表的区块(由 sectionCacheMutex 保护):区块 -> 已加载的最低子区块键(AdjustSectionY 之后),
+// 低于该键的子区块位于地表之下,相邻区块剔除面时视为实心
+static std::unordered_map<std::pair<int, int>, int, pair_hash> surfaceOnlyChunks;
+// 地表之下未加载子区块的填充方块ID(首次仅加载地表时注册)
+static std::atomic<int> surfaceFillBlockId{ 0 };
+static const char* kSurfaceFillBlockName = "minecraft:stone";
+
 
 // 添加静态邻居偏移数组,避免重复构造
 static const std::array<std::tuple<int, int, int>, 6> kSectionNeighborOffsets = { {
@@ -106,17 +116,8 @@ void UpdateSkyLightNeighborFlags() {
 // --------------------------------------------------------------------------------
 // 方块相关核心函数
 // --------------------------------------------------------------------------------
-// 新增函数:处理单个子区块
-void ProcessSection(int chunkX, int chunkZ, int sectionY, const NbtTagPtr& sectionTag) {
-    // 获取方块数据
-    auto blo = getBlockStates(sectionTag);
-    std::vector<std::string> blockPalette = getBlockPalette(blo);
-    std::vector<int> blockData = getBlockStatesData(blo, blockPalette);
-
-    // 转换为全局ID并注册调色板
-    std::vector<int> globalBlockData;
-    globalBlockData.reserve(blockData.size()); // 预分配空间
-
+// 返回方块在全局调色板中的ID,新方块加入调色板并生成模型缓存(调用方需持有 sectionCache 写锁)
+static int RegisterGlobalBlock(const std::string& blockName) {
     static std::unordered_map<std::string, int> globalBlockMap; // 预处理全局调色板映射
 
     // 预处理全局调色板,建立快速查找的映射
@@ -129,28 +130,45 @@ void ProcessSection(int chunkX, int chunkZ, int sectionY, const NbtTagPtr& secti
         }
     }
 
+    auto it = globalBlockMap.find(blockName);
+    if (it != globalBlockMap.end()) {
+        return it->second;
+    }
+
+    int idx = static_cast<int>(globalBlockPalette.size());
+    globalBlockPalette.emplace_back(blockName); // 新方块添加到全局调色板
+    globalBlockMap[blockName] = idx;
+
+    // 为新添加的方块生成模型缓存
+    if (config.asyncBlockstateCompile) {
+        // 交给后台线程池编译,不在持有 sectionCache 写锁时解析模型
+        EnqueueBlockstateCompile(globalBlockPalette.back());
+    }
+    else {
+        std::vector<Block> newBlockVector;
+        newBlockVector.push_back(globalBlockPalette.back()); // 获取刚添加的方块
+        ProcessBlockstateForBlocks(newBlockVector); // 调用处理函数
+    }
+    return idx;
+}
+
+// 新增函数:处理单个子区块
+void ProcessSection(int chunkX, int chunkZ, int sectionY, const NbtTagPtr& sectionTag) {
+    // 获取方块数据
+    auto blo = getBlockStates(sectionTag);
+    std::vector<std::string> blockPalette = getBlockPalette(blo);
+    std::vector<int> blockData = getBlockStatesData(blo, blockPalette);
+
+    // 转换为全局ID并注册调色板
+    std::vector<int> globalBlockData;
+    globalBlockData.reserve(blockData.size()); // 预分配空间
+
     for (int relativeId : blockData) {
         if (relativeId < 0 || relativeId >= static_cast<int>(blockPalette.size())) {
             globalBlockData.push_back(0);
             continue;
         }
-
-        const std::string& blockName = blockPalette[relativeId];
-        auto it = globalBlockMap.find(blockName);
-        if (it != globalBlockMap.end()) {
-            globalBlockData.push_back(it->second);
-        }
-        else {
-            int idx = static_cast<int>(globalBlockPalette.size());
-            globalBlockPalette.emplace_back(blockName); // 新方块添加到全局调色板
-            globalBlockMap[blockName] = idx;
-            globalBlockData.push_back(idx);
-
-            // 为新添加的方块生成模型缓存
-            std::vector<Block> newBlockVector;
-            newBlockVector.push_back(globalBlockPalette.back()); // 获取刚添加的方块
-            ProcessBlockstateForBlocks(newBlockVector); // 调用处理函数
-        }
+        globalBlockData.push_back(RegisterGlobalBlock(blockPalette[relativeId]));
     }
 
     // 获取生物群系数据
@@ -217,6 +235,12 @@ void ProcessSection(int chunkX, int chunkZ, int sectionY, const NbtTagPtr& secti
     std::vector<int> blockLightData;
     processLightData("BlockLight", blockLightData);
 
+    // 加载时一次性计算 LOD 金字塔,LOD 生成时每个单元只需一次查询
+    std::vector<LODMipCell> lodMips;
+    if (config.activeLOD) {
+        lodMips = LODManager::BuildSectionLODMips(globalBlockData);
+    }
+
     // 存储到统一的缓存
     int adjustedSectionY = AdjustSectionY(sectionY);
     auto blockKey = std::make_tuple(chunkX, chunkZ, adjustedSectionY);
@@ -225,13 +249,15 @@ void ProcessSection(int chunkX, int chunkZ, int sectionY, const NbtTagPtr& secti
         std::move(blockLightData),    // blockLight
         std::move(globalBlockData),   // blockData
         std::move(biomeData),         // biomeData
-        std::move(blockPalette)       // blockPalette
+        std::move(blockPalette),      // blockPalette
+        std::move(lodMips)            // lodMips
     };
 }
 
 // 新函数：清理指定 (chunkX, chunkZ) 的所有 sectionCache 条目
 void ClearSectionCacheForChunk(int chunkX, int chunkZ) {
     std::unique_lock<std::shared_mutex> write_lock(sectionCacheMutex);
+    surfaceOnlyChunks.erase(std::make_pair(chunkX, chunkZ));
     int removed_count = 0;
     for (auto it = sectionCache.begin(); it != sectionCache.end(); ) {
         if (std::get<0>(it->first) == chunkX && std::get<1>(it->first) == chunkZ) {
@@ -523,14 +549,20 @@ void ProcessEntityBlocks(int chunkX, int chunkZ, const NbtTagPtr& blockEntitiesT
 
 
 // 修改 LoadAndCacheBlockData,使其处理整个 chunk 的所有子区块
-void LoadAndCacheBlockData(int chunkX, int chunkZ) {
+void LoadAndCacheBlockData(int chunkX, int chunkZ, bool surfaceOnly) {
     auto key = std::make_tuple(chunkX, chunkZ, 0);
+    auto chunkKey = std::make_pair(chunkX, chunkZ);
+    // 已加载的区块直接返回;仅加载了地表的区块允许被完整加载替换
+    auto isLoaded = [&]() {
+        if (surfaceOnlyChunks.find(chunkKey) != surfaceOnlyChunks.end()) return surfaceOnly;
+        return sectionCache.find(key) != sectionCache.end();
+    };
     {
         std::shared_lock<std::shared_mutex> read_lock(sectionCacheMutex);
-        if (sectionCache.find(key) != sectionCache.end()) return;
+        if (isLoaded()) return;
     }
     std::unique_lock<std::shared_mutex> write_lock(sectionCacheMutex);
-    if (sectionCache.find(key) != sectionCache.end()) return;
+    if (isLoaded()) return;
     // 计算区域坐标
     int regionX, regionZ;
     chunkToRegion(chunkX, chunkZ, regionX, regionZ);
@@ -554,6 +586,8 @@ void LoadAndCacheBlockData(int chunkX, int chunkZ) {
         minSectionY = bytesToInt(yPosTag->payload);
     }
     // 处理高度图
+    // 仅加载地表时记录需要解析的子区块范围(由 MOTION_BLOCKING/WORLD_SURFACE 的最低与最高方块决定)
+    int surfaceSectionMin = INT_MAX, surfaceSectionMax = INT_MIN;
     auto heightMapsTag = getChildByName(tag, "Heightmaps");
     if (heightMapsTag && heightMapsTag->type == TagType::COMPOUND) {
         std::unique_lock<std::shared_mutex> hm_lock(heightMapCacheMutex); // 加锁
@@ -565,6 +599,17 @@ void LoadAndCacheBlockData(int chunkX, int chunkZ) {
                 std::vector<int64_t> longData(rawData, rawData + numLongs);
 
                 std::vector<int> heights = DecodeHeightMap(longData);
+                if (surfaceOnly && (mapType == "MOTION_BLOCKING" || mapType == "WORLD_SURFACE")) {
+                    for (int h : heights) {
+                        // 高度图存储的是最高方块上方的Y(相对世界底部)
+                        // 高度为 0 表示该列没有方块(如虚空),跳过以免把范围扩展到 minSectionY 之下
+                        if (h <= 0) continue;
+                        int topBlockY = minSectionY * 16 + h - 1;
+                        int sectionY = (topBlockY >= 0) ? topBlockY / 16 : (topBlockY - 15) / 16;
+                        surfaceSectionMin = std::min(surfaceSectionMin, sectionY);
+                        surfaceSectionMax = std::max(surfaceSectionMax, sectionY);
+                    }
+                }
                 heightMapCache[std::make_pair(chunkX, chunkZ)][mapType] = heights;
             }
         }
@@ -576,6 +621,18 @@ void LoadAndCacheBlockData(int chunkX, int chunkZ) {
         ProcessEntityBlocks(chunkX, chunkZ, blockEntitiesTag); 
     }
 
+    // 仅加载地表时记录已加载的最低子区块,地表之下的子区块在相邻区块看来为实心;
+    // 完整加载会重新解析全部子区块(已有的地表子区块被覆盖),并清除该记录
+    if (surfaceOnly) {
+        surfaceOnlyChunks[chunkKey] = (surfaceSectionMin <= surfaceSectionMax) ? AdjustSectionY(surfaceSectionMin) : INT_MIN;
+        if (surfaceFillBlockId.load(std::memory_order_relaxed) == 0) {
+            surfaceFillBlockId.store(RegisterGlobalBlock(kSurfaceFillBlockName), std::memory_order_relaxed);
+        }
+    }
+    else {
+        surfaceOnlyChunks.erase(chunkKey);
+    }
+
     // 提取所有子区块
     auto sectionsTag = getChildByName(tag, "sections");
     if (!sectionsTag || sectionsTag->type != TagType::LIST) {
@@ -591,6 +648,12 @@ void LoadAndCacheBlockData(int chunkX, int chunkZ) {
             sectionY = static_cast<int>(yTag->payload[0]);
         }
 
+        // 仅加载地表时跳过地表范围之外的子区块
+        if (surfaceOnly && surfaceSectionMin <= surfaceSectionMax &&
+            (sectionY < surfaceSectionMin || sectionY > surfaceSectionMax)) {
+            continue;
+        }
+
         // 处理子区块
         ProcessSection(chunkX, chunkZ, sectionY, sectionTag);
     }
@@ -610,6 +673,13 @@ int GetBlockId(int blockX, int blockY, int blockZ) {
     auto blockKey = std::make_tuple(chunkX, chunkZ, adjustedSectionY);
     auto it = sectionCache.find(blockKey);
     if (it == sectionCache.end()) {
+        // 仅加载地表的区块:地表之下未加载的子区块视为实心,避免相邻的完整区块在接缝处生成多余的面
+        if (!surfaceOnlyChunks.empty()) {
+            auto surfaceIt = surfaceOnlyChunks.find(std::make_pair(chunkX, chunkZ));
+            if (surfaceIt != surfaceOnlyChunks.end() && adjustedSectionY < surfaceIt->second) {
+                return surfaceFillBlockId.load(std::memory_order_relaxed);
+            }
+        }
         return 0; // 区块未预加载，返回空气
     }
     const auto& blockData = it->second.blockData;
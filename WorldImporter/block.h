@@ -60,8 +60,8 @@ struct Block {
             fullName.substr(0, bracketPos) : fullName;
         std::string baseName(baseNameView);
 
-        // 解析方块状态属性 (用 string_view 减少拷贝)
-        std::unordered_map<std::string, std::string> states;
+        // 解析方块状态属性 (用 string_view 减少拷贝,状态数很少,线性查找即可)
+        std::vector<std::pair<std::string_view, std::string_view>> states;
         if (bracketPos != std::string_view::npos) {
             size_t closePos = fullName.find(']', bracketPos + 1);
             std::string_view stateStrView = fullName.substr(bracketPos + 1, closePos - bracketPos - 1);
@@ -73,46 +73,37 @@ struct Block {
                     stateStrView.substr(start, end - start);
                 size_t eqPos = pairView.find(':');
                 if (eqPos != std::string_view::npos) {
-                    states.emplace(
-                        std::string(pairView.substr(0, eqPos)),
-                        std::string(pairView.substr(eqPos + 1))
-                    );
+                    states.emplace_back(pairView.substr(0, eqPos), pairView.substr(eqPos + 1));
                 }
                 if (end == std::string_view::npos) break;
                 start = end + 1;
             }
         }
+        auto findState = [&states](std::string_view key) -> const std::string_view* {
+            for (const auto& state : states) {
+                if (state.first == key) return &state.second;
+            }
+            return nullptr;
+        };
 
         /* 流体处理逻辑 */
         bool fluidProcessed = false;
 
         // 阶段1:检查强制含水方块
-        if (!fluidProcessed) {
-            for (const auto& fluidEntry : fluidDefinitions) {
-                const FluidInfo& info = fluidEntry.second;
-                if (info.liquid_blocks.count(baseName)) {
-                    level = 0;
-                    fluidProcessed = true;
-                    break;
-                }
-            }
+        if (fluidLiquidBlocks.count(baseName)) {
+            level = 0;
+            fluidProcessed = true;
         }
         // 阶段2:检查流体属性(如waterlogged)
-        for (const auto& fluidEntry : fluidDefinitions) {
-            const std::string& fluidName = fluidEntry.first;
-            const FluidInfo& info = fluidEntry.second;
-
-            if (!info.property.empty() &&
-                states.count(info.property) &&
-                states[info.property] == "true") {
+        for (const auto& property : fluidStateProperties) {
+            const std::string_view* value = findState(property);
+            if (value && *value == "true") {
                 level = 0;
                 fluidProcessed = true;
                 break;
             }
         }
 
-        
-
         // 阶段3:处理流体自身level属性
         if (!fluidProcessed) {
             const auto& it = fluidDefinitions.find(baseName);
@@ -121,9 +112,9 @@ struct Block {
                 std::string levelProp = info.level_property.empty() ?
                     "level" : info.level_property;
 
+                const std::string_view* levelValue = findState(levelProp);
                 try {
-                    level = states.count(levelProp) ?
-                        std::stoi(states[levelProp]) : 0;
+                    level = levelValue ? std::stoi(std::string(*levelValue)) : 0;
                 }
                 catch (...) {
                     level = 0;
@@ -402,6 +393,14 @@ struct Block {
     }
 };
 
+// LOD 金字塔单元:对应 Section 内一个对齐的 2³/4³/8³ 方块区域
+struct LODMipCell {
+    int id = 0;            // 代表方块的全局ID
+    uint8_t type = 0;      // 区域类型(BlockType: AIR/FLUID/SOLID)
+    uint8_t level = 0;     // 顶部空出的层数(即填充高度的补数)
+    uint16_t faceMask = 0; // 六个边界层的遮挡信息,低6位:全为固体,高6位:不含空气
+};
+
 struct SectionCacheEntry {
     // 把频繁访问的大数组放在前面,减少访存跨缓存行
     std::vector<int> skyLight;      // 天空光照数据
@@ -409,6 +408,7 @@ struct SectionCacheEntry {
     std::vector<int> blockData;     // 方块数据
     std::vector<int> biomeData;     // 生物群系数据
     std::vector<std::string> blockPalette; // 方块调色板 (相对较小)
+    std::vector<LODMipCell> lodMips; // LOD 金字塔(依次为 2³、4³、8³ 单元),未启用LOD时为空
 };
 
 extern std::vector<Block> globalBlockPalette;
@@ -424,7 +424,9 @@ extern std::shared_mutex chunkAuxCacheMutex;
 // 高度图类型
 static const std::vector<std::string> mapTypes = {"MOTION_BLOCKING", "MOTION_BLOCKING_NO_LEAVES",   "OCEAN_FLOOR", "WORLD_SURFACE"};
 
-void LoadAndCacheBlockData(int chunkX, int chunkZ);
+// surfaceOnly 为 true 时只解析覆盖地表高度范围的子区块(用于高度场远景LOD),地表之下的子区块查询时视为实心;
+// 之后以 surfaceOnly 为 false 再次调用会完整加载该区块
+void LoadAndCacheBlockData(int chunkX, int chunkZ, bool surfaceOnly = false);
 
 void UpdateSkyLightNeighborFlags();
 
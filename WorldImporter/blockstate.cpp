@@ -1,14 +1,16 @@
 ﻿#include "blockstate.h"
 #include "fileutils.h"
 #include "ObjExporter.h"
-#include <regex>
 #include <random>
 #include <numeric>
 #include <Windows.h>
 #include <iostream>
-#include <sstream>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
+#include <map>
+#include <deque>
+#include <condition_variable>
 
 std::unordered_map<std::string, std::unordered_map<std::string, ModelData>> BlockModelCache;
 
@@ -19,191 +21,13 @@ std::unordered_map<std::string,std::unordered_map<std::string,std::vector<std::v
 // 将互斥锁类型更改为 std::shared_mutex
 std::shared_mutex blockstateCachesMutex;
 
-// --------------------------------------------------------------------------------
-// 条件匹配函数
-// --------------------------------------------------------------------------------
-bool matchConditions(const std::unordered_map<std::string, std::string>& blockConditions, const nlohmann::json& when) {
-    if (when.is_object()) {
-        // 处理空对象条件
-        if (when.empty()) {
-            return false; // 触发警告:No elements found in selector
-        }
-
-        // 检查是否为单一OR或AND条件
-        if (when.size() == 1) {
-            // 处理OR条件
-            if (when.contains("OR")) {
-                const auto& orCond = when["OR"];
-                if (!orCond.is_array()) {
-                    return false; // 触发警告:OR应为数组
-                }
-                for (const auto& cond : orCond) {
-                    if (matchConditions(blockConditions, cond)) {
-                        return true;
-                    }
-                }
-                return false;
-            }
-            // 处理AND条件
-            else if (when.contains("AND")) {
-                const auto& andCond = when["AND"];
-                if (!andCond.is_array()) {
-                    return false; // 触发警告:AND应为数组
-                }
-                for (const auto& cond : andCond) {
-                    if (!matchConditions(blockConditions, cond)) {
-                        return false;
-                    }
-                }
-                return true;
-            }
-        }
-
-        // 处理普通多条件检查
-        for (const auto& item : when.items()) {
-            const std::string& prop = item.key();
-            const auto& valueJson = item.value();
-
-            // 检查值类型是否为字符串
-            if (!valueJson.is_string()) {
-                return false; // 触发异常警告
-            }
-            std::string valueStr = valueJson.get<std::string>();
-
-            // 解析反转标记
-            bool invert = false;
-            if (!valueStr.empty() && valueStr[0] == '!') {
-                invert = true;
-                valueStr = valueStr.substr(1);
-            }
-
-            // 分割选项值
-            std::vector<std::string> options;
-            size_t pos;
-            while ((pos = valueStr.find('|')) != std::string::npos) {
-                options.push_back(valueStr.substr(0, pos));
-                valueStr.erase(0, pos + 1);
-            }
-            options.push_back(valueStr);
-
-            // 空选项检查
-            if (options.empty() || (options.size() == 1 && options[0].empty())) {
-                return false; // 触发警告:空属性值
-            }
-
-            // 检查方块属性是否存在
-            auto blockIt = blockConditions.find(prop);
-            if (blockIt == blockConditions.end()) {
-                return false; // 触发警告:未知属性
-            }
-
-            // 判断属性值是否匹配
-            bool valueMatched = std::find(options.begin(), options.end(), blockIt->second) != options.end();
-            if (invert) {
-                if (valueMatched) return false;
-            }
-            else {
-                if (!valueMatched) return false;
-            }
-        }
-        return true;
-    }
-    // 当条件不存在时默认匹配
-    else if (when.is_null()) {
-        return true;
-    }
-    // 非对象/null类型无效
-    return false;
-}
-
-// 辅助函数:将键值对字符串解析为map
-std::unordered_map<std::string, std::string> ParseKeyValuePairs(const std::string& input) {
-    std::unordered_map<std::string, std::string> result;
-    if (input.empty()) return result;
-
-    std::stringstream ss(input);
-    std::string pair;
-    while (std::getline(ss, pair, ',')) {
-        size_t eqPos = pair.find('=');
-        if (eqPos != std::string::npos) {
-            std::string key = pair.substr(0, eqPos);
-            std::string value = pair.substr(eqPos + 1);
-            result[key] = value;
-        }
-    }
-    return result;
-}
-
-// 检查 subset 的所有键值对是否存在于 superset 中且值相同
-bool IsSubset(const std::unordered_map<std::string, std::string>& subset,const std::unordered_map<std::string, std::string>& superset) {
-    for (const auto& kv : subset) {
-        auto it = superset.find(kv.first);
-        
-        if (it == superset.end() || it->second != kv.second) {
-            return false;
-        }
-    }
-    return true;
-}
-// --------------------------------------------------------------------------------
-// 字符串分割函数
-// --------------------------------------------------------------------------------
-std::vector<std::string> SplitString(const std::string& input, char delimiter) {
-    std::vector<std::string> result;
-    std::istringstream stream(input);
-    std::string token;
-    while (std::getline(stream, token, delimiter)) {
-        result.push_back(token);
-    }
-    return result;
-}
-
-// --------------------------------------------------------------------------------
-// 编码和排序函数
-// --------------------------------------------------------------------------------
-std::string SortedVariantKey(const std::string& key) {
-    static const std::regex keyRegex(R"(([^,=]+)=([^,]+))");
-    std::smatch keyMatch;
-
-    std::map<std::string, std::string> keyMap;
-    std::vector<std::string> parts = SplitString(key, ',');
-
-    for (const auto& part : parts) {
-        std::smatch match;
-        if (std::regex_match(part, match, keyRegex)) {
-            std::string name = match[1].str();
-            std::string value = match[2].str();
-            keyMap[name] = value;
-        }
-    }
-
-    std::stringstream ss;
-    bool first = true;
-    for (const auto& entry : keyMap) {
-        if (!first) {
-            ss << ",";
-        }
-        ss << entry.first << "=" << entry.second;
-        first = false;
-    }
-
-    return ss.str();
-}
-
 // --------------------------------------------------------------------------------
 // JSON 文件读取函数
 // --------------------------------------------------------------------------------
 nlohmann::json GetBlockstateJson(const std::string& namespaceName, const std::string& blockId) {
-    std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-
-    // 按照 JAR 文件的加载顺序逐个查找
-    for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-        const std::string& modId = GlobalCache::jarOrder[i];
-        std::string cacheKey = modId + ":" + namespaceName + ":" + blockId;
-        auto it = GlobalCache::blockstates.find(cacheKey);
-        if (it != GlobalCache::blockstates.end()) {
-            return it->second;
-        }
+    // 覆盖关系已在初始化时解析,直接查找生效版本(只读,无需加锁)
+    if (auto entry = GlobalCache::FindResolved(GlobalCache::resolvedBlockstates, namespaceName, blockId)) {
+        return entry->second;
     }
 
     std::cerr << "Blockstate not found: " << namespaceName << ":" << blockId << std::endl;
@@ -288,230 +112,410 @@ ModelData GetRandomModelFromCache(const std::string& namespaceName, const std::s
     return ModelData();
 }
 
+// --------------------------------------------------------------------------------
+// 方块状态谓词编译
+// --------------------------------------------------------------------------------
+namespace {
+    constexpr uint16_t kStateAbsent = 0xFFFF;  // 方块没有该属性
+    constexpr uint16_t kStateUnknown = 0xFFFE; // 属性值未在 blockstate 中出现
+
+    // 单个属性条件:属性值序号落在 valueMask 中(invert 时取反)
+    struct CompiledTerm {
+        uint16_t slot = 0;
+        bool invert = false;
+        std::vector<uint64_t> valueMask;
+    };
+
+    // multipart 的 when 条件
+    struct CompiledCondition {
+        enum Kind : uint8_t { ALWAYS, NEVER, ANY, ALL, TERMS };
+        Kind kind = ALWAYS;
+        std::vector<CompiledCondition> children; // ANY / ALL
+        std::vector<CompiledTerm> terms;         // TERMS:全部满足
+    };
+
+    struct CompiledVariant {
+        std::vector<std::pair<uint16_t, uint16_t>> required; // (属性槽, 值序号)
+        const nlohmann::json* value = nullptr;               // 指向 CompiledBlockstate::json 内部
+    };
+
+    struct CompiledMultipartPart {
+        CompiledCondition when;
+        const nlohmann::json* apply = nullptr;
+    };
+
+    // 编译后的 blockstate:属性名与属性值均映射为小整数,匹配时只做整数比较
+    struct CompiledBlockstate {
+        nlohmann::json json;
+        std::unordered_map<std::string, uint16_t> slotIndex;                      // 属性名 -> 属性槽
+        std::vector<std::unordered_map<std::string, uint16_t>> slotValues;        // 每个属性槽的取值 -> 值序号
+        bool hasVariants = false;
+        bool hasMultipart = false;
+        bool multipartHasArrayApply = false;
+        std::vector<CompiledVariant> variants;       // 按键名顺序
+        std::vector<CompiledMultipartPart> multipart; // 仅包含带 apply 的项
+
+        uint16_t InternSlot(const std::string& name) {
+            auto [it, inserted] = slotIndex.try_emplace(name, static_cast<uint16_t>(slotValues.size()));
+            if (inserted) slotValues.emplace_back();
+            return it->second;
+        }
+
+        uint16_t InternValue(uint16_t slot, const std::string& value) {
+            auto& values = slotValues[slot];
+            return values.try_emplace(value, static_cast<uint16_t>(values.size())).first->second;
+        }
+    };
+
+    // 按 "a=b,c=d" 格式逐项解析状态字符串(名称与值均非空,同名以后者为准)
+    template <typename Fn>
+    void ForEachStatePair(const std::string& input, Fn&& fn) {
+        size_t start = 0;
+        while (start <= input.size()) {
+            size_t end = input.find(',', start);
+            if (end == std::string::npos) end = input.size();
+            size_t eqPos = input.find('=', start);
+            if (eqPos != std::string::npos && eqPos > start && eqPos + 1 < end) {
+                fn(input.substr(start, eqPos - start), input.substr(eqPos + 1, end - eqPos - 1));
+            }
+            start = end + 1;
+        }
+    }
+
+    // 编译 multipart 的 when 条件:null 恒匹配,空对象或非法值永不匹配,OR/AND 递归组合,属性值支持 "a|b" 多选与 "!" 取反
+    CompiledCondition CompileCondition(CompiledBlockstate& blockstate, const nlohmann::json& when) {
+        CompiledCondition condition;
+        if (when.is_null()) {
+            condition.kind = CompiledCondition::ALWAYS;
+            return condition;
+        }
+        if (!when.is_object() || when.empty()) {
+            condition.kind = CompiledCondition::NEVER;
+            return condition;
+        }
+
+        // 单一 OR / AND 条件
+        if (when.size() == 1 && (when.contains("OR") || when.contains("AND"))) {
+            bool isOr = when.contains("OR");
+            const auto& list = isOr ? when["OR"] : when["AND"];
+            if (!list.is_array()) {
+                condition.kind = CompiledCondition::NEVER;
+                return condition;
+            }
+            condition.kind = isOr ? CompiledCondition::ANY : CompiledCondition::ALL;
+            for (const auto& child : list) {
+                condition.children.push_back(CompileCondition(blockstate, child));
+            }
+            return condition;
+        }
+
+        // 普通多条件:每个属性编译为一个取值位集
+        condition.kind = CompiledCondition::TERMS;
+        for (const auto& item : when.items()) {
+            if (!item.value().is_string()) {
+                condition.kind = CompiledCondition::NEVER;
+                condition.terms.clear();
+                return condition;
+            }
+            std::string valueStr = item.value().get<std::string>();
+
+            CompiledTerm term;
+            if (!valueStr.empty() && valueStr[0] == '!') {
+                term.invert = true;
+                valueStr.erase(0, 1);
+            }
+            if (valueStr.empty()) {
+                // 空属性值
+                condition.kind = CompiledCondition::NEVER;
+                condition.terms.clear();
+                return condition;
+            }
+
+            term.slot = blockstate.InternSlot(item.key());
+            size_t start = 0;
+            while (start <= valueStr.size()) {
+                size_t end = valueStr.find('|', start);
+                if (end == std::string::npos) end = valueStr.size();
+                uint16_t valueIndex = blockstate.InternValue(term.slot, valueStr.substr(start, end - start));
+                if (term.valueMask.size() <= valueIndex / 64) term.valueMask.resize(valueIndex / 64 + 1, 0);
+                term.valueMask[valueIndex / 64] |= uint64_t(1) << (valueIndex % 64);
+                start = end + 1;
+            }
+            condition.terms.push_back(std::move(term));
+        }
+        return condition;
+    }
+
+    bool MatchCondition(const CompiledCondition& condition, const std::vector<uint16_t>& state) {
+        switch (condition.kind) {
+        case CompiledCondition::ALWAYS:
+            return true;
+        case CompiledCondition::NEVER:
+            return false;
+        case CompiledCondition::ANY:
+            for (const auto& child : condition.children) {
+                if (MatchCondition(child, state)) return true;
+            }
+            return false;
+        case CompiledCondition::ALL:
+            for (const auto& child : condition.children) {
+                if (!MatchCondition(child, state)) return false;
+            }
+            return true;
+        case CompiledCondition::TERMS:
+            for (const auto& term : condition.terms) {
+                uint16_t value = state[term.slot];
+                if (value == kStateAbsent) return false; // 未知属性
+                bool matched = value != kStateUnknown && value / 64 < term.valueMask.size() &&
+                    ((term.valueMask[value / 64] >> (value % 64)) & 1);
+                if (matched == term.invert) return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool MatchVariant(const CompiledVariant& variant, const std::vector<uint16_t>& state) {
+        for (const auto& [slot, value] : variant.required) {
+            if (state[slot] != value) return false;
+        }
+        return true;
+    }
+
+    // 将方块的状态字符串编码为每个属性槽的值序号(blockstate 未引用的属性忽略)
+    std::vector<uint16_t> EncodeBlockState(const CompiledBlockstate& blockstate, const std::string& condition) {
+        std::vector<uint16_t> state(blockstate.slotValues.size(), kStateAbsent);
+        ForEachStatePair(condition, [&](const std::string& name, const std::string& value) {
+            auto slotIt = blockstate.slotIndex.find(name);
+            if (slotIt == blockstate.slotIndex.end()) return;
+            const auto& values = blockstate.slotValues[slotIt->second];
+            auto valueIt = values.find(value);
+            state[slotIt->second] = (valueIt != values.end()) ? valueIt->second : kStateUnknown;
+        });
+        return state;
+    }
+
+    std::shared_ptr<const CompiledBlockstate> CompileBlockstate(nlohmann::json blockstateJson) {
+        auto compiled = std::make_shared<CompiledBlockstate>();
+        compiled->json = std::move(blockstateJson);
+        const auto& json = compiled->json;
+
+        if (json.contains("variants")) {
+            compiled->hasVariants = true;
+            for (const auto& variant : json["variants"].items()) {
+                CompiledVariant compiledVariant;
+                compiledVariant.value = &variant.value();
+
+                // 变体键名中的键值对(同名以后者为准)
+                std::map<std::string, std::string> keyMap;
+                ForEachStatePair(variant.key(), [&](const std::string& name, const std::string& value) {
+                    keyMap[name] = value;
+                });
+                for (const auto& [name, value] : keyMap) {
+                    uint16_t slot = compiled->InternSlot(name);
+                    compiledVariant.required.emplace_back(slot, compiled->InternValue(slot, value));
+                }
+                compiled->variants.push_back(std::move(compiledVariant));
+            }
+            return compiled;
+        }
+
+        if (json.contains("multipart")) {
+            compiled->hasMultipart = true;
+            for (const auto& item : json["multipart"]) {
+                if (!item.contains("apply")) continue;
+                CompiledMultipartPart part;
+                part.apply = &item["apply"];
+                part.when = item.contains("when") ? CompileCondition(*compiled, item["when"]) : CompiledCondition();
+                if (part.apply->is_array()) compiled->multipartHasArrayApply = true;
+                compiled->multipart.push_back(std::move(part));
+            }
+        }
+        return compiled;
+    }
+
+    // 编译后的 blockstate 缓存("命名空间:方块ID" -> 编译结果),blockstate 不存在时缓存空指针
+    std::unordered_map<std::string, std::shared_ptr<const CompiledBlockstate>> compiledBlockstateCache;
+    std::shared_mutex compiledBlockstateCacheMutex;
+
+    std::shared_ptr<const CompiledBlockstate> GetCompiledBlockstate(const std::string& namespaceName, const std::string& baseBlockId) {
+        std::string cacheKey = namespaceName + ":" + baseBlockId;
+        {
+            std::shared_lock<std::shared_mutex> lock(compiledBlockstateCacheMutex);
+            auto it = compiledBlockstateCache.find(cacheKey);
+            if (it != compiledBlockstateCache.end()) {
+                return it->second;
+            }
+        }
+
+        std::shared_ptr<const CompiledBlockstate> compiled;
+        nlohmann::json blockstateJson = GetBlockstateJson(namespaceName, baseBlockId);
+        if (!blockstateJson.is_null()) {
+            compiled = CompileBlockstate(std::move(blockstateJson));
+        }
+
+        std::unique_lock<std::shared_mutex> lock(compiledBlockstateCacheMutex);
+        return compiledBlockstateCache.emplace(cacheKey, std::move(compiled)).first->second;
+    }
+
+    // 读取 variant / apply 中的模型引用,解析模型命名空间
+    bool ParseModelReference(const nlohmann::json& entry, const std::string& namespaceName,
+        std::string& modelNamespace, std::string& modelId) {
+        modelId = entry.contains("model") ? entry["model"].get<std::string>() : "";
+        if (modelId.empty()) return false;
+        modelNamespace = namespaceName;
+        size_t colonPos = modelId.find(':');
+        if (colonPos != std::string::npos) {
+            modelNamespace = modelId.substr(0, colonPos);
+            modelId = modelId.substr(colonPos + 1);
+        }
+        return true;
+    }
+}
+
 // 此方法会处理对应的json文件 
 // 然后计算出方块的模型数据存储在BlockModelCache / VariantModelCache / MultipartModelCache 里面
 // 你可以使用 GetRandomModelFromCache 方法来获取模型
 void ProcessBlockstate(const std::string& namespaceName, const std::vector<std::string>& blockIds) {
     for (const auto& blockId : blockIds) {
-        // 解析 blockId 和条件
-        static const std::regex blockIdRegex(R"(^(.*?)\[(.*)\]$)");
-        std::smatch match;
+        // 解析 blockId 和条件("name[a=b,c=d]")
         std::string baseBlockId = blockId;
         std::string condition;
-        std::unordered_map<std::string, std::string> blockConditions;
         std::string blockstateName = namespaceName + ":" + blockId;
 
-        if (std::regex_match(blockId, match, blockIdRegex)) {
-            baseBlockId = match.str(1);
-            condition = match.str(2);
-
-            static const std::regex conditionRegex(R"((\w+)=([^,]+))");
-            auto conditionsBegin = std::sregex_iterator(condition.begin(), condition.end(), conditionRegex);
-            auto conditionsEnd = std::sregex_iterator();
-
-            for (auto i = conditionsBegin; i != conditionsEnd; ++i) {
-                std::smatch submatch = *i;
-                blockConditions[submatch[1].str()] = submatch[2].str();
-            }
+        size_t bracketPos = blockId.find('[');
+        if (bracketPos != std::string::npos && blockId.back() == ']') {
+            baseBlockId = blockId.substr(0, bracketPos);
+            condition = blockId.substr(bracketPos + 1, blockId.size() - bracketPos - 2);
         }
 
-        // 读取 blockstate JSON
-        nlohmann::json blockstateJson = GetBlockstateJson(namespaceName, baseBlockId);
-
-
-        if (blockstateJson.is_null()) {
+        // 获取编译后的 blockstate,并将方块状态编码为属性值序号
+        auto compiled = GetCompiledBlockstate(namespaceName, baseBlockId);
+        if (!compiled) {
             continue;
         }
-
-        ModelData mergedModel;
-        std::vector<ModelData> selectedModels;
+        std::vector<uint16_t> state = EncodeBlockState(*compiled, condition);
 
         // 处理 variants
-        if (blockstateJson.contains("variants")) {
-            for (auto& variant : blockstateJson["variants"].items()) {
-                std::string variantKey = variant.key();
-                std::string normalizedCondition = SortedVariantKey(condition);
-                std::string normalizedVariantKey = SortedVariantKey(variantKey);
-
-                // 解析为键值对
-                auto conditionMap = ParseKeyValuePairs(normalizedCondition);
-                auto variantMap = ParseKeyValuePairs(normalizedVariantKey);
-
-                // 判断条件:variantMap 的所有键值对需存在于 conditionMap 中
-                if (condition.empty() || IsSubset(variantMap, conditionMap)) {
+        if (compiled->hasVariants) {
+            // 多个变体同时匹配时以最后一个为准,只需为其生成模型
+            const CompiledVariant* arrayVariant = nullptr;
+            const CompiledVariant* modelVariant = nullptr;
+            for (const auto& variant : compiled->variants) {
+                if (!condition.empty() && !MatchVariant(variant, state)) continue;
+                if (variant.value->is_array()) {
+                    arrayVariant = &variant;
+                }
+                else if (variant.value->is_object() && variant.value->contains("model") &&
+                    !(*variant.value)["model"].get<std::string>().empty()) {
+                    modelVariant = &variant;
+                }
+            }
+
+            // 处理模型加权数组
+            if (arrayVariant) {
+                std::vector<WeightedModelData> weightedModels;
+                int t = 0;
+                for (const auto& item : *arrayVariant->value) {
                     int rotationX = 0, rotationY = 0;
                     bool uvlock = false;
-
-
-                    if (variant.value().contains("x")) {
-                        rotationX = variant.value()["x"].get<int>();
-                        rotationX = (rotationX % 360 + 360) % 360; 
+                    if (item.contains("x")) {
+                        rotationX = item["x"].get<int>();
                     }
-                    if (variant.value().contains("y")) {
-                        rotationY = variant.value()["y"].get<int>();
-                        rotationY = (rotationY % 360 + 360) % 360;
+                    if (item.contains("y")) {
+                        rotationY = item["y"].get<int>();
                     }
-                    if (variant.value().contains("uvlock")) {
-                        uvlock = variant.value()["uvlock"].get<bool>();
+                    if (item.contains("uvlock")) {
+                        uvlock = item["uvlock"].get<bool>();
                     }
 
-                    // 处理模型加权数组
-                    if (variant.value().is_array()) {
-                        std::vector<WeightedModelData> weightedModels;
-                        std::string cacheKey = namespaceName + ":" + baseBlockId + ":" + variantKey;
-                        ModelData model;
-                        int t = 0;
-                        for (const auto& item : variant.value()) {
-                            int rotationX = 0, rotationY = 0;
-                            bool uvlock = false;
-                            if (item.contains("x")) {
-                                rotationX = item["x"].get<int>();
-                            }
-                            if (item.contains("y")) {
-                                rotationY = item["y"].get<int>();
-                            }
-                            if (item.contains("uvlock")) {
-                                uvlock = item["uvlock"].get<bool>();
-                            }
-
-                            int weight = item.contains("weight") ? item["weight"].get<int>() : 1;
-                            std::string modelId = item.contains("model") ? item["model"].get<std::string>() : "";
-
-                            if (!modelId.empty()) {
-                                // 处理模型命名空间
-                                size_t colonPos = modelId.find(':');
-                                std::string modelNamespace = namespaceName;
-                                if (colonPos != std::string::npos) {
-                                    modelNamespace = modelId.substr(0, colonPos);
-                                    modelId = modelId.substr(colonPos + 1);
-                                }
-
-                                // 生成模型数据
-                                model = ProcessModelJson(modelNamespace, modelId,
-                                    rotationX, rotationY, uvlock, t, blockstateName);
-
-                                weightedModels.push_back({ model, weight });
-                                t = t + 1;
-                            }
+                    int weight = item.contains("weight") ? item["weight"].get<int>() : 1;
+                    std::string modelNamespace, modelId;
+                    if (ParseModelReference(item, namespaceName, modelNamespace, modelId)) {
+                        // 生成模型数据
+                        ModelData model = ProcessModelJson(modelNamespace, modelId,
+                            rotationX, rotationY, uvlock, t, blockstateName);
 
-                        }
-                        // 存入缓存
-                        {
-                            std::unique_lock<std::shared_mutex> lock(blockstateCachesMutex); // 使用 unique_lock 进行写操作
-                            VariantModelCache[namespaceName][blockId] = weightedModels;
-                        }
-                        continue;
-
-                    }
-                    else {
-                        std::string modelId = variant.value().contains("model") ? variant.value()["model"].get<std::string>() : "";
-                        if (!modelId.empty()) {
-                            size_t colonPos = modelId.find(':');
-                            std::string modelNamespace = namespaceName;
-
-                            if (colonPos != std::string::npos) {
-                                modelNamespace = modelId.substr(0, colonPos);
-                                modelId = modelId.substr(colonPos + 1);
-                            }
-
-                            mergedModel = ProcessModelJson(modelNamespace, modelId, rotationX, rotationY, uvlock, 0, blockstateName);
-                           
-                            {
-                                std::unique_lock<std::shared_mutex> lock(blockstateCachesMutex); // 使用 unique_lock 进行写操作
-                                BlockModelCache[namespaceName][blockId] = mergedModel;
-                            }
-                        }
+                        weightedModels.push_back({ model, weight });
+                        t = t + 1;
                     }
                 }
+                // 存入缓存
+                {
+                    std::unique_lock<std::shared_mutex> lock(blockstateCachesMutex); // 使用 unique_lock 进行写操作
+                    VariantModelCache[namespaceName][blockId] = weightedModels;
+                }
             }
-            continue;
-        }
 
-        // 处理 multipart
-        if (blockstateJson.contains("multipart")) {
-            auto multipart = blockstateJson["multipart"];
-            bool useMultipartModelCache = false;
-            // 第一次遍历:检测是否存在列表格式的 apply
-            for (const auto& item : multipart) {
-                if (item.contains("apply") && item["apply"].is_array()) {
-                    useMultipartModelCache = true;
-                    break;
+            if (modelVariant) {
+                const auto& variant = *modelVariant->value;
+                int rotationX = 0, rotationY = 0;
+                bool uvlock = false;
+                if (variant.contains("x")) {
+                    rotationX = variant["x"].get<int>();
+                    rotationX = (rotationX % 360 + 360) % 360;
+                }
+                if (variant.contains("y")) {
+                    rotationY = variant["y"].get<int>();
+                    rotationY = (rotationY % 360 + 360) % 360;
+                }
+                if (variant.contains("uvlock")) {
+                    uvlock = variant["uvlock"].get<bool>();
+                }
+
+                std::string modelNamespace, modelId;
+                ParseModelReference(variant, namespaceName, modelNamespace, modelId);
+                ModelData mergedModel = ProcessModelJson(modelNamespace, modelId, rotationX, rotationY, uvlock, 0, blockstateName);
+                {
+                    std::unique_lock<std::shared_mutex> lock(blockstateCachesMutex); // 使用 unique_lock 进行写操作
+                    BlockModelCache[namespaceName][blockId] = mergedModel;
                 }
             }
+            continue;
+        }
 
-            if (useMultipartModelCache) {
+        // 处理 multipart
+        if (compiled->hasMultipart) {
+            if (compiled->multipartHasArrayApply) {
                 // 存储所有 multipart 项的模型组,每项都作为列表处理
                 std::vector<std::vector<WeightedModelData>> multipartModelsList;
-                for (const auto& item : multipart) {
-                    if (!item.contains("apply"))
-                        continue;
-                    bool conditionMatched = true;
-                    if (item.contains("when")) {
-                        conditionMatched = matchConditions(blockConditions, item["when"]);
-                    }
-                    if (!conditionMatched)
+                for (const auto& part : compiled->multipart) {
+                    if (!MatchCondition(part.when, state))
                         continue;
 
                     std::vector<WeightedModelData> multipartModels;
                     int t = 0;
-                    // 如果 apply 为数组,直接遍历,否则将对象包装为单元素数组
-                    if (item["apply"].is_array()) {
-                        for (const auto& modelItem : item["apply"]) {
-                            int rotationX = 0, rotationY = 0;
-                            bool uvlock = false;
-                            if (modelItem.contains("x")) {
-                                rotationX = modelItem["x"].get<int>();
-                            }
-                            if (modelItem.contains("y")) {
-                                rotationY = modelItem["y"].get<int>();
-                            }
-                            if (modelItem.contains("uvlock")) {
-                                uvlock = modelItem["uvlock"].get<bool>();
-                            }
-                            int weight = modelItem.contains("weight") ? modelItem["weight"].get<int>() : 1;
-                            std::string modelId = modelItem.contains("model") ? modelItem["model"].get<std::string>() : "";
-                            if (!modelId.empty()) {
-                                // 处理模型命名空间
-                                size_t colonPos = modelId.find(':');
-                                std::string modelNamespace = namespaceName;
-                                if (colonPos != std::string::npos) {
-                                    modelNamespace = modelId.substr(0, colonPos);
-                                    modelId = modelId.substr(colonPos + 1);
-                                }
-                                // 生成模型数据
-                                ModelData model = ProcessModelJson(modelNamespace, modelId,
-                                    rotationX, rotationY, uvlock, t, blockstateName);
-                                multipartModels.push_back({ model, weight });
-                                ++t;
-                            }
-                        }
-                    }
-                    else if (item["apply"].is_object()) {
-                        auto apply = item["apply"];
+                    // 如果 apply 为数组,直接遍历,否则将对象视为单元素
+                    auto processApply = [&](const nlohmann::json& modelItem) {
                         int rotationX = 0, rotationY = 0;
                         bool uvlock = false;
-                        if (apply.contains("x")) {
-                            rotationX = apply["x"].get<int>();
+                        if (modelItem.contains("x")) {
+                            rotationX = modelItem["x"].get<int>();
                         }
-                        if (apply.contains("y")) {
-                            rotationY = apply["y"].get<int>();
+                        if (modelItem.contains("y")) {
+                            rotationY = modelItem["y"].get<int>();
                         }
-                        if (apply.contains("uvlock")) {
-                            uvlock = apply["uvlock"].get<bool>();
+                        if (modelItem.contains("uvlock")) {
+                            uvlock = modelItem["uvlock"].get<bool>();
                         }
-                        int weight = apply.contains("weight") ? apply["weight"].get<int>() : 1;
-                        std::string modelId = apply.contains("model") ? apply["model"].get<std::string>() : "";
-                        if (!modelId.empty()) {
-                            size_t colonPos = modelId.find(':');
-                            std::string modelNamespace = namespaceName;
-                            if (colonPos != std::string::npos) {
-                                modelNamespace = modelId.substr(0, colonPos);
-                                modelId = modelId.substr(colonPos + 1);
-                            }
-                            ModelData model = ProcessModelJson(modelNamespace, modelId, rotationX, rotationY, uvlock, t, blockstateName);
+                        int weight = modelItem.contains("weight") ? modelItem["weight"].get<int>() : 1;
+                        std::string modelNamespace, modelId;
+                        if (ParseModelReference(modelItem, namespaceName, modelNamespace, modelId)) {
+                            // 生成模型数据
+                            ModelData model = ProcessModelJson(modelNamespace, modelId,
+                                rotationX, rotationY, uvlock, t, blockstateName);
                             multipartModels.push_back({ model, weight });
+                            ++t;
+                        }
+                    };
+                    if (part.apply->is_array()) {
+                        for (const auto& modelItem : *part.apply) {
+                            processApply(modelItem);
                         }
                     }
+                    else if (part.apply->is_object()) {
+                        processApply(*part.apply);
+                    }
 
                     if (!multipartModels.empty()) {
                         multipartModelsList.push_back(multipartModels);
@@ -524,19 +528,13 @@ void ProcessBlockstate(const std::string& namespaceName, const std::vector<std::
                 }
             }
             else {
-                // 如果所有 apply 均为对象,则按照原来的逻辑处理,合并模型后存入 BlockModelCache
+                // 如果所有 apply 均为对象,则合并模型后存入 BlockModelCache
                 std::vector<ModelData> selectedModels;
-                for (const auto& item : multipart) {
-                    if (!item.contains("apply"))
-                        continue;
-                    bool conditionMatched = true;
-                    if (item.contains("when")) {
-                        conditionMatched = matchConditions(blockConditions, item["when"]);
-                    }
-                    if (!conditionMatched)
+                for (const auto& part : compiled->multipart) {
+                    if (!MatchCondition(part.when, state))
                         continue;
 
-                    auto apply = item["apply"];
+                    const auto& apply = *part.apply;
                     int rotationX = 0, rotationY = 0;
                     bool uvlock = false;
                     if (apply.contains("x")) {
@@ -548,19 +546,14 @@ void ProcessBlockstate(const std::string& namespaceName, const std::vector<std::
                     if (apply.contains("uvlock")) {
                         uvlock = apply["uvlock"].get<bool>();
                     }
-                    std::string modelId = apply.contains("model") ? apply["model"].get<std::string>() : "";
-                    if (!modelId.empty()) {
-                        size_t colonPos = modelId.find(':');
-                        std::string modelNamespace = namespaceName;
-                        if (colonPos != std::string::npos) {
-                            modelNamespace = modelId.substr(0, colonPos);
-                            modelId = modelId.substr(colonPos + 1);
-                        }
+                    std::string modelNamespace, modelId;
+                    if (ParseModelReference(apply, namespaceName, modelNamespace, modelId)) {
                         ModelData selectedModel = ProcessModelJson(modelNamespace, modelId, rotationX, rotationY, uvlock, 0, blockstateName);
                         selectedModels.push_back(selectedModel);
                     }
                 }
                 // 合并多个模型
+                ModelData mergedModel;
                 if (!selectedModels.empty()) {
                     mergedModel = selectedModels[0];
                     for (size_t i = 1; i < selectedModels.size(); ++i) {
@@ -573,8 +566,6 @@ void ProcessBlockstate(const std::string& namespaceName, const std::vector<std::
                 }
             }
         }
-
-
     }
 }
 
@@ -598,3 +589,106 @@ void ProcessBlockstateForBlocks(const std::vector<Block>& blocks) {
     }
 
 }
+
+// --------------------------------------------------------------------------------
+// 方块状态异步编译队列
+// --------------------------------------------------------------------------------
+namespace {
+    // 加载区块时发现的新方块状态在此排队,由后台线程池并行编译;
+    // 生成模型前调用 WaitForBlockstateCompilation 等待全部完成
+    class BlockstateCompileQueue {
+    public:
+        ~BlockstateCompileQueue() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            taskCv.notify_all();
+            for (auto& worker : workers) {
+                if (worker.joinable()) worker.join();
+            }
+        }
+
+        void Begin() {
+            std::lock_guard<std::mutex> lock(mutex);
+            accepting = true;
+        }
+
+        void Enqueue(const Block& block) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!accepting) {
+                    // 队列已等待完毕(如生成模型时惰性加载区块),此后不会再有人等待,直接同步编译
+                    lock.unlock();
+                    ProcessBlockstateForBlocks({ block });
+                    return;
+                }
+                if (workers.empty()) {
+                    // 首次入队时启动线程池
+                    unsigned numThreads = std::max<unsigned>(1, std::thread::hardware_concurrency());
+                    for (unsigned i = 0; i < numThreads; ++i) {
+                        workers.emplace_back([this]() { WorkerLoop(); });
+                    }
+                }
+                pending.push_back(block);
+            }
+            taskCv.notify_one();
+        }
+
+        void Wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            idleCv.wait(lock, [this]() { return pending.empty() && inFlight == 0; });
+            accepting = false;
+        }
+
+    private:
+        void WorkerLoop() {
+            std::vector<Block> batch;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    if (!batch.empty()) {
+                        inFlight -= batch.size();
+                        batch.clear();
+                        if (pending.empty() && inFlight == 0) idleCv.notify_all();
+                    }
+                    taskCv.wait(lock, [this]() { return stopping || !pending.empty(); });
+                    if (pending.empty()) return; // stopping 且队列已清空
+
+                    // 每次取少量方块,减少锁竞争,同时保持各线程负载均衡
+                    size_t take = std::min<size_t>(pending.size(), 8);
+                    batch.assign(pending.begin(), pending.begin() + take);
+                    pending.erase(pending.begin(), pending.begin() + take);
+                    inFlight += take;
+                }
+                ProcessBlockstateForBlocks(batch);
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable taskCv;
+        std::condition_variable idleCv;
+        std::deque<Block> pending;
+        size_t inFlight = 0;
+        bool accepting = false; // 仅在 Begin 与 Wait 之间异步入队
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+
+    BlockstateCompileQueue& GetBlockstateCompileQueue() {
+        static BlockstateCompileQueue queue;
+        return queue;
+    }
+}
+
+void BeginBlockstateCompilation() {
+    GetBlockstateCompileQueue().Begin();
+}
+
+void EnqueueBlockstateCompile(const Block& block) {
+    GetBlockstateCompileQueue().Enqueue(block);
+}
+
+void WaitForBlockstateCompilation() {
+    GetBlockstateCompileQueue().Wait();
+}
@@ -32,10 +32,6 @@ extern std::unordered_map<std::string,
     std::unordered_map<std::string,
     std::vector<std::vector<WeightedModelData>>>> MultipartModelCache; // multipart部件缓存
 
-bool matchConditions(const std::unordered_map<std::string, std::string>& blockConditions, const nlohmann::json& when);
-
-std::string SortedVariantKey(const std::string& key);
-
 // --------------------------------------------------------------------------------
 // 核心函数声明
 // --------------------------------------------------------------------------------
@@ -43,6 +39,15 @@ void ProcessBlockstate(const std::string& namespaceName,const std::vector<std::s
 
 void ProcessBlockstateForBlocks(const std::vector<Block>& blocks);
 
+// 开始一轮异步编译(加载区块前调用);在此之外入队的方块状态将同步编译
+void BeginBlockstateCompilation();
+
+// 将新发现的方块状态加入异步编译队列,由后台线程池并行编译
+void EnqueueBlockstateCompile(const Block& block);
+
+// 等待队列中的方块状态全部编译完成(生成模型前调用)
+void WaitForBlockstateCompilation();
+
 // 获取方块状态 JSON 文件内容
 nlohmann::json GetBlockstateJson(const std::string& namespaceName,const std::string& blockId);
 
@@ -51,14 +51,42 @@ Config LoadConfig(const std::string& configFile) {
     config.LOD1renderDistance = j.value("LOD1renderDistance", config.LOD1renderDistance);
     config.LOD2renderDistance = j.value("LOD2renderDistance", config.LOD2renderDistance);
     config.LOD3renderDistance = j.value("LOD3renderDistance", config.LOD3renderDistance);
+    config.useHeightfieldLOD = j.value("useHeightfieldLOD", config.useHeightfieldLOD);
+    config.heightfieldMinLOD = j.value("heightfieldMinLOD", config.heightfieldMinLOD);
+    config.heightfieldErrorTolerance = j.value("heightfieldErrorTolerance", config.heightfieldErrorTolerance);
+    config.useLODBudget = j.value("useLODBudget", config.useLODBudget);
+    config.lodTriangleBudget = j.value("lodTriangleBudget", config.lodTriangleBudget);
+    config.lodByteBudget = j.value("lodByteBudget", config.lodByteBudget);
+    config.lodObjBytesPerFace = j.value("lodObjBytesPerFace", config.lodObjBytesPerFace);
+    config.useLODSimplify = j.value("useLODSimplify", config.useLODSimplify);
+    config.LOD2simplifyRatio = j.value("LOD2simplifyRatio", config.LOD2simplifyRatio);
+    config.LOD3simplifyRatio = j.value("LOD3simplifyRatio", config.LOD3simplifyRatio);
+    config.LOD4simplifyRatio = j.value("LOD4simplifyRatio", config.LOD4simplifyRatio);
+    config.LOD2simplifyError = j.value("LOD2simplifyError", config.LOD2simplifyError);
+    config.LOD3simplifyError = j.value("LOD3simplifyError", config.LOD3simplifyError);
+    config.LOD4simplifyError = j.value("LOD4simplifyError", config.LOD4simplifyError);
     config.useUnderwaterLOD = j.value("useUnderwaterLOD", config.useUnderwaterLOD);
     config.useGreedyMesh = j.value("useGreedyMesh", config.useGreedyMesh);
+    config.mergeFluidSurface = j.value("mergeFluidSurface", config.mergeFluidSurface);
     config.activeLOD = j.value("activeLOD", config.activeLOD);
     config.activeLOD2 = j.value("activeLOD2", config.activeLOD2);
     config.activeLOD3 = j.value("activeLOD3", config.activeLOD3);
     config.activeLOD4 = j.value("activeLOD4", config.activeLOD4);
     config.useBiomeColors = j.value("useBiomeColors", config.useBiomeColors);
+    config.lodColorPaletteSize = j.value("lodColorPaletteSize", config.lodColorPaletteSize);
+    config.lodColorQuantizeBits = j.value("lodColorQuantizeBits", config.lodColorQuantizeBits);
     config.useRandomBlockModels = j.value("useRandomBlockModels", config.useRandomBlockModels);
+    config.useAssetCache = j.value("useAssetCache", config.useAssetCache);
+    config.assetCacheDir = j.value("assetCacheDir", config.assetCacheDir);
+    config.asyncBlockstateCompile = j.value("asyncBlockstateCompile", config.asyncBlockstateCompile);
+    config.useTextureAtlas = j.value("useTextureAtlas", config.useTextureAtlas);
+    config.textureAtlasSize = j.value("textureAtlasSize", config.textureAtlasSize);
+    config.textureAtlasPadding = j.value("textureAtlasPadding", config.textureAtlasPadding);
+    config.textureWriteQueueSize = j.value("textureWriteQueueSize", config.textureWriteQueueSize);
+    config.cropAnimatedTextures = j.value("cropAnimatedTextures", config.cropAnimatedTextures);
+    config.animatedTextureFrame = j.value("animatedTextureFrame", config.animatedTextureFrame);
+    config.maxTextureSize = j.value("maxTextureSize", config.maxTextureSize);
+    config.optimizeVertexCache = j.value("optimizeVertexCache", config.optimizeVertexCache);
     
     // 读取LOD1级别使用原始模型的方块列表
     /*格式：
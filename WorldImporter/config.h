@@ -53,13 +53,41 @@ struct Config {
     int LOD1renderDistance;//LOD1 x1渲染距离
     int LOD2renderDistance;//LOD1 x2渲染距离
     int LOD3renderDistance;//LOD1 x4渲染距离
+    bool useHeightfieldLOD; //远景LOD使用高度场地形(仅加载地表Section)
+    float heightfieldMinLOD; //使用高度场地形的最小LOD等级
+    float heightfieldErrorTolerance; //高度场简化的高度误差容限(方块)
+    bool useLODBudget; //使用预算驱动的四叉树LOD选择(替代固定距离环)
+    size_t lodTriangleBudget; //LOD预算:导出三角形总数上限(0为不限制)
+    size_t lodByteBudget; //LOD预算:导出OBJ估算字节数上限(0为不限制)
+    double lodObjBytesPerFace; //LOD预算:每个面在OBJ中的平均字节数(顶点+UV+面),用于换算字节预算
+    bool useLODSimplify; //LOD>1的区块组使用二次误差网格简化(替代贪心网格合并)
+    float LOD2simplifyRatio; //LOD2 x2 简化目标三角形比例
+    float LOD3simplifyRatio; //LOD3 x4 简化目标三角形比例
+    float LOD4simplifyRatio; //LOD4 x8 简化目标三角形比例
+    float LOD2simplifyError; //LOD2 x2 简化允许的最大误差(方块)
+    float LOD3simplifyError; //LOD3 x4 简化允许的最大误差(方块)
+    float LOD4simplifyError; //LOD4 x8 简化允许的最大误差(方块)
     bool useUnderwaterLOD; //水下LOD模型生成
     bool useGreedyMesh; //是否使用GreedyMesh算法合并面
+    bool mergeFluidSurface; //是否合并同一Section内等高的流体顶面
     bool activeLOD2; // 是否启用LOD2
     bool activeLOD3; // 是否启用LOD3
     bool activeLOD4; // 是否启用LOD4
     bool useBiomeColors; // 是否启用群系颜色叠加
+    int lodColorPaletteSize; // LOD颜色调色板最大颜色数,超出后映射到最接近的已有颜色
+    int lodColorQuantizeBits; // LOD颜色每通道量化位数(1-8,8为不量化)
     bool useRandomBlockModels; // 是否使用随机方块模型
+    bool useAssetCache; // 是否使用持久化资源缓存(按归档路径/大小/修改时间失效)
+    std::string assetCacheDir; // 持久化资源缓存目录
+    bool asyncBlockstateCompile; // 是否在后台线程池并行编译新发现的方块状态(生成模型前统一等待)
+    bool useTextureAtlas; // 是否将非动态方块纹理打包为图集(启用时跳过GreedyMesh)
+    int textureAtlasSize; // 图集页边长(2的幂)
+    int textureAtlasPadding; // 图集中每张纹理四周的边缘扩展像素
+    int textureWriteQueueSize; // 异步纹理写出队列容量(文件数,队列满时阻塞提交方)
+    bool cropAnimatedTextures; // 是否将动态纹理裁剪为单帧导出(按普通材质处理)
+    int animatedTextureFrame; // 裁剪动态纹理时保留的帧序号(有 frames 序列时为序列下标)
+    int maxTextureSize; // 纹理最大边长,超出时按整数倍缩小(0为不限制)
+    bool optimizeVertexCache; // 导出前按材质组重排面和顶点以提高顶点缓存命中率
 
     bool exportFullModel;  // 是否完整导入
     int partitionSize; //分割大小
@@ -96,15 +124,43 @@ struct Config {
         LOD1renderDistance(6),
         LOD2renderDistance(6),
         LOD3renderDistance(6),
+        useHeightfieldLOD(false),
+        heightfieldMinLOD(8.0f),
+        heightfieldErrorTolerance(1.5f),
+        useLODBudget(false),
+        lodTriangleBudget(2000000),
+        lodByteBudget(0),
+        lodObjBytesPerFace(160.0),
+        useLODSimplify(false),
+        LOD2simplifyRatio(0.5f),
+        LOD3simplifyRatio(0.35f),
+        LOD4simplifyRatio(0.25f),
+        LOD2simplifyError(0.25f),
+        LOD3simplifyError(0.5f),
+        LOD4simplifyError(1.0f),
         useUnderwaterLOD(true),
         useGreedyMesh(false),
+        mergeFluidSurface(true),
         activeLOD(true),
         activeLOD2(true),
         activeLOD3(true),
         activeLOD4(true),
         lod1Blocks({}),
         useBiomeColors(true),
+        lodColorPaletteSize(4096),
+        lodColorQuantizeBits(8),
         useRandomBlockModels(true),
+        useAssetCache(true),
+        assetCacheDir("cache\\assets"),
+        asyncBlockstateCompile(true),
+        useTextureAtlas(false),
+        textureAtlasSize(4096),
+        textureAtlasPadding(1),
+        textureWriteQueueSize(256),
+        cropAnimatedTextures(false),
+        animatedTextureFrame(0),
+        maxTextureSize(0),
+        optimizeVertexCache(false),
         
 
         exportFullModel(false),
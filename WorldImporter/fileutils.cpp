@@ -122,6 +122,7 @@ void LoadFluidBlocks(const std::string& filepath) {
     else {
         throw std::runtime_error("Config missing 'fluids' array");
     }
+    BuildFluidBlockIndex();
 }
 
 void RegisterFluidTextures() {
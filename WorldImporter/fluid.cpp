@@ -6,15 +6,41 @@
 #include "block.h"
 #include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
+#include <memory>
 #include "model.h"
 
 using namespace std;
 
 // 流体注册数据
 std::unordered_map<std::string, FluidInfo> fluidDefinitions;
-// 模型缓存
-static std::unordered_map<int, ModelData> fluidModelCache;
-static std::mutex fluidModelCacheMutex; 
+std::unordered_set<std::string> fluidLiquidBlocks;
+std::vector<std::string> fluidStateProperties;
+// 模型缓存:键为精确打包的64位值(10个液位 + 流体类型ID),不会发生碰撞
+static std::unordered_map<uint64_t, std::shared_ptr<const ModelData>> fluidModelCache;
+static std::shared_mutex fluidModelCacheMutex;
+// 流体类型注册表:"命名空间:基础名" -> 紧凑类型ID
+static std::unordered_map<std::string, uint16_t> fluidTypeIds;
+static std::shared_mutex fluidTypeIdsMutex;
+
+// 缓存键布局:每个液位占5位(液位+2,覆盖-2~29),共50位;高14位存放流体类型ID
+constexpr int FLUID_LEVEL_BITS = 5;
+constexpr int FLUID_TYPE_BITS = 64 - FLUID_LEVEL_BITS * 10;
+constexpr uint64_t FLUID_LEVEL_MASK = (1ull << FLUID_LEVEL_BITS) - 1;
+constexpr size_t FLUID_TYPE_LIMIT = 1ull << FLUID_TYPE_BITS;
+
+void BuildFluidBlockIndex() {
+    fluidLiquidBlocks.clear();
+    fluidStateProperties.clear();
+    for (const auto& entry : fluidDefinitions) {
+        const FluidInfo& info = entry.second;
+        fluidLiquidBlocks.insert(info.liquid_blocks.begin(), info.liquid_blocks.end());
+        if (!info.property.empty() &&
+            std::find(fluidStateProperties.begin(), fluidStateProperties.end(), info.property) == fluidStateProperties.end()) {
+            fluidStateProperties.push_back(info.property);
+        }
+    }
+}
 
 float getHeight(int level) {
     if (level == 0)
@@ -99,7 +125,101 @@ float getCornerHeight(float currentHeight, float NWHeight, float NHeight, float
     return (totalWeight == 0.0f) ? 0.0f : res / totalWeight;
 }
 
-ModelData GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId) {
+// 获取流体类型ID,流体ID中的状态部分会被忽略(模型只与命名空间和基础名有关)
+static bool GetFluidTypeId(const std::string& fluidId, uint16_t& outId) {
+    // 线程本地缓存,稳定状态下无需加锁
+    thread_local std::unordered_map<std::string, uint16_t> localTypeIds;
+    auto localIt = localTypeIds.find(fluidId);
+    if (localIt != localTypeIds.end()) {
+        outId = localIt->second;
+        return true;
+    }
+
+    std::string typeName = fluidId.substr(0, fluidId.find('['));
+    if (typeName.find(':') == std::string::npos) {
+        typeName = "minecraft:" + typeName;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(fluidTypeIdsMutex);
+        auto it = fluidTypeIds.find(typeName);
+        if (it != fluidTypeIds.end()) {
+            outId = it->second;
+            localTypeIds.emplace(fluidId, outId);
+            return true;
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(fluidTypeIdsMutex);
+        auto it = fluidTypeIds.find(typeName);
+        if (it == fluidTypeIds.end()) {
+            if (fluidTypeIds.size() >= FLUID_TYPE_LIMIT) {
+                return false; // 类型ID已耗尽,调用方不使用缓存
+            }
+            it = fluidTypeIds.emplace(typeName, static_cast<uint16_t>(fluidTypeIds.size())).first;
+        }
+        outId = it->second;
+    }
+    localTypeIds.emplace(fluidId, outId);
+    return true;
+}
+
+// 将液位和流体类型打包为精确的缓存键,液位超出可编码范围时返回false
+static bool PackFluidModelKey(const std::array<int, 10>& fluidLevels, const std::string& fluidId, uint64_t& outKey) {
+    uint64_t key = 0;
+    for (int i = 0; i < 10; ++i) {
+        int encoded = fluidLevels[i] + 2;
+        if (encoded < 0 || encoded > static_cast<int>(FLUID_LEVEL_MASK)) {
+            return false;
+        }
+        key |= static_cast<uint64_t>(encoded) << (i * FLUID_LEVEL_BITS);
+    }
+
+    uint16_t typeId;
+    if (!GetFluidTypeId(fluidId, typeId)) {
+        return false;
+    }
+    outKey = key | (static_cast<uint64_t>(typeId) << (FLUID_LEVEL_BITS * 10));
+    return true;
+}
+
+static ModelData BuildFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId);
+
+std::shared_ptr<const ModelData> GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId) {
+    uint64_t key;
+    if (!PackFluidModelKey(fluidLevels, fluidId, key)) {
+        return std::make_shared<const ModelData>(BuildFluidModel(fluidLevels, fluidId));
+    }
+
+    // 线程本地缓存命中时完全无锁
+    thread_local std::unordered_map<uint64_t, std::shared_ptr<const ModelData>> localModelCache;
+    auto localIt = localModelCache.find(key);
+    if (localIt != localModelCache.end()) {
+        return localIt->second;
+    }
+
+    std::shared_ptr<const ModelData> model;
+    {
+        std::shared_lock<std::shared_mutex> lock(fluidModelCacheMutex);
+        auto it = fluidModelCache.find(key);
+        if (it != fluidModelCache.end()) {
+            model = it->second;
+        }
+    }
+
+    if (!model) {
+        // 在锁外生成模型,多个线程同时生成同一模型时以先写入者为准
+        auto built = std::make_shared<const ModelData>(BuildFluidModel(fluidLevels, fluidId));
+        std::unique_lock<std::shared_mutex> lock(fluidModelCacheMutex);
+        model = fluidModelCache.try_emplace(key, std::move(built)).first->second;
+    }
+
+    localModelCache.emplace(key, model);
+    return model;
+}
+
+static ModelData BuildFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId) {
     ModelData model;
 
     // 获取当前方块的液位和周围液位的高度
@@ -114,21 +234,6 @@ ModelData GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::
     int southwestLevel = fluidLevels[8]; // 西南
     int aboveLevel = fluidLevels[9];     // 上方
 
-    size_t key = 0;
-    for (int level : fluidLevels) {
-        key = (key << 3) ^ (level + (level << 5));
-    }
-    // 结合流体ID，确保不同流体类型有不同的缓存键值
-    key = key ^ std::hash<std::string>{}(fluidId);
-
-    // Lock the mutex to safely access the cache
-    std::lock_guard<std::mutex> lock(fluidModelCacheMutex);
-
-    // 检查缓存中是否存在该模型
-    if (fluidModelCache.find(key) != fluidModelCache.end()) {
-        return fluidModelCache[key]; // 返回缓存中的模型
-    }
-
     float currentHeight = getHeight(currentLevel);
     float northHeight = getHeight(northLevel);
     float southHeight = getHeight(southLevel);
@@ -421,7 +526,6 @@ ModelData GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::
 
     model.materials = { stillMaterial, flowMaterial };
 
-    fluidModelCache[key] = model;
     return model;
 }
 
@@ -6,6 +6,7 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <array>
+#include <memory>
 #include "model.h"
 
 // 流体定义信息结构
@@ -21,14 +22,21 @@ struct FluidInfo {
 // 全局流体定义数据
 extern std::unordered_map<std::string, FluidInfo> fluidDefinitions;
 
+// 流体方块快速索引(由 BuildFluidBlockIndex 从 fluidDefinitions 构建),Block 构造时无需遍历全部流体定义
+extern std::unordered_set<std::string> fluidLiquidBlocks;   // 所有流体的 liquid_blocks 并集(强制含水方块)
+extern std::vector<std::string> fluidStateProperties;       // 所有流体的识别属性(如 waterlogged),已去重
+
+// 重建流体方块快速索引(fluidDefinitions 变更后调用)
+void BuildFluidBlockIndex();
+
 // 获取流体高度的函数
 float getHeight(int level);
 
 // 计算角落高度的函数
 float getCornerHeight(float currentHeight, float NWHeight, float NHeight, float WHeight);
 
-// 使用fluidId和周围的液位生成流体模型
-ModelData GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId = "minecraft:water");
+// 使用fluidId和周围的液位生成流体模型(返回缓存中的共享只读模型)
+std::shared_ptr<const ModelData> GenerateFluidModel(const std::array<int, 10>& fluidLevels, const std::string& fluidId = "minecraft:water");
 
 // 为流体模型分配材质
 void AssignFluidMaterials(ModelData& model, const std::string& fluidId);
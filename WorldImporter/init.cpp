@@ -1,5 +1,6 @@
 #include "init.h"
 #include "RegionModelExporter.h"
+#include "texture.h"
 #include <thread>
 #include <iostream>
 
@@ -41,6 +42,10 @@ void init() {
     
     // 配置加载完成后，再初始化缓存
     InitializeAllCaches();
+    // LOD着色使用的纹理平均颜色直接从内存中的资源计算(纹理图集同样依赖该索引)
+    if (config.activeLOD || config.useTextureAtlas) {
+        BuildTextureAverageColors();
+    }
     LoadSolidBlocks(config.solidBlocksFile);
     LoadFluidBlocks(config.fluidsFile);
     RegisterFluidTextures();
@@ -11,6 +11,9 @@
 #include <omp.h>
 #include <chrono>
 #include <span>
+#include <shared_mutex>
+#include <memory>
+#include <algorithm>
 
 using namespace std::chrono;  
 
@@ -454,6 +457,12 @@ void ApplyDoublePositionOffset(ModelData& model, double x, double y, double z) {
 }
 
 //============== 模型数据处理模块 ==============//
+//---------------- 缓存管理 ----------------
+static std::shared_mutex modelCacheMutex;
+static std::unordered_map<std::string, ModelData> modelCache; // Key: "namespace:blockId:randomIndex"
+static std::recursive_mutex parentModelCacheMutex;
+static std::unordered_map<std::string, nlohmann::json> parentModelCache;
+
 //---------------- JSON处理 ----------------
 nlohmann::json LoadParentModel(const std::string& namespaceName, const std::string& blockId, nlohmann::json& currentModelJson) {
     // 如果当前模型没有 parent 属性,直接返回
@@ -589,642 +598,578 @@ nlohmann::json MergeModelJson(const nlohmann::json& parentModelJson, const nlohm
 }
 
 nlohmann::json GetModelJson(const std::string& namespaceName, const std::string& modelPath) {
-    std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-    // 按照 JAR 文件的加载顺序逐个查找
-    for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-        const std::string& modId = GlobalCache::jarOrder[i];
-        std::string cacheKey = modId + ":" + namespaceName + ":" + modelPath;
-        auto it = GlobalCache::models.find(cacheKey);
-        if (it != GlobalCache::models.end()) {
-            return it->second;
-        }
+    // 覆盖关系已在初始化时解析,直接查找生效版本(只读,无需加锁)
+    if (auto entry = GlobalCache::FindResolved(GlobalCache::resolvedModels, namespaceName, modelPath)) {
+        return entry->second;
     }
 
     std::cerr << "Model not found: " << namespaceName << ":" << modelPath << std::endl;
     return nlohmann::json();
 }
 
-//———————————将JSON数据转为结构体的方法———————————————
-//---------------- 材质处理 ----------------
-void processTextures(const nlohmann::json& modelJson, ModelData& data,
-    std::unordered_map<std::string, int>& textureKeyToMaterialIndex) {
+//———————————将JSON数据编译为模型中间表示———————————————
+// 编译后的模型缓存("命名空间:模型路径" -> IR),模型不存在时缓存空指针
+static std::unordered_map<std::string, std::shared_ptr<const CompiledModel>> compiledModelCache;
+static std::shared_mutex compiledModelCacheMutex;
+
+// 面名称 -> ModelFaceName,未知名称返回 FACE_NAME_COUNT
+static uint8_t ParseModelFaceName(const std::string& faceName) {
+    if (faceName == "north") return FACE_NORTH;
+    if (faceName == "south") return FACE_SOUTH;
+    if (faceName == "east") return FACE_EAST;
+    if (faceName == "west") return FACE_WEST;
+    if (faceName == "up") return FACE_UP;
+    if (faceName == "down") return FACE_DOWN;
+    return FACE_NAME_COUNT;
+}
 
-    std::unordered_map<std::string, int> processedMaterials; // 材质名称到索引的映射
+// 将合并了父模型链的JSON编译为IR
+static std::shared_ptr<const CompiledModel> CompileModelJson(const nlohmann::json& modelJson) {
+    auto compiled = std::make_shared<CompiledModel>();
+    compiled->hasElements = modelJson.contains("elements");
+    if (!compiled->hasElements) {
+        return compiled;
+    }
 
+    // 纹理变量(JSON对象按键名有序遍历)
     if (modelJson.contains("textures")) {
-        auto textures = modelJson["textures"];
-        for (auto& texture : textures.items()) {
-            std::string textureKey = texture.key();
-            std::string textureValue = texture.value();
-
-            // 解析命名空间和路径
-            size_t colonPos = textureValue.find(':');
-            std::string namespaceName = "minecraft";
-            std::string pathPart = textureValue;
-            if (colonPos != std::string::npos) {
-                namespaceName = textureValue.substr(0, colonPos);
-                pathPart = textureValue.substr(colonPos + 1);
-            }
+        for (auto& texture : modelJson["textures"].items()) {
+            compiled->textures.emplace_back(texture.key(), texture.value().get<std::string>());
+        }
+    }
+    auto findTextureSlot = [&](const std::string& textureKey) -> int {
+        for (size_t i = 0; i < compiled->textures.size(); ++i) {
+            if (compiled->textures[i].first == textureKey) return static_cast<int>(i);
+        }
+        return -1;
+    };
 
-            // ---- START MODIFIED CODE ----
-            // 检查 pathPart 是否有问题 (例如, 空, 以'/'结尾), 或者原始 textureKey 是否为 "missing"
-            if (textureKey == "missing" || pathPart.empty() || pathPart.back() == '/') {
-                std::string placeholderMaterialName = namespaceName + ":" + pathPart + (textureKey == "missing" ? "missing_placeholder" : "empty_path_placeholder");
-                
-                // 使用原始 textureKey 进行映射,确保唯一性
-                std::string uniqueMaterialKeyForMap = textureKey; 
-
-                if (processedMaterials.find(placeholderMaterialName) == processedMaterials.end()) {
-                    Material newMaterial;
-                    newMaterial.name = placeholderMaterialName;
-                    newMaterial.texturePath = ""; // 空路径表示缺失纹理
-                    newMaterial.tintIndex = -1;
-                    newMaterial.type = NORMAL;
-                    newMaterial.aspectRatio = 1.0f;
-                    
-                    int materialIndex = data.materials.size();
-                    data.materials.push_back(newMaterial);
-                    processedMaterials[placeholderMaterialName] = materialIndex;
-                    textureKeyToMaterialIndex[uniqueMaterialKeyForMap] = materialIndex;
-                } else {
-                    textureKeyToMaterialIndex[uniqueMaterialKeyForMap] = processedMaterials[placeholderMaterialName];
+    for (const auto& element : modelJson["elements"]) {
+        if (!element.contains("from") || !element.contains("to") || !element.contains("faces")) continue;
+
+        CompiledModelElement compiledElement;
+        const auto& from = element["from"];
+        const auto& to = element["to"];
+        for (int i = 0; i < 3; ++i) {
+            // 转换原始坐标为 OBJ 坐标系(/16)
+            compiledElement.from[i] = from[i].get<float>() / 16.0f;
+            compiledElement.to[i] = to[i].get<float>() / 16.0f;
+        }
+
+        if (element.contains("rotation")) {
+            const auto& rotation = element["rotation"];
+            std::string axis = rotation["axis"].get<std::string>();
+            compiledElement.rotationAxis = (axis == "x") ? 0 : (axis == "y") ? 1 : (axis == "z") ? 2 : -1;
+            compiledElement.angle = rotation["angle"].get<float>();
+            const auto& origin = rotation["origin"];
+            for (int i = 0; i < 3; ++i) {
+                compiledElement.origin[i] = origin[i].get<float>() / 16.0f;
+            }
+            compiledElement.rescale = rotation.value("rescale", false);
+        }
+
+        for (auto& face : element["faces"].items()) {
+            CompiledModelFace compiledFace;
+            compiledFace.name = ParseModelFaceName(face.key());
+            if (compiledFace.name == FACE_NAME_COUNT) continue;
+            const auto& faceData = face.value();
+
+            if (faceData.contains("texture")) {
+                std::string texture = faceData["texture"];
+                if (!texture.empty() && texture.front() == '#') texture.erase(0, 1);
+                compiledFace.hasTexture = true;
+                compiledFace.textureSlot = findTextureSlot(texture);
+                if (faceData.contains("uv")) {
+                    const auto& uv = faceData["uv"];
+                    compiledFace.hasUV = true;
+                    for (int i = 0; i < 4; ++i) {
+                        compiledFace.uv[i] = uv[i].get<float>();
+                    }
                 }
-                continue; // 跳过对此纹理条目的常规处理
+                compiledFace.rotation = faceData.value("rotation", 0);
+            }
+            compiledFace.cullface = faceData.contains("cullface")
+                ? StringToFaceType(faceData["cullface"].get<std::string>())
+                : FaceType::DO_NOT_CULL;
+            if (faceData.contains("tintindex")) {
+                compiledFace.tintIndex = static_cast<short>(faceData["tintindex"].get<int>());
             }
-            // ---- END MODIFIED CODE ----
+            compiledElement.faces.push_back(compiledFace);
+        }
+        compiled->elements.push_back(std::move(compiledElement));
+    }
+    return compiled;
+}
 
-            // 生成唯一材质标识
-            std::string fullMaterialName = namespaceName + ":" + pathPart;
+std::shared_ptr<const CompiledModel> GetCompiledModel(const std::string& namespaceName, const std::string& modelPath) {
+    std::string cacheKey = namespaceName + ":" + modelPath;
+    {
+        std::shared_lock<std::shared_mutex> lock(compiledModelCacheMutex);
+        auto it = compiledModelCache.find(cacheKey);
+        if (it != compiledModelCache.end()) {
+            return it->second;
+        }
+    }
 
-            // 检查是否已处理过该材质
-            if (processedMaterials.find(fullMaterialName) == processedMaterials.end()) {
-                // 生成缓存键
-                std::string cacheKey = namespaceName + ":" + pathPart;
+    // 锁外解析父模型链并编译,并发时可能重复编译,以先写入者为准
+    std::shared_ptr<const CompiledModel> compiled;
+    nlohmann::json modelJson = GetModelJson(namespaceName, modelPath);
+    if (!modelJson.is_null()) {
+        modelJson = LoadParentModel(namespaceName, modelPath, modelJson);
+        compiled = CompileModelJson(modelJson);
+    }
 
-                // 保存纹理并获取路径
-                std::string textureSavePath;
-                {
-                    std::lock_guard<std::mutex> lock(texturePathCacheMutex);
-                    auto cacheIt = texturePathCache.find(cacheKey);
-                    if (cacheIt != texturePathCache.end()) {
-                        textureSavePath = cacheIt->second;
-                    }
-                    else {
-                        std::string saveDir = "textures";
-                        SaveTextureToFile(namespaceName, pathPart, saveDir);
-                        textureSavePath = "textures/" + namespaceName+"/"+pathPart + ".png";
-                        // 调用注册材质的方法
-                        RegisterTexture(namespaceName, pathPart, textureSavePath);
-                    }
-                }
+    std::unique_lock<std::shared_mutex> lock(compiledModelCacheMutex);
+    return compiledModelCache.emplace(cacheKey, std::move(compiled)).first->second;
+}
 
-                // 记录材质信息
+//---------------- 材质处理 ----------------
+// 为每个纹理变量生成材质,slotToMaterial 记录纹理变量序号到材质索引的映射
+// 正在保存中的纹理(由 texturePathCacheMutex 保护),其它线程需等待保存完成后才能读取纹理尺寸
+static std::unordered_map<std::string, std::shared_future<void>> pendingTextureSaves;
+
+static void processTextures(const CompiledModel& model, ModelData& data, std::vector<int>& slotToMaterial) {
+
+    std::unordered_map<std::string, int> processedMaterials; // 材质名称到索引的映射
+    slotToMaterial.assign(model.textures.size(), -1);
+
+    for (size_t slot = 0; slot < model.textures.size(); ++slot) {
+        const std::string& textureKey = model.textures[slot].first;
+        const std::string& textureValue = model.textures[slot].second;
+
+        // 解析命名空间和路径
+        size_t colonPos = textureValue.find(':');
+        std::string namespaceName = "minecraft";
+        std::string pathPart = textureValue;
+        if (colonPos != std::string::npos) {
+            namespaceName = textureValue.substr(0, colonPos);
+            pathPart = textureValue.substr(colonPos + 1);
+        }
+
+        // 检查 pathPart 是否有问题 (例如, 空, 以'/'结尾), 或者原始 textureKey 是否为 "missing"
+        if (textureKey == "missing" || pathPart.empty() || pathPart.back() == '/') {
+            std::string placeholderMaterialName = namespaceName + ":" + pathPart + (textureKey == "missing" ? "missing_placeholder" : "empty_path_placeholder");
+
+            if (processedMaterials.find(placeholderMaterialName) == processedMaterials.end()) {
                 Material newMaterial;
-                newMaterial.name = fullMaterialName;
-                newMaterial.texturePath = textureSavePath;
-                newMaterial.tintIndex = -1;  // 默认值
-                
-                // 检测材质类型和长宽比(如果为动态材质)
-                float aspectRatio = 1.0f;
-                newMaterial.type = DetectMaterialType(namespaceName, pathPart, aspectRatio);
-                newMaterial.aspectRatio = aspectRatio;
-                
+                newMaterial.name = placeholderMaterialName;
+                newMaterial.texturePath = ""; // 空路径表示缺失纹理
+                newMaterial.tintIndex = -1;
+                newMaterial.type = NORMAL;
+                newMaterial.aspectRatio = 1.0f;
+
                 int materialIndex = data.materials.size();
                 data.materials.push_back(newMaterial);
-                processedMaterials[fullMaterialName] = materialIndex;
+                processedMaterials[placeholderMaterialName] = materialIndex;
             }
-
-            // 记录材质键到索引的映射
-            textureKeyToMaterialIndex[textureKey] = processedMaterials[fullMaterialName];
+            slotToMaterial[slot] = processedMaterials[placeholderMaterialName];
+            continue; // 跳过对此纹理条目的常规处理
         }
-    }
-}
-//---------------- 几何数据处理 ----------------
-void processElements(const nlohmann::json& modelJson, ModelData& data,
-    const std::unordered_map<std::string, int>& textureKeyToMaterialIndex)
-{
-    std::unordered_map<std::string, int> vertexCache;
-    std::unordered_map<std::string, int> uvCache;
-    int faceId = 0;
-    short tintindex = -1;
-    std::unordered_map<std::string, int> faceCountMap; // 面计数映射
-
-    auto elements = modelJson["elements"];
 
-    for (const auto& element : elements) {
-        if (element.contains("from") && element.contains("to") && element.contains("faces")) {
-            auto from = element["from"];
-            auto to = element["to"];
-            auto faces = element["faces"];
+        // 生成唯一材质标识
+        std::string fullMaterialName = namespaceName + ":" + pathPart;
 
+        // 检查是否已处理过该材质
+        if (processedMaterials.find(fullMaterialName) == processedMaterials.end()) {
+            // 生成缓存键
+            std::string cacheKey = namespaceName + ":" + pathPart;
 
-            // 转换原始坐标为 OBJ 坐标系(/16)
-            float x1 = from[0].get<float>() / 16.0f;
-            float y1 = from[1].get<float>() / 16.0f;
-            float z1 = from[2].get<float>() / 16.0f;
-            float x2 = to[0].get<float>() / 16.0f;
-            float y2 = to[1].get<float>() / 16.0f;
-            float z2 = to[2].get<float>() / 16.0f;
-            
-            // 检测是否为"极薄"块
-            constexpr float THIN_THRESHOLD = 0.01f; // 1/100 方块单位的阈值
-            bool isThinX = std::abs(x2 - x1) < THIN_THRESHOLD;
-            bool isThinY = std::abs(y2 - y1) < THIN_THRESHOLD;
-            bool isThinZ = std::abs(z2 - z1) < THIN_THRESHOLD;
-            
-            // 生成基础顶点数据
-            std::unordered_map<std::string, std::vector<std::vector<float>>> elementVertices;
-            
-            // 遍历元素的面,动态生成顶点数据
-            for (auto& face : faces.items()) { // 'faces' is from element["faces"]
-                std::string faceName = face.key();
-                if (faceName == "north") {
-                    elementVertices[faceName] = { {x1, y1, z1}, {x1, y2, z1}, {x2, y2, z1}, {x2, y1, z1} };
+            // 保存纹理并获取路径:加锁只用于在缓存中认领路径,解码与写出在锁外进行
+            std::string textureSavePath;
+            std::promise<void> savePromise;
+            std::shared_future<void> pendingSave;
+            bool claimed = false;
+            {
+                std::lock_guard<std::mutex> lock(texturePathCacheMutex);
+                auto cacheIt = texturePathCache.find(cacheKey);
+                if (cacheIt != texturePathCache.end()) {
+                    textureSavePath = cacheIt->second;
+                    auto pendingIt = pendingTextureSaves.find(cacheKey);
+                    if (pendingIt != pendingTextureSaves.end()) {
+                        pendingSave = pendingIt->second;
+                    }
                 }
-                else if (faceName == "south") {
-                    elementVertices[faceName] = { {x2, y1, z2}, {x2, y2, z2}, {x1, y2, z2}, {x1, y1, z2} };
+                else {
+                    textureSavePath = "textures/" + namespaceName + "/" + pathPart + ".png";
+                    texturePathCache[cacheKey] = textureSavePath;
+                    pendingTextureSaves[cacheKey] = savePromise.get_future().share();
+                    claimed = true;
                 }
-                else if (faceName == "east") {
-                    elementVertices[faceName] = { {x2, y1, z1}, {x2, y2, z1}, {x2, y2, z2}, {x2, y1, z2} };
+            }
+            if (claimed) {
+                if (config.useTextureAtlas) {
+                    // 图集模式下仅图集未能打包的纹理需要单独文件,由 TextureAtlas::RemapModel 按需写出
+                    DeferTextureSave(namespaceName, pathPart);
                 }
-                else if (faceName == "west") {
-                    elementVertices[faceName] = { {x1, y1, z2}, {x1, y2, z2}, {x1, y2, z1}, {x1, y1, z1} };
+                else {
+                    std::string saveDir = "textures";
+                    SaveTextureToFile(namespaceName, pathPart, saveDir);
                 }
-                else if (faceName == "up") {
-                    elementVertices[faceName] = { {x2, y2, z2}, {x2, y2, z1} ,{x1, y2, z1}, {x1, y2, z2}  };
+                savePromise.set_value();
+                std::lock_guard<std::mutex> lock(texturePathCacheMutex);
+                pendingTextureSaves.erase(cacheKey);
+            }
+            else if (pendingSave.valid()) {
+                // 其它线程正在保存该纹理,等待其记录纹理尺寸
+                pendingSave.wait();
+            }
+
+            // 记录材质信息
+            Material newMaterial;
+            newMaterial.name = fullMaterialName;
+            newMaterial.texturePath = textureSavePath;
+            newMaterial.tintIndex = -1;  // 默认值
+
+            // 检测材质类型和长宽比(如果为动态材质)
+            float aspectRatio = 1.0f;
+            newMaterial.type = DetectMaterialType(namespaceName, pathPart, aspectRatio);
+            newMaterial.aspectRatio = aspectRatio;
+
+            int materialIndex = data.materials.size();
+            data.materials.push_back(newMaterial);
+            processedMaterials[fullMaterialName] = materialIndex;
+        }
+
+        // 记录纹理变量到材质索引的映射
+        slotToMaterial[slot] = processedMaterials[fullMaterialName];
+    }
+}
+
+//---------------- 几何数据处理 ----------------
+// 面的几何指纹:量化后的法线(2位小数)与排序后的顶点坐标(4位小数)
+struct FaceFingerprint {
+    std::array<int, 15> values;
+    bool operator==(const FaceFingerprint&) const = default;
+};
+
+struct FaceFingerprintHasher {
+    size_t operator()(const FaceFingerprint& key) const {
+        size_t seed = 0;
+        for (int v : key.values) {
+            seed ^= std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+};
+
+static void processElements(const CompiledModel& model, ModelData& data, const std::vector<int>& slotToMaterial)
+{
+    using FaceVertices = std::array<std::array<float, 3>, 4>;
+    std::unordered_map<VertexKey, int> vertexCache;
+    std::unordered_map<UVKey, int> uvCache;
+    std::unordered_map<FaceFingerprint, int, FaceFingerprintHasher> faceCountMap; // 面计数映射
+
+    auto quantize = [](float value, float scale) { return static_cast<int>(std::lround(value * scale)); };
+
+    for (const auto& element : model.elements) {
+        float x1 = element.from[0], y1 = element.from[1], z1 = element.from[2];
+        float x2 = element.to[0], y2 = element.to[1], z2 = element.to[2];
+
+        // 生成基础顶点数据(按面名称索引)
+        std::array<FaceVertices, FACE_NAME_COUNT> elementVertices;
+        std::array<bool, FACE_NAME_COUNT> hasFace{};
+        for (const auto& face : element.faces) {
+            hasFace[face.name] = true;
+            switch (face.name) {
+            case FACE_NORTH: elementVertices[face.name] = { { {x1, y1, z1}, {x1, y2, z1}, {x2, y2, z1}, {x2, y1, z1} } }; break;
+            case FACE_SOUTH: elementVertices[face.name] = { { {x2, y1, z2}, {x2, y2, z2}, {x1, y2, z2}, {x1, y1, z2} } }; break;
+            case FACE_EAST:  elementVertices[face.name] = { { {x2, y1, z1}, {x2, y2, z1}, {x2, y2, z2}, {x2, y1, z2} } }; break;
+            case FACE_WEST:  elementVertices[face.name] = { { {x1, y1, z2}, {x1, y2, z2}, {x1, y2, z1}, {x1, y1, z1} } }; break;
+            case FACE_UP:    elementVertices[face.name] = { { {x2, y2, z2}, {x2, y2, z1}, {x1, y2, z1}, {x1, y2, z2} } }; break;
+            case FACE_DOWN:  elementVertices[face.name] = { { {x1, y1, z2}, {x1, y1, z1}, {x2, y1, z1}, {x2, y1, z2} } }; break;
+            }
+        }
+
+        // 处理元素旋转
+        if (element.rotationAxis >= 0) {
+            float ox = element.origin[0];
+            float oy = element.origin[1];
+            float oz = element.origin[2];
+            float angle_rad = element.angle * (M_PI / 180.0f); // 转换为弧度
+            float cosA = cos(angle_rad);
+            float sinA = sin(angle_rad);
+
+            // 处理rescale参数:22.5°或45°的整数倍时按对应因子缩放
+            float scale = 1.0f;
+            if (element.rescale) {
+                float angle_deg_conv = angle_rad * 180.0f / M_PI;
+                if (std::fabs(angle_deg_conv - 22.5f) < 1e-6 || std::fabs(angle_deg_conv + 22.5f) < 1e-6) {
+                    scale = std::sqrt(2.0f - std::sqrt(2.0f)); // 22.5°对应的缩放因子
                 }
-                else if (faceName == "down") {
-                    elementVertices[faceName] = {  {x1, y1, z2}, {x1, y1, z1}, {x2, y1, z1},{ x2, y1, z2 }};
+                else if (std::fabs(angle_deg_conv - 45.0f) < 1e-6 || std::fabs(angle_deg_conv + 45.0f) < 1e-6) {
+                    scale = std::sqrt(2.0f);           // 45°对应的缩放因子
                 }
             }
 
-            // 处理元素旋转
-            if (element.contains("rotation")) {
-                auto rotation = element["rotation"];
-                std::string axis = rotation["axis"].get<std::string>();
-
-                float angle_deg = rotation["angle"].get<float>();
-                auto origin = rotation["origin"];
-                // 转换旋转中心到 OBJ 坐标系
-                float ox = origin[0].get<float>() / 16.0f;
-                float oy = origin[1].get<float>() / 16.0f;
-                float oz = origin[2].get<float>() / 16.0f;
-                float angle_rad = angle_deg * (M_PI / 180.0f); // 转换为弧度
-                // 对每个面的顶点应用旋转
-                for (auto& faceEntry : elementVertices) {
-                    auto& vertices = faceEntry.second;
-                    for (auto& vertex : vertices) {
-                        float& vx = vertex[0];
-                        float& vy = vertex[1];
-                        float& vz = vertex[2];
-
-                        // 平移至旋转中心相对坐标
-                        float tx = vx - ox;
-                        float ty = vy - oy;
-                        float tz = vz - oz;
-
-                        // 根据轴类型进行旋转
-                        if (axis == "x") {
-                            // 绕X轴旋转
-                            float new_y = ty * cos(angle_rad) - tz * sin(angle_rad);
-                            float new_z = ty * sin(angle_rad) + tz * cos(angle_rad);
-                            ty = new_y;
-                            tz = new_z;
-                        }
-                        else if (axis == "y") {
-                            // 绕Y轴旋转
-                            float new_x = tx * cos(angle_rad) + tz * sin(angle_rad);
-                            float new_z = -tx * sin(angle_rad) + tz * cos(angle_rad);
-                            tx = new_x;
-                            tz = new_z;
-                        }
-                        else if (axis == "z") {
-                            // 绕Z轴旋转
-                            float new_x = tx * cos(angle_rad) - ty * sin(angle_rad);
-                            float new_y = tx * sin(angle_rad) + ty * cos(angle_rad);
-                            tx = new_x;
-                            ty = new_y;
-                        }
-
-                        // 平移回原坐标系
-                        vx = tx + ox;
-                        vy = ty + oy;
-                        vz = tz + oz;
+            for (int f = 0; f < FACE_NAME_COUNT; ++f) {
+                if (!hasFace[f]) continue;
+                for (auto& vertex : elementVertices[f]) {
+                    // 平移至旋转中心相对坐标
+                    float tx = vertex[0] - ox;
+                    float ty = vertex[1] - oy;
+                    float tz = vertex[2] - oz;
+
+                    // 根据轴类型进行旋转和缩放
+                    if (element.rotationAxis == 0) {
+                        float new_y = ty * cosA - tz * sinA;
+                        float new_z = ty * sinA + tz * cosA;
+                        ty = new_y * scale;
+                        tz = new_z * scale;
                     }
-                }
-
-                // 处理rescale参数
-                // 在旋转处理部分的缩放逻辑修改如下:
-                bool rescale = rotation.value("rescale", false);
-                if (rescale) {
-                    // 将原始角度转回度数进行比较
-                    float angle_deg_conv = angle_rad * 180.0f / M_PI;
-                    bool applyScaling = false;
-                    float scale = 1.0f;
-
-                    // 检查是否为22.5°或45°的整数倍(考虑浮点精度)
-                    if (std::fabs(angle_deg_conv - 22.5f) < 1e-6 || std::fabs(angle_deg_conv + 22.5f) < 1e-6) {
-                        applyScaling = true;
-                        scale = std::sqrt(2.0f - std::sqrt(2.0f)); // 22.5°对应的缩放因子
+                    else if (element.rotationAxis == 1) {
+                        float new_x = tx * cosA + tz * sinA;
+                        float new_z = -tx * sinA + tz * cosA;
+                        tx = new_x * scale;
+                        tz = new_z * scale;
                     }
-                    else if (std::fabs(angle_deg_conv - 45.0f) < 1e-6 || std::fabs(angle_deg_conv + 45.0f) < 1e-6) {
-                        applyScaling = true;
-                        scale = std::sqrt(2.0f);           // 45°对应的缩放因子
+                    else {
+                        float new_x = tx * cosA - ty * sinA;
+                        float new_y = tx * sinA + ty * cosA;
+                        tx = new_x * scale;
+                        ty = new_y * scale;
                     }
 
-                    if (applyScaling) {
-                        // 根据旋转轴应用缩放,保留原有旋转中心偏移逻辑
-                        for (auto& faceEntry : elementVertices) {
-                            auto& vertices = faceEntry.second;
-                            for (auto& vertex : vertices) {
-                                float& vx = vertex[0];
-                                float& vy = vertex[1];
-                                float& vz = vertex[2];
-
-                                // 平移至旋转中心相对坐标系
-                                float tx = vx - ox;
-                                float ty = vy - oy;
-                                float tz = vz - oz;
-
-                                // 根据轴类型应用缩放
-                                if (axis == "x") {
-                                    ty *= scale;
-                                    tz *= scale;
-                                }
-                                else if (axis == "y") {
-                                    tx *= scale;
-                                    tz *= scale;
-                                }
-                                else if (axis == "z") {
-                                    tx *= scale;
-                                    ty *= scale;
-                                }
-
-                                // 平移回原坐标系
-                                vx = tx + ox;
-                                vy = ty + oy;
-                                vz = tz + oz;
-                            }
-                        }
+                    // 平移回原坐标系
+                    vertex[0] = tx + ox;
+                    vertex[1] = ty + oy;
+                    vertex[2] = tz + oz;
+                }
+            }
+        }
+
+        // 检测并移除相反方向的重叠面(保留 north/east/up)
+        auto areFacesCoinciding = [&](const FaceVertices& face1, const FaceVertices& face2) {
+            for (const auto& v : face2) {
+                bool found = false;
+                for (const auto& u : face1) {
+                    if (quantize(u[0], 10000.0f) == quantize(v[0], 10000.0f) &&
+                        quantize(u[1], 10000.0f) == quantize(v[1], 10000.0f) &&
+                        quantize(u[2], 10000.0f) == quantize(v[2], 10000.0f)) {
+                        found = true;
+                        break;
                     }
                 }
+                if (!found) return false;
             }
+            return true;
+        };
+        constexpr std::array<std::pair<uint8_t, uint8_t>, 3> kOppositePairs = { {
+            {FACE_NORTH, FACE_SOUTH}, {FACE_EAST, FACE_WEST}, {FACE_UP, FACE_DOWN}
+        } };
+        for (const auto& [keep, remove] : kOppositePairs) {
+            if (hasFace[keep] && hasFace[remove] &&
+                areFacesCoinciding(elementVertices[keep], elementVertices[remove]) &&
+                areFacesCoinciding(elementVertices[remove], elementVertices[keep])) {
+                hasFace[remove] = false;
+            }
+        }
+
+        // 遍历每个面的数据,判断面是否存在,如果存在则处理
+        for (const auto& face : element.faces) {
+            if (!hasFace[face.name]) continue;
 
-            // --- 新增:检测并移除相反方向的重叠面 ---
-            auto getOppositeFace = [](const std::string& faceName) -> std::string {
-                if (faceName == "north") return "south";
-                if (faceName == "south") return "north";
-                if (faceName == "east") return "west";
-                if (faceName == "west") return "east";
-                if (faceName == "up") return "down";
-                if (faceName == "down") return "up";
-                return "";
-                };
-
-            auto areFacesCoinciding = [](const std::vector<std::vector<float>>& face1,
-                const std::vector<std::vector<float>>& face2) -> bool {
-                    if (face1.size() != face2.size()) return false;
-
-                    auto toKey = [](const std::vector<float>& v) {
-                        char buffer[64];
-                        snprintf(buffer, sizeof(buffer), "%.4f,%.4f,%.4f", v[0], v[1], v[2]);
-                        return std::string(buffer);
-                        };
-
-                    std::unordered_set<std::string> set1;
-                    for (const auto& v : face1) set1.insert(toKey(v));
-                    for (const auto& v : face2) {
-                        if (!set1.count(toKey(v))) return false;
+            // 处理当前面
+            FaceVertices faceVertices = elementVertices[face.name];
+
+            // ======== 面重叠处理逻辑 ========
+            {
+                // 计算法线方向
+                const auto& v0 = faceVertices[0];
+                const auto& v1 = faceVertices[1];
+                const auto& v2 = faceVertices[2];
+
+                float vec1x = v1[0] - v0[0];
+                float vec1y = v1[1] - v0[1];
+                float vec1z = v1[2] - v0[2];
+                float vec2x = v2[0] - v0[0];
+                float vec2y = v2[1] - v0[1];
+                float vec2z = v2[2] - v0[2];
+
+                float crossX = vec1y * vec2z - vec1z * vec2y;
+                float crossY = vec1z * vec2x - vec1x * vec2z;
+                float crossZ = vec1x * vec2y - vec1y * vec2x;
+
+                float length = std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ);
+                if (length > 0) {
+                    crossX /= length;
+                    crossY /= length;
+                    crossZ /= length;
+                }
+
+                // 将法线方向四舍五入到两位小数
+                crossX = std::round(crossX * 100.0f) / 100.0f;
+                crossY = std::round(crossY * 100.0f) / 100.0f;
+                crossZ = std::round(crossZ * 100.0f) / 100.0f;
+
+                // 生成面的几何指纹:法线 + 排序后的全部顶点(相同的面即使顶点顺序不同也有相同的键)
+                std::array<std::array<int, 3>, 4> sortedVertices;
+                for (int i = 0; i < 4; ++i) {
+                    sortedVertices[i] = { quantize(faceVertices[i][0], 10000.0f),
+                        quantize(faceVertices[i][1], 10000.0f), quantize(faceVertices[i][2], 10000.0f) };
+                }
+                std::sort(sortedVertices.begin(), sortedVertices.end());
+
+                FaceFingerprint key;
+                key.values[0] = quantize(crossX, 100.0f);
+                key.values[1] = quantize(crossY, 100.0f);
+                key.values[2] = quantize(crossZ, 100.0f);
+                for (int i = 0; i < 4; ++i) {
+                    for (int c = 0; c < 3; ++c) {
+                        key.values[3 + i * 3 + c] = sortedVertices[i][c];
                     }
-                    return true;
-                };
+                }
 
-            // 用于记录需要覆盖 uv 的信息
-            std::vector<std::string> facesToRemove;
-            // 创建映射,记录哪个面被哪个面替代,键是被移除的面名称,值是保留的面名称
-            std::unordered_map<std::string, std::string> faceReplacementMap;
-            
-            for (const auto& faceEntry : elementVertices) {
-                const std::string& faceName = faceEntry.first;
-                std::string opposite = getOppositeFace(faceName);
-                auto oppositeIt = elementVertices.find(opposite);
-
-                // 反向面存在且重叠时才移除
-                if (oppositeIt != elementVertices.end()) {
-                    if (areFacesCoinciding(faceEntry.second, oppositeIt->second)) {
-                        // 根据 faceName 判断移除哪一面
-                        if (faceName == "south" || faceName == "west" || faceName == "down") {
-                            facesToRemove.push_back(faceName);
-                            faceReplacementMap[faceName] = opposite; // 记录面替换关系
-                        }
-                        else {
-                            facesToRemove.push_back(opposite);
-                            faceReplacementMap[opposite] = faceName; // 记录面替换关系
-                        }
+                if (config.allowDoubleFace) {
+                    int count = ++faceCountMap[key];
+                    float offset = (count - 1) * 0.001f;
+                    for (auto& v : faceVertices) {
+                        v[0] += crossX * offset;
+                        v[1] += crossY * offset;
+                        v[2] += crossZ * offset;
                     }
                 }
+                else if (faceCountMap[key]++ >= 1) {
+                    continue;
+                }
             }
 
-            // 去重并移除面
-            std::sort(facesToRemove.begin(), facesToRemove.end());
-            auto last = std::unique(facesToRemove.begin(), facesToRemove.end());
-            facesToRemove.erase(last, facesToRemove.end());
-            for (const auto& face : facesToRemove) {
-                elementVertices.erase(face);
+            // ======== 顶点处理逻辑 ========
+            std::array<int, 4> vertexIndices;
+            for (int i = 0; i < 4; ++i) {
+                const auto& vertex = faceVertices[i];
+                VertexKey vertexKey{ quantize(vertex[0], 1000000.0f), quantize(vertex[1], 1000000.0f), quantize(vertex[2], 1000000.0f) };
+
+                auto [it, inserted] = vertexCache.try_emplace(vertexKey, static_cast<int>(data.vertices.size() / 3));
+                if (inserted) {
+                    data.vertices.insert(data.vertices.end(), { vertex[0], vertex[1], vertex[2] });
+                }
+                vertexIndices[i] = it->second;
             }
 
-            // 遍历每个面的数据,判断面是否存在,如果存在则处理
-            for (auto& face : faces.items()) {
-                std::string faceName = face.key();
-                
-                if (elementVertices.find(faceName) != elementVertices.end()) {
-                    // 处理当前面
-                    auto faceVertices = elementVertices[faceName];
-                    
-                    // ======== 面重叠处理逻辑 ========
-                    if (faceVertices.size() >= 3) {
-                        // 计算法线方向
-                        const auto& v0 = faceVertices[0];
-                        const auto& v1 = faceVertices[1];
-                        const auto& v2 = faceVertices[2];
-
-                        float vec1x = v1[0] - v0[0];
-                        float vec1y = v1[1] - v0[1];
-                        float vec1z = v1[2] - v0[2];
-                        float vec2x = v2[0] - v0[0];
-                        float vec2y = v2[1] - v0[1];
-                        float vec2z = v2[2] - v0[2];
-
-                        float crossX = vec1y * vec2z - vec1z * vec2y;
-                        float crossY = vec1z * vec2x - vec1x * vec2z;
-                        float crossZ = vec1x * vec2y - vec1y * vec2x;
-
-                        float length = std::sqrt(crossX * crossX + crossY * crossY + crossZ * crossZ);
-                        if (length > 0) {
-                            crossX /= length;
-                            crossY /= length;
-                            crossZ /= length;
-                        }
-
-                        // 将法线方向四舍五入到两位小数
-                        crossX = std::round(crossX * 100.0f) / 100.0f;
-                        crossY = std::round(crossY * 100.0f) / 100.0f;
-                        crossZ = std::round(crossZ * 100.0f) / 100.0f;
-
-                        // 生成面的几何特征指纹
-                        // 使用所有顶点坐标而不仅仅是中心点
-                        std::stringstream vertexStream;
-                        vertexStream << std::fixed << std::setprecision(4);
-                        
-                        // 按照几何坐标排序,以确保相同的面(即使顶点顺序不同)有相同的键
-                        std::vector<std::string> vertexKeys;
-                        for (const auto& v : faceVertices) {
-                            std::stringstream vs;
-                            vs << std::fixed << std::setprecision(4)
-                               << v[0] << "," << v[1] << "," << v[2];
-                            vertexKeys.push_back(vs.str());
-                        }
-                        std::sort(vertexKeys.begin(), vertexKeys.end());
-                        
-                        // 创建基于所有顶点的键
-                        std::string vertexFingerprint;
-                        for (const auto& vk : vertexKeys) {
-                            if (!vertexFingerprint.empty()) {
-                                vertexFingerprint += "|";
-                            }
-                            vertexFingerprint += vk;
-                        }
-                        
-                        // 组合法线和顶点指纹作为面的唯一标识
-                        std::stringstream keyStream;
-                        keyStream << std::fixed << std::setprecision(2)
-                            << crossX << "," << crossY << "," << crossZ << "_"
-                            << vertexFingerprint;
-                        std::string key = keyStream.str();
-
-                        bool skipFace = false;
-                        if (config.allowDoubleFace) {
-                            int count = ++faceCountMap[key];
-                            float offset = (count - 1) * 0.001f;
-                            for (auto& v : faceVertices) {
-                                v[0] += crossX * offset;
-                                v[1] += crossY * offset;
-                                v[2] += crossZ * offset;
-                            }
-                        }
-                        else {
-                            if (faceCountMap[key]++ >= 1) {
-                                skipFace = true;
-                            }
-                        }
-
-                        if (skipFace) {
-                            continue;
-                        }
-
-                        elementVertices[faceName] = faceVertices;
-                    }
+            Face newFace;
+            newFace.vertexIndices = vertexIndices;
+            newFace.uvIndices = { 0, 0, 0, 0 };
+            newFace.materialIndex = -1;
+            newFace.faceDirection = face.cullface;
+
+            if (face.hasTexture) {
+                if (face.textureSlot >= 0) {
+                    newFace.materialIndex = slotToMaterial[face.textureSlot];
+                }
 
-                    // ======== 顶点处理逻辑 ========
-                    std::array<int, 4> vertexIndices;
-                    for (int i = 0; i < 4; ++i) {
-                        const auto& vertex = faceVertices[i];
-                        std::string vertexKey =
-                            std::to_string(vertex[0]) + "," +
-                            std::to_string(vertex[1]) + "," +
-                            std::to_string(vertex[2]);
-
-                        if (vertexCache.find(vertexKey) == vertexCache.end()) {
-                            vertexCache[vertexKey] = data.vertices.size() / 3;
-                            data.vertices.insert(data.vertices.end(),
-                                { vertex[0], vertex[1], vertex[2] });
-                        }
-                        vertexIndices[i] = vertexCache[vertexKey];
-                    }
+                // UV数据处理
+                std::array<float, 4> uvRegion{};
+                switch (face.name) {
+                case FACE_DOWN:  uvRegion = { x1 * 16, (1 - z2) * 16, x2 * 16, (1 - z1) * 16 }; break;
+                case FACE_UP:    uvRegion = { x1 * 16, z1 * 16, x2 * 16, z2 * 16 }; break;
+                case FACE_NORTH: uvRegion = { (1 - x2) * 16, (1 - y2) * 16, (1 - x1) * 16, (1 - y1) * 16 }; break;
+                case FACE_SOUTH: uvRegion = { x1 * 16, (1 - y2) * 16, x2 * 16, (1 - y1) * 16 }; break;
+                case FACE_WEST:  uvRegion = { z1 * 16, (1 - y2) * 16, z2 * 16, (1 - y1) * 16 }; break;
+                case FACE_EAST:  uvRegion = { (1 - z2) * 16, (1 - y2) * 16, (1 - z1) * 16, (1 - y1) * 16 }; break;
+                }
 
-                    Face newFace;
-                    newFace.vertexIndices = vertexIndices;
-                    newFace.materialIndex = -1;
-                    newFace.faceDirection = StringToFaceType("DO_NOT_CULL");
-                    data.faces.push_back(newFace);
-
-                    if (face.value().contains("texture")) {
-                        std::string texture = face.value()["texture"];
-                        if (texture.front() == '#') texture.erase(0, 1);
-
-                        auto it = textureKeyToMaterialIndex.find(texture);
-                        if (it != textureKeyToMaterialIndex.end()) {
-                            data.faces.back().materialIndex = it->second;
-                        }
-                        
-                        // UV数据处理
-                        nlohmann::json faceData = face.value();
-                        
-                        std::vector<float> uvRegion;
-                        if (faceName == "down")
-                        {
-                            uvRegion = { x1 * 16, (1 - z2) * 16, x2 * 16, (1 - z1) * 16 };
-                        }
-                        else if (faceName == "up")
-                        {
-                            uvRegion = { x1 * 16, z1 * 16, x2 * 16, z2 * 16 };
-                        }
-                        else if (faceName == "north")
-                        {
-                            uvRegion = { (1 - x2) * 16, (1 - y2) * 16, (1 - x1) * 16, (1 - y1) * 16 };
-                        }
-                        else if (faceName == "south")
-                        {
-                            uvRegion = { x1 * 16, (1 - y2) * 16, x2 * 16, (1 - y1) * 16 };
-                        }
-                        else if (faceName == "west")
-                        {
-                            uvRegion = { z1 * 16, (1 - y2) * 16, z2 * 16, (1 - y1) * 16 };
-                        }
-                        else if (faceName == "east")
-                        {
-                            uvRegion = { (1 - z2) * 16, (1 - y2) * 16, (1 - z1) * 16, (1 - y1) * 16 };
-                        }
-
-                        // 如果 JSON 中存在 uv 则使用其数据
-                        if (faceData.contains("uv")) {
-                            auto uv = faceData["uv"];
-                           
-                            uvRegion = {
-                                uv[0].get<float>(),
-                                uv[1].get<float>(),
-                                uv[2].get<float>(),
-                                uv[3].get<float>()
-                            };
-                        }
-                  
-                        std::array<int, 4> uvIndices;
-                        
-                        // 检测UV区域是否有镜像翻转
-                        bool flipX = uvRegion[0] > uvRegion[2]; // X方向镜像
-                        bool flipY = uvRegion[1] > uvRegion[3]; // Y方向镜像
-                        
-                        // 确保UV坐标范围正确(起点小于终点)
-                        if (flipX) {
-                            std::swap(uvRegion[0], uvRegion[2]);
-                        }
-                        if (flipY) {
-                            std::swap(uvRegion[1], uvRegion[3]);
-                        }
-                        
-                        // 计算四个 UV 坐标点(左下,左上,右上,右下)
-                        std::vector<std::vector<float>> uvCoords = {
-                            {uvRegion[2] / 16.0f, 1 - uvRegion[3] / 16.0f},
-                            {uvRegion[2] / 16.0f, 1 - uvRegion[1] / 16.0f},
-                            {uvRegion[0] / 16.0f, 1 - uvRegion[1] / 16.0f},
-                            {uvRegion[0] / 16.0f, 1 - uvRegion[3] / 16.0f}
-                        };
-
-                        // 检查材质类型，如果是动态材质，应用长宽比缩放V坐标
-                        if (data.faces.back().materialIndex >= 0 && 
-                            data.faces.back().materialIndex < data.materials.size() && 
-                            data.materials[data.faces.back().materialIndex].type == ANIMATED) {
-                            
-                            float aspectRatio = data.materials[data.faces.back().materialIndex].aspectRatio;
-                            
-                            // 只缩放v坐标
-                            for (auto& uv : uvCoords) {
-                                // 转换v坐标，确保每个动画帧只显示一帧的内容
-                                float v = 1.0f - uv[1]; // v是倒置的，先转回来
-                                v = v / aspectRatio;    // 缩放到对应帧的范围
-                                uv[1] = 1.0f - v;       // 转回UV坐标系
-                            }
-                        }
-                        
-                        // 应用镜像翻转(如果需要)
-                        if (flipX) {
-                            // 水平镜像:交换左右顶点
-                            std::swap(uvCoords[0], uvCoords[3]); // 交换左下和右下
-                            std::swap(uvCoords[1], uvCoords[2]); // 交换左上和右上
-                        }
-                        if (flipY) {
-                            // 垂直镜像:交换上下顶点
-                            std::swap(uvCoords[0], uvCoords[1]); // 交换左下和左上
-                            std::swap(uvCoords[3], uvCoords[2]); // 交换右下和右上
-                        }
-
-                        // 获取旋转值
-                        int rotation = faceData.value("rotation", 0);                        
-                        int steps = ((rotation % 360) + 360) % 360 / 90;
-
-                        if (steps != 0) {
-                            std::vector<std::vector<float>> rotatedUV(4);
-                            for (int i = 0; i < 4; i++) {
-                                rotatedUV[i] = uvCoords[(i - steps + 4) % 4];
-                            }
-                            uvCoords = rotatedUV;
-                        }
-
-                        for (int i = 0; i < 4; ++i) {
-                            const auto& uv = uvCoords[i];
-                            std::string uvKey =
-                                std::to_string(uv[0]) + "," +
-                                std::to_string(uv[1]);
-
-                            if (uvCache.find(uvKey) == uvCache.end()) {
-                                uvCache[uvKey] = data.uvCoordinates.size() / 2;
-                                data.uvCoordinates.insert(data.uvCoordinates.end(),
-                                    { uv[0], uv[1] });
-                            }
-                            uvIndices[i] = uvCache[uvKey];
-                        }
-
-                        data.faces.back().uvIndices = uvIndices;
-                    }
+                // 如果模型中存在 uv 则使用其数据
+                if (face.hasUV) {
+                    uvRegion = face.uv;
+                }
 
-                    std::string faceDirection;
-                    if (face.value().contains("cullface")) {
-                        faceDirection = face.value()["cullface"].get<std::string>();
-                    }
-                    else {
-                        faceDirection = "DO_NOT_CULL";
+                // 检测UV区域是否有镜像翻转
+                bool flipX = uvRegion[0] > uvRegion[2]; // X方向镜像
+                bool flipY = uvRegion[1] > uvRegion[3]; // Y方向镜像
+
+                // 确保UV坐标范围正确(起点小于终点)
+                if (flipX) {
+                    std::swap(uvRegion[0], uvRegion[2]);
+                }
+                if (flipY) {
+                    std::swap(uvRegion[1], uvRegion[3]);
+                }
+
+                // 计算四个 UV 坐标点(左下,左上,右上,右下)
+                std::array<std::array<float, 2>, 4> uvCoords = { {
+                    {uvRegion[2] / 16.0f, 1 - uvRegion[3] / 16.0f},
+                    {uvRegion[2] / 16.0f, 1 - uvRegion[1] / 16.0f},
+                    {uvRegion[0] / 16.0f, 1 - uvRegion[1] / 16.0f},
+                    {uvRegion[0] / 16.0f, 1 - uvRegion[3] / 16.0f}
+                } };
+
+                // 检查材质类型，如果是动态材质，应用长宽比缩放V坐标
+                if (newFace.materialIndex >= 0 &&
+                    newFace.materialIndex < data.materials.size() &&
+                    data.materials[newFace.materialIndex].type == ANIMATED) {
+
+                    float aspectRatio = data.materials[newFace.materialIndex].aspectRatio;
+
+                    // 只缩放v坐标
+                    for (auto& uv : uvCoords) {
+                        // 转换v坐标，确保每个动画帧只显示一帧的内容
+                        float v = 1.0f - uv[1]; // v是倒置的，先转回来
+                        v = v / aspectRatio;    // 缩放到对应帧的范围
+                        uv[1] = 1.0f - v;       // 转回UV坐标系
                     }
-                    
-                    short localTintIndex = -1;
-                    if (face.value().contains("tintindex")) {
-                        localTintIndex = face.value()["tintindex"].get<int>();
+                }
+
+                // 应用镜像翻转(如果需要)
+                if (flipX) {
+                    // 水平镜像:交换左右顶点
+                    std::swap(uvCoords[0], uvCoords[3]); // 交换左下和右下
+                    std::swap(uvCoords[1], uvCoords[2]); // 交换左上和右上
+                }
+                if (flipY) {
+                    // 垂直镜像:交换上下顶点
+                    std::swap(uvCoords[0], uvCoords[1]); // 交换左下和左上
+                    std::swap(uvCoords[3], uvCoords[2]); // 交换右下和右上
+                }
+
+                // 应用UV旋转
+                int steps = ((face.rotation % 360) + 360) % 360 / 90;
+                if (steps != 0) {
+                    auto rotatedUV = uvCoords;
+                    for (int i = 0; i < 4; i++) {
+                        rotatedUV[i] = uvCoords[(i - steps + 4) % 4];
                     }
-                    // 更新此材质的tintIndex
-                    if (!data.materials.empty() && data.faces.back().materialIndex >= 0 && data.faces.back().materialIndex < data.materials.size()) {
-                        data.materials[data.faces.back().materialIndex].tintIndex = localTintIndex;
+                    uvCoords = rotatedUV;
+                }
+
+                for (int i = 0; i < 4; ++i) {
+                    const auto& uv = uvCoords[i];
+                    UVKey uvKey{ quantize(uv[0], 1000000.0f), quantize(uv[1], 1000000.0f) };
+
+                    auto [it, inserted] = uvCache.try_emplace(uvKey, static_cast<int>(data.uvCoordinates.size() / 2));
+                    if (inserted) {
+                        data.uvCoordinates.insert(data.uvCoordinates.end(), { uv[0], uv[1] });
                     }
-                    
-                    // 将字符串方向转换为枚举类型并添加到faceDirections
-                    data.faces.back().faceDirection = StringToFaceType(faceDirection);
-                    faceId++;
+                    newFace.uvIndices[i] = it->second;
                 }
+            }
 
+            // 更新此材质的tintIndex
+            if (!data.materials.empty() && newFace.materialIndex >= 0 && newFace.materialIndex < data.materials.size()) {
+                data.materials[newFace.materialIndex].tintIndex = face.tintIndex;
             }
+
+            data.faces.push_back(newFace);
         }
     }
-
 }
 
 
-// 处理模型数据的方法
-ModelData ProcessModelData(const nlohmann::json& modelJson, const std::string& blockName) {
+// 由编译后的模型生成网格数据
+ModelData ProcessModelData(const CompiledModel& model, const std::string& blockName) {
     ModelData data;
 
-    // 处理纹理和材质
-    std::unordered_map<std::string, int> textureKeyToMaterialIndex;
-
-    if (modelJson.contains("elements")) {
-        // 处理元素生成材质数据
-        processTextures(modelJson, data, textureKeyToMaterialIndex);
+    if (model.hasElements) {
+        // 处理纹理变量生成材质数据
+        std::vector<int> slotToMaterial;
+        processTextures(model, data, slotToMaterial);
 
         // 处理元素生成几何数据
-        processElements(modelJson, data, textureKeyToMaterialIndex);
+        processElements(model, data, slotToMaterial);
     }
     else {
         // 当模型中没有 "elements" 字段时,生成实体方块模型
         data = SpecialBlock::GenerateSpecialBlockModel(blockName);
     }
-    
 
     return data;
 }
@@ -1235,41 +1180,32 @@ ModelData ProcessModelJson(const std::string& namespaceName, const std::string&
     // 生成唯一缓存键(添加模型索引)
     std::string cacheKey = namespaceName + ":" + blockId + ":" + std::to_string(randomIndex);
 
-    // 在访问缓存前加锁
-    std::lock_guard<std::mutex> lock(cacheMutex);
-    // 检查缓存是否存在
-    auto cacheIt = modelCache.find(cacheKey);
-    if (cacheIt != modelCache.end()) {
-        // 从缓存中获取原始模型数据
-        ModelData cachedModel = cacheIt->second;
-        if (rotationX != 0 || rotationY != 0) {
-            // 使用C++20的span进行函数调用
-            ApplyRotationToVertices(std::span<float>(cachedModel.vertices.data(), cachedModel.vertices.size()), rotationX, rotationY);
-        }
-        if (uvlock)
-        {
-            ApplyRotationToUV(cachedModel, rotationX, rotationY);
+    ModelData modelData;
+    bool cached = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(modelCacheMutex);
+        auto cacheIt = modelCache.find(cacheKey);
+        if (cacheIt != modelCache.end()) {
+            // 从缓存中获取原始模型数据
+            modelData = cacheIt->second;
+            cached = true;
         }
-        // 施加旋转到 faceDirections
-        ApplyRotationToFaceDirections(cachedModel.faces, rotationX, rotationY);
-        return cachedModel;
     }
-    // 缓存未命中,正常加载模型
-    nlohmann::json modelJson = GetModelJson(namespaceName, blockId);
 
-    ModelData modelData;
-    if (modelJson.is_null()) {
-        return modelData;
-    }
-    // 递归加载父模型并合并属性
-    modelJson = LoadParentModel(namespaceName, blockId, modelJson);
-    
-    // 处理模型数据(不包含旋转)
-    modelData = ProcessModelData(modelJson,blockstateName);
+    if (!cached) {
+        // 缓存未命中,由编译后的模型生成网格(不持有缓存锁)
+        auto compiledModel = GetCompiledModel(namespaceName, blockId);
+        if (!compiledModel) {
+            return modelData;
+        }
 
+        // 处理模型数据(不包含旋转)
+        modelData = ProcessModelData(*compiledModel, blockstateName);
 
-    // 将原始数据存入缓存(不包含旋转)
-    modelCache[cacheKey] = modelData;
+        // 将原始数据存入缓存(不包含旋转)
+        std::unique_lock<std::shared_mutex> lock(modelCacheMutex);
+        modelCache.emplace(cacheKey, modelData);
+    }
 
     if (rotationX != 0 || rotationY != 0) {
         // 如果指定了旋转,则应用旋转
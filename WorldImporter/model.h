@@ -10,6 +10,8 @@
 #include <cmath>
 #include "include/json.hpp"
 #include <mutex>
+#include <memory>
+#include <cstdint>
 #include <future>
 #include <concepts>     // C++20特性
 #include <span>         // C++20特性
@@ -52,12 +54,17 @@ struct Material {
 //---------------- 数据类型定义 ----------------
 // 在 ModelData 定义之前新增 Face 结构体定义,用于包含顶点索引、UV 索引、材质索引和面方向
 struct Face {
-    std::array<int, 4> vertexIndices; // 四个顶点索引
+    std::array<int, 4> vertexIndices; // 四个顶点索引(三角形的第4个索引与第3个相同)
     std::array<int, 4> uvIndices;     // 四个 UV 索引
     int materialIndex;                // 材质索引
     FaceType faceDirection;           // 剔除方向
 };
 
+// 面的实际顶点数:第4个顶点与第3个相同时为三角形
+inline int FaceCornerCount(const Face& face) {
+    return face.vertexIndices[3] == face.vertexIndices[2] ? 3 : 4;
+}
+
 // 修改 ModelData,使用统一 Face 结构体替换原有的 faces、uvFaces、materialIndices 和 faceDirections
 struct ModelData {
     // 顶点数据(x,y,z顺序存储)
@@ -110,18 +117,26 @@ concept TextureCoord = requires(T uv) {
     { uv.v } -> std::convertible_to<float>;
 };
 
-// 修改哈希函数以使用C++20的功能
+// 面键哈希:两两打包为64位后用 splitmix64 终结器混合,
+// 避免相邻顶点索引在异或组合下聚集到同一批桶中
 struct FaceKeyHasher {
+    static uint64_t Mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
     size_t operator()(const FaceKey& k) const {
-        size_t seed = 0;
-        // 结合材质信息和每个顶点索引
-        seed ^= std::hash<int>()(k.materialIndex) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        
-        // 使用C++20的ranges功能来简化遍历
-        for (int v : k.sortedVerts) {
-            seed ^= std::hash<int>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
+        auto pack = [](int a, int b) {
+            return (static_cast<uint64_t>(static_cast<uint32_t>(a)) << 32) | static_cast<uint32_t>(b);
+        };
+        uint64_t h = Mix(pack(k.sortedVerts[0], k.sortedVerts[1]) + 0x9e3779b97f4a7c15ULL);
+        h = Mix(h ^ pack(k.sortedVerts[2], k.sortedVerts[3]));
+        h = Mix(h ^ static_cast<uint32_t>(k.materialIndex));
+        return static_cast<size_t>(h);
     }
 };
 
@@ -154,13 +169,40 @@ FaceType StringToFaceType(const std::string& dirString);
 FaceType GetFaceTypeByIndex(size_t faceIndex);
 
 
-//---------------- 缓存管理 ----------------
-static std::mutex cacheMutex;
-static std::recursive_mutex parentModelCacheMutex;
+//---------------- 编译后的模型中间表示 ----------------
+// 父模型链与纹理变量在编译时一次性解析,网格生成时不再遍历JSON或按字符串查找
+enum ModelFaceName : uint8_t {
+    FACE_NORTH, FACE_SOUTH, FACE_EAST, FACE_WEST, FACE_UP, FACE_DOWN, FACE_NAME_COUNT
+};
+
+struct CompiledModelFace {
+    uint8_t name = FACE_NAME_COUNT;            // 面名称(ModelFaceName)
+    FaceType cullface = FaceType::DO_NOT_CULL; // 剔除方向
+    bool hasTexture = false;                   // 是否声明了 texture
+    int textureSlot = -1;                      // 引用的纹理变量序号,未解析时为 -1
+    bool hasUV = false;                        // 是否声明了 uv
+    std::array<float, 4> uv{};                 // 显式 UV 区域(0-16)
+    int rotation = 0;                          // UV 旋转角度
+    short tintIndex = -1;                      // 染色索引
+};
+
+struct CompiledModelElement {
+    std::array<float, 3> from{}, to{};         // 已转换到方块单位(/16)
+    int rotationAxis = -1;                     // 0=x 1=y 2=z,-1 表示无旋转
+    float angle = 0.0f;                        // 旋转角度(度)
+    std::array<float, 3> origin{};             // 旋转中心(方块单位)
+    bool rescale = false;
+    std::vector<CompiledModelFace> faces;      // 与JSON对象遍历顺序一致
+};
+
+struct CompiledModel {
+    bool hasElements = false;
+    std::vector<std::pair<std::string, std::string>> textures; // 纹理变量 -> 已合并父模型的纹理引用
+    std::vector<CompiledModelElement> elements;
+};
 
-// 静态缓存
-static std::unordered_map<std::string, ModelData> modelCache; // Key: "namespace:blockId"
-static std::unordered_map<std::string, nlohmann::json> parentModelCache;
+// 获取编译后的模型(首次调用时解析父模型链并编译,线程安全),模型不存在时返回空指针
+std::shared_ptr<const CompiledModel> GetCompiledModel(const std::string& namespaceName, const std::string& modelPath);
 
 //---------------- 核心功能声明 ----------------
 // 模型处理
@@ -1,4 +1,5 @@
 #include "ObjExporter.h"
+#include "LODManager.h"
 #include <chrono>
 #include <fstream>
 #include <sstream>
@@ -267,7 +268,8 @@ void createObjFileViaMemoryMapped(const ModelData& data, const std::string& objN
             size_t faceLength = 3; // "f " + '\n'
             const auto& vertexIndices = data.faces[faceIdx].vertexIndices;
             const auto& uvIndices = data.faces[faceIdx].uvIndices;
-            for (int i = 0; i < 4; ++i) {
+            const int corners = FaceCornerCount(data.faces[faceIdx]);
+            for (int i = 0; i < corners; ++i) {
                 const int vIdx = vertexIndices[i] + 1;
                 const int uvIdx = uvIndices[i] + 1;
                 faceLength += calculateIntLength(vIdx) + calculateIntLength(uvIdx) + 2; // 对应 '/' 和空格
@@ -314,7 +316,8 @@ void createObjFileViaMemoryMapped(const ModelData& data, const std::string& objN
         for (const size_t faceIdx : faces) {
             memcpy(ptr, "f ", 2);
             ptr += 2;
-            for (int i = 0; i < 4; ++i) {
+            const int corners = FaceCornerCount(data.faces[faceIdx]);
+            for (int i = 0; i < corners; ++i) {
                 const int vIdx = data.faces[faceIdx].vertexIndices[i] + 1;
                 const int uvIdx = data.faces[faceIdx].uvIndices[i] + 1;
                 if (vIdx <= 0 || uvIdx <= 0) {
@@ -442,7 +445,8 @@ void createObjFile(const ModelData& data, const std::string& objName, const std:
         oss << "usemtl " << data.materials[matIndex].name << "\n";
         for (const size_t faceIdx : faces) {
             oss << "f ";
-            for (int i = 0; i < 4; ++i) {
+            const int corners = FaceCornerCount(data.faces[faceIdx]);
+            for (int i = 0; i < corners; ++i) {
                 const int vIdx = data.faces[faceIdx].vertexIndices[i] + 1;
                 const int uvIdx = data.faces[faceIdx].uvIndices[i] + 1;
                 oss << vIdx << "/" << uvIdx << " ";
@@ -462,6 +466,20 @@ void createObjFile(const ModelData& data, const std::string& objName, const std:
     }
 }
 
+// 写入LOD纯颜色材质(颜色直接取自调色板)
+static void WriteLODColorMaterial(std::ofstream& mtlFile, uint32_t rgb) {
+    mtlFile << "Kd " << std::fixed << std::setprecision(config.decimalPlaces)
+        << ((rgb >> 16) & 0xFF) / 255.0f << " "
+        << ((rgb >> 8) & 0xFF) / 255.0f << " "
+        << (rgb & 0xFF) / 255.0f << "\n";
+    // 共用普通材质参数
+    mtlFile << "Ns 90.000000\n";
+    mtlFile << "Ks 0.000000 0.000000 0.000000\n";
+    mtlFile << "Ke 0.000000 0.000000 0.000000\n";
+    mtlFile << "Ni 1.500000\n";
+    mtlFile << "illum 1\n";
+}
+
 void CreateSharedMtlFile(std::unordered_map<std::string, std::string> uniqueMaterials, const std::string& mtlFileName) {
     std::string exeDir = getExecutableDir();
     std::string fullMtlPath = exeDir + mtlFileName + ".mtl";
@@ -473,6 +491,7 @@ void CreateSharedMtlFile(std::unordered_map<std::string, std::string> uniqueMate
             std::string texturePath = uM.second;
 
             mtlFile << "newmtl " << textureName << "\n";
+            uint32_t paletteColor = 0;
 
             // 处理材质类型
             if (texturePath == "None") {
@@ -485,38 +504,9 @@ void CreateSharedMtlFile(std::unordered_map<std::string, std::string> uniqueMate
                 mtlFile << "Ni 1.500000\n";
                 mtlFile << "illum 2\n";
             }
-            // 处理纯颜色材质(支持流体格式:color#r g b-流体名 和普通格式:color#r g b=)
-            else if (texturePath.find("color#") != std::string::npos) {
-                std::string colorStr;
-                size_t pos = texturePath.find("-");
-                size_t pos_deng = texturePath.find("=");
-                if (pos != std::string::npos) {
-                    // 流体材质格式,提取"-"前面的颜色部分
-                    colorStr = texturePath.substr(std::string("color#").size(), pos - std::string("color#").size());
-                }
-                else if (pos_deng != std::string::npos) {
-                    colorStr = texturePath.substr(std::string("color#").size(), pos_deng - std::string("color#").size());
-                }
-                else {
-                    colorStr = "";
-                }
-                std::istringstream iss(colorStr);
-                float r, g, b;
-                if (iss >> r >> g >> b) {
-
-                    mtlFile << "Kd " << std::fixed << std::setprecision(config.decimalPlaces)
-                        << r << " " << g << " " << b << "\n";
-                }
-                else {
-                    mtlFile << "Kd 1.000000 1.000000 1.000000\n";
-                    std::cerr << "Error: Invalid color format in '" << texturePath << "'\n";
-                }
-                // 共用普通材质参数
-                mtlFile << "Ns 90.000000\n";
-                mtlFile << "Ks 0.000000 0.000000 0.000000\n";
-                mtlFile << "Ke 0.000000 0.000000 0.000000\n";
-                mtlFile << "Ni 1.500000\n";
-                mtlFile << "illum 1\n";
+            // 处理LOD调色板颜色材质(lodcolor#索引)
+            else if (LODManager::GetLODPaletteColor(texturePath, paletteColor)) {
+                WriteLODColorMaterial(mtlFile, paletteColor);
             }
             else {
                 // 普通纹理材质处理
@@ -559,6 +549,7 @@ void createMtlFile(const ModelData& data, const std::string& mtlFileName) {
             std::string texturePath = data.materials[i].texturePath;
 
             mtlFile << "newmtl " << textureName << "\n";
+            uint32_t paletteColor = 0;
 
             // 处理材质类型
             if (texturePath == "None") {
@@ -571,37 +562,9 @@ void createMtlFile(const ModelData& data, const std::string& mtlFileName) {
                 mtlFile << "Ni 1.500000\n";
                 mtlFile << "illum 2\n";
             }
-            // 处理纯颜色材质(支持流体格式:color#r g b-流体名 和普通格式:color#r g b=)
-            else if (texturePath.find("color#") != std::string::npos) {
-                std::string colorStr;
-                size_t pos = texturePath.find("-");
-                size_t pos_deng = texturePath.find("=");
-                if (pos != std::string::npos) {
-                    // 流体材质格式,提取"-"前面的颜色部分
-                    colorStr = texturePath.substr(std::string("color#").size(), pos - std::string("color#").size());
-                }
-                else if (pos_deng != std::string::npos) {
-                    colorStr = texturePath.substr(std::string("color#").size(), pos_deng - std::string("color#").size());
-                }
-                else {
-                    colorStr = "";
-                }
-                std::istringstream iss(colorStr);
-                float r, g, b;
-                if (iss >> r >> g >> b) {
-                    mtlFile << "Kd " << std::fixed << std::setprecision(config.decimalPlaces)
-                        << r << " " << g << " " << b << "\n";
-                }
-                else {
-                    mtlFile << "Kd 1.000000 1.000000 1.000000\n";
-                    std::cerr << "Error: Invalid color format in '" << texturePath << "'\n";
-                }
-                // 共用普通材质参数
-                mtlFile << "Ns 90.000000\n";
-                mtlFile << "Ks 0.000000 0.000000 0.000000\n";
-                mtlFile << "Ke 0.000000 0.000000 0.000000\n";
-                mtlFile << "Ni 1.500000\n";
-                mtlFile << "illum 1\n";
+            // 处理LOD调色板颜色材质(lodcolor#索引)
+            else if (LODManager::GetLODPaletteColor(texturePath, paletteColor)) {
+                WriteLODColorMaterial(mtlFile, paletteColor);
             }
             else {
                 // 普通纹理材质处理
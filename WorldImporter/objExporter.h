@@ -15,6 +15,9 @@
 #include "GlobalCache.h"
 #include "model.h"
 #pragma once
+// 可执行文件所在目录(以 "/" 结尾),相对输出路径均以此为基准
+std::string getExecutableDir();
+
 // 文件导出
 void CreateModelFiles(const ModelData& data, const std::string& filename);
 
@@ -1,13 +1,32 @@
 #include "texture.h"
 #include "fileutils.h"
-#include <Windows.h>   
+#include "objExporter.h"
+#include "TextureWriter.h"
 #include <iostream>
 #include <fstream>
 #include <chrono>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <filesystem>
+#include <cstring>
+#include "include/stb_image.h"
+#include "include/stb_image_write.h"
 
 std::unordered_map<std::string, std::string> texturePathCache; // 定义材质路径缓存
+std::mutex texturePathCacheMutex;
 std::unordered_map<std::string, TextureDimension> textureDimensionCache; // 定义材质尺寸缓存
 
+// 纹理平均颜色表(索引初始化后只读;颜色在首次查询时解压计算,原子写入)
+static std::unordered_map<std::string, int> textureIdMap;   // "命名空间:路径" -> 纹理ID
+static std::vector<std::string> textureSourceKeys;          // 纹理ID -> 生效的完整缓存键
+static std::unique_ptr<std::atomic<uint32_t>[]> textureAverageColors; // 纹理ID -> 标记 | 0xRRGGBB
+static constexpr uint32_t kTextureColorValid = 0x01000000u;
+static constexpr uint32_t kTextureColorComputed = 0x02000000u;
+static constexpr float kLODColorGamma = 2.0f;               // LOD 颜色的对比度增强系数
+
 // PNG文件头部解析，读取图像尺寸
 bool GetPNGDimensions(const std::vector<unsigned char>& pngData, int& width, int& height) {
     // PNG文件至少需要24字节头部
@@ -32,177 +51,233 @@ bool GetPNGDimensions(const std::vector<unsigned char>& pngData, int& width, int
     return (width > 0 && height > 0);
 }
 
-bool SaveTextureToFile(const std::string& namespaceName, const std::string& blockId, std::string& savePath) {
-    std::vector<unsigned char> textureData;
-    nlohmann::json mcmetaData;
+// 按导出选项处理纹理:动态纹理裁剪为单帧(cropAnimatedTextures),超过尺寸上限时缩小(maxTextureSize)
+// 未做任何处理时保持原始PNG数据不变
+static void ProcessExportTexture(const std::string& textureKey, std::vector<unsigned char>& pngData) {
+    const nlohmann::json* animation = nullptr;
+    if (config.cropAnimatedTextures) {
+        auto mcmetaIt = GlobalCache::mcmetaCache.find(textureKey);
+        if (mcmetaIt != GlobalCache::mcmetaCache.end() && mcmetaIt->second.contains("animation") &&
+            mcmetaIt->second["animation"].is_object()) {
+            animation = &mcmetaIt->second["animation"];
+        }
+    }
+    const int maxSize = config.maxTextureSize;
+
     int width = 0, height = 0;
-    bool isDynamic = false;
+    if (!animation && (maxSize <= 0 || !GetPNGDimensions(pngData, width, height) || std::max(width, height) <= maxSize)) {
+        return;
+    }
 
-    {
-        std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-        // 按照 JAR 文件的加载顺序逐个查找主纹理数据
-        for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-            const std::string& modId = GlobalCache::jarOrder[i];
-            std::string cacheKey = modId + ":" + namespaceName + ":" + blockId;
-            auto textureIt = GlobalCache::textures.find(cacheKey);
-            if (textureIt != GlobalCache::textures.end()) {
-                textureData = textureIt->second;
-                
-                // 读取PNG尺寸
-                if (GetPNGDimensions(textureData, width, height)) {
-                    // 保存到尺寸缓存
-                    std::lock_guard<std::mutex> dimLock(textureDimensionMutex);
-                    textureDimensionCache[cacheKey] = TextureDimension(width, height);
-                }
+    int channels = 0;
+    unsigned char* decoded = stbi_load_from_memory(pngData.data(), static_cast<int>(pngData.size()), &width, &height, &channels, 4);
+    if (!decoded) return;
+    std::vector<unsigned char> pixels(decoded, decoded + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(decoded);
+
+    // 裁剪动态纹理的指定帧(帧默认为以较短边为边长的正方形,可由 mcmeta 的 width/height 指定)
+    if (animation) {
+        int frameWidth = std::clamp(animation->value("width", std::min(width, height)), 1, width);
+        int frameHeight = std::clamp(animation->value("height", std::min(width, height)), 1, height);
+        int framesPerRow = std::max(1, width / frameWidth);
+        int frameCount = framesPerRow * std::max(1, height / frameHeight);
 
-                // 获取动态材质数据(如果存在)
-                auto mcmetaIt = GlobalCache::mcmetaCache.find(cacheKey);
-                if (mcmetaIt != GlobalCache::mcmetaCache.end()) {
-                    mcmetaData = mcmetaIt->second;
-                    if (mcmetaData.contains("animation")) {
-                        isDynamic = true;
+        // 有 frames 序列时按序列取帧
+        int frameIndex = std::max(0, config.animatedTextureFrame);
+        if (animation->contains("frames") && (*animation)["frames"].is_array() && !(*animation)["frames"].empty()) {
+            const auto& frames = (*animation)["frames"];
+            const auto& frame = frames[std::min<size_t>(frameIndex, frames.size() - 1)];
+            frameIndex = frame.is_number_integer() ? frame.get<int>() :
+                (frame.is_object() ? frame.value("index", 0) : 0);
+        }
+        frameIndex = std::clamp(frameIndex, 0, frameCount - 1);
+
+        int frameX = (frameIndex % framesPerRow) * frameWidth;
+        int frameY = (frameIndex / framesPerRow) * frameHeight;
+        std::vector<unsigned char> frame(static_cast<size_t>(frameWidth) * frameHeight * 4);
+        for (int y = 0; y < frameHeight; ++y) {
+            std::memcpy(frame.data() + static_cast<size_t>(y) * frameWidth * 4,
+                pixels.data() + (static_cast<size_t>(frameY + y) * width + frameX) * 4,
+                static_cast<size_t>(frameWidth) * 4);
+        }
+        pixels.swap(frame);
+        width = frameWidth;
+        height = frameHeight;
+    }
+
+    // 超过尺寸上限时按整数倍缩小(透明度加权的盒式滤波,保持长宽比)
+    if (maxSize > 0 && std::max(width, height) > maxSize) {
+        int factor = (std::max(width, height) + maxSize - 1) / maxSize;
+        int newWidth = (width + factor - 1) / factor;
+        int newHeight = (height + factor - 1) / factor;
+        std::vector<unsigned char> scaled(static_cast<size_t>(newWidth) * newHeight * 4);
+        for (int y = 0; y < newHeight; ++y) {
+            for (int x = 0; x < newWidth; ++x) {
+                uint32_t sumR = 0, sumG = 0, sumB = 0, sumA = 0, count = 0;
+                for (int sy = y * factor; sy < std::min(height, (y + 1) * factor); ++sy) {
+                    for (int sx = x * factor; sx < std::min(width, (x + 1) * factor); ++sx) {
+                        const unsigned char* p = pixels.data() + (static_cast<size_t>(sy) * width + sx) * 4;
+                        sumR += p[0] * p[3];
+                        sumG += p[1] * p[3];
+                        sumB += p[2] * p[3];
+                        sumA += p[3];
+                        ++count;
                     }
                 }
-                break;
+                unsigned char* dst = scaled.data() + (static_cast<size_t>(y) * newWidth + x) * 4;
+                dst[0] = sumA ? static_cast<unsigned char>(sumR / sumA) : 0;
+                dst[1] = sumA ? static_cast<unsigned char>(sumG / sumA) : 0;
+                dst[2] = sumA ? static_cast<unsigned char>(sumB / sumA) : 0;
+                dst[3] = static_cast<unsigned char>(sumA / count);
             }
         }
+        pixels.swap(scaled);
+        width = newWidth;
+        height = newHeight;
+    }
 
-        if (textureData.empty()) {
-            std::cerr << "Texture not found: " << namespaceName << ":" << blockId << std::endl;
-            return false;
-        }
+    std::vector<unsigned char> encoded;
+    stbi_write_png_to_func([](void* context, void* data, int size) {
+        auto* out = static_cast<std::vector<unsigned char>*>(context);
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        out->insert(out->end(), bytes, bytes + size);
+    }, &encoded, width, height, 4, pixels.data(), width * 4);
+    if (!encoded.empty()) {
+        pngData.swap(encoded);
     }
+}
 
-    // 处理保存路径
-    char buffer[MAX_PATH];
-    GetModuleFileNameA(NULL, buffer, MAX_PATH);
-    std::string exePath(buffer);
-    size_t pos = exePath.find_last_of("\\/");
-    std::string exeDir = exePath.substr(0, pos);
+// 将 JSON 格式化为写出用的字节序列
+static std::vector<unsigned char> DumpJsonBytes(const nlohmann::json& json) {
+    std::string text = json.dump(4);
+    return std::vector<unsigned char>(text.begin(), text.end());
+}
 
-    if (savePath.empty()) {
-        savePath = exeDir + "\\textures";
+// 解压并处理纹理,记录尺寸并计算保存路径;writeFiles 为 false 时不写出任何文件
+static bool SaveTexture(const std::string& namespaceName, const std::string& blockId, std::string& savePath, bool writeFiles) {
+    namespace fs = std::filesystem;
+    std::vector<unsigned char> textureData;
+    nlohmann::json mcmetaData;
+    int width = 0, height = 0;
+
+    // 主纹理的生效版本(覆盖关系已在初始化时解析)
+    std::string textureKey;
+    if (auto entry = GlobalCache::FindResolved(GlobalCache::resolvedTextures, namespaceName, blockId)) {
+        textureKey = entry->first;
+
+        // 获取动态材质数据(如果存在)
+        auto mcmetaIt = GlobalCache::mcmetaCache.find(textureKey);
+        if (mcmetaIt != GlobalCache::mcmetaCache.end()) {
+            mcmetaData = mcmetaIt->second;
+        }
+    }
+
+    // 从归档解压纹理数据
+    if (textureKey.empty() || !GlobalCache::LoadTexture(textureKey, textureData)) {
+        std::cerr << "Texture not found: " << namespaceName << ":" << blockId << std::endl;
+        return false;
     }
-    else {
-        savePath = exeDir + "\\" + savePath;
+    ProcessExportTexture(textureKey, textureData);
+
+    // 读取PNG尺寸(记录写出后的实际尺寸)
+    if (GetPNGDimensions(textureData, width, height)) {
+        // 保存到尺寸缓存
+        std::lock_guard<std::mutex> dimLock(textureDimensionMutex);
+        textureDimensionCache[textureKey] = TextureDimension(width, height);
     }
 
-    // 创建保存目录
-    if (GetFileAttributesA(savePath.c_str()) == INVALID_FILE_ATTRIBUTES) {
-        CreateDirectoryA(savePath.c_str(), NULL);
+    // 处理保存路径:<程序目录>/<保存目录>/<命名空间>/<纹理路径>.png
+    fs::path saveDir = fs::path(getExecutableDir()) / (savePath.empty() ? std::string("textures") : savePath);
+    fs::path filePath = saveDir / namespaceName / (blockId + ".png");
+    savePath = filePath.string();
+    if (!writeFiles) {
+        return true;
     }
 
-    // 提取文件名(不含路径)
-    size_t lastSlashPos = blockId.find_last_of("/\\");
-    std::string fileName = (lastSlashPos == std::string::npos) ? blockId : blockId.substr(lastSlashPos + 1);
-
-    // 创建 namespace 目录
-    std::string namespaceDir = savePath + "\\" + namespaceName;
-    CreateDirectoryA(namespaceDir.c_str(), NULL);
-
-    // 递归创建子目录
-    std::string pathPart = blockId.substr(0, lastSlashPos);
-    std::string currentPath = namespaceDir;
-    size_t start = 0;
-    size_t end;
-    while ((end = pathPart.find('/', start)) != std::string::npos) {
-        std::string dir = pathPart.substr(start, end - start);
-        currentPath += "\\" + dir;
-        CreateDirectoryA(currentPath.c_str(), NULL);
-        start = end + 1;
+    // 保存主 PNG 文件与 .mcmeta 文件(如果存在),由后台线程写出
+    TextureWriter::Enqueue(filePath, std::move(textureData));
+    // 裁剪为单帧的动态纹理不再附带动画数据
+    if (!mcmetaData.empty() && !(config.cropAnimatedTextures && mcmetaData.contains("animation"))) {
+        fs::path mcmetaFilePath = filePath;
+        mcmetaFilePath += ".mcmeta";
+        TextureWriter::Enqueue(mcmetaFilePath, DumpJsonBytes(mcmetaData));
     }
-    std::string finalDir = currentPath + "\\" + pathPart.substr(start);
-    CreateDirectoryA(finalDir.c_str(), NULL);
-
-    // 保存主 PNG 文件
-    std::string filePath = finalDir + "\\" + fileName + ".png";
-    std::ofstream outputFile(filePath, std::ios::binary);
-    savePath = filePath;
-
-    if (outputFile.is_open()) {
-        outputFile.write(reinterpret_cast<const char*>(textureData.data()), textureData.size());
-        outputFile.close();
-
-        // 保存 .mcmeta 文件(如果存在)
-        if (!mcmetaData.empty()) {
-            std::string mcmetaFilePath = filePath + ".mcmeta";
-            std::ofstream mcmetaFile(mcmetaFilePath);
-            if (mcmetaFile.is_open()) {
-                mcmetaFile << mcmetaData.dump(4); // 格式化输出 JSON
-                mcmetaFile.close();
-            }
-            else {
-                std::cerr << "Failed to save .mcmeta file: " << mcmetaFilePath << std::endl;
+
+    // 保存 PBR 贴图,后缀分别为 _n、_a、_s
+    static const std::array<const char*, 3> pbrSuffixes = { "_n", "_a", "_s" };
+    for (const char* suffix : pbrSuffixes) {
+        std::vector<unsigned char> pbrTextureData;
+        nlohmann::json pbrMcmetaData;
+        int pbrWidth = 0, pbrHeight = 0;
+
+        // 查找 PBR 贴图的生效版本
+        std::string pbrTextureKey;
+        if (auto entry = GlobalCache::FindResolved(GlobalCache::resolvedTextures, namespaceName, blockId + suffix)) {
+            pbrTextureKey = entry->first;
+
+            // 获取 PBR 贴图的 .mcmeta 数据(如果存在)
+            auto pbrMcmetaIt = GlobalCache::mcmetaCache.find(pbrTextureKey);
+            if (pbrMcmetaIt != GlobalCache::mcmetaCache.end()) {
+                pbrMcmetaData = pbrMcmetaIt->second;
             }
         }
 
-        // 保存 PBR 贴图,后缀分别为 _n、_a、_s
-        std::vector<std::string> pbrSuffixes = { "_n", "_a", "_s" };
-        for (const auto& suffix : pbrSuffixes) {
-            std::vector<unsigned char> pbrTextureData;
-            nlohmann::json pbrMcmetaData;
-            int pbrWidth = 0, pbrHeight = 0;
-
-            // 按照 GlobalCache::jarOrder 顺序查找 PBR 贴图数据
-            {
-                std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-                for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-                    const std::string& modId = GlobalCache::jarOrder[i];
-                    std::string pbrCacheKey = modId + ":" + namespaceName + ":" + blockId + suffix;
-                    auto pbrTextureIt = GlobalCache::textures.find(pbrCacheKey);
-                    if (pbrTextureIt != GlobalCache::textures.end()) {
-                        pbrTextureData = pbrTextureIt->second;
-                        
-                        // 读取PBR贴图的尺寸
-                        if (GetPNGDimensions(pbrTextureData, pbrWidth, pbrHeight)) {
-                            // 保存到尺寸缓存
-                            std::lock_guard<std::mutex> dimLock(textureDimensionMutex);
-                            textureDimensionCache[pbrCacheKey] = TextureDimension(pbrWidth, pbrHeight);
-                        }
-
-                        // 获取 PBR 贴图的 .mcmeta 数据(如果存在)
-                        auto pbrMcmetaIt = GlobalCache::mcmetaCache.find(pbrCacheKey);
-                        if (pbrMcmetaIt != GlobalCache::mcmetaCache.end()) {
-                            pbrMcmetaData = pbrMcmetaIt->second;
-                        }
-                        break;
-                    }
-                }
-            }
+        if (pbrTextureKey.empty() || !GlobalCache::LoadTexture(pbrTextureKey, pbrTextureData) || pbrTextureData.empty()) {
+            continue;
+        }
+        ProcessExportTexture(pbrTextureKey, pbrTextureData);
 
-            if (!pbrTextureData.empty()) {
-                // 保存 PBR 贴图
-                std::string pbrFilePath = finalDir + "\\" + fileName + suffix + ".png";
-                std::ofstream pbrOutputFile(pbrFilePath, std::ios::binary);
-                if (pbrOutputFile.is_open()) {
-                    pbrOutputFile.write(reinterpret_cast<const char*>(pbrTextureData.data()), pbrTextureData.size());
-                    pbrOutputFile.close();
-
-                    // 保存 PBR 贴图的 .mcmeta 文件(如果存在)
-                    if (!pbrMcmetaData.empty()) {
-                        std::string pbrMcmetaFilePath = pbrFilePath + ".mcmeta";
-                        std::ofstream pbrMcmetaFile(pbrMcmetaFilePath);
-                        if (pbrMcmetaFile.is_open()) {
-                            pbrMcmetaFile << pbrMcmetaData.dump(4); // 格式化输出 JSON
-                            pbrMcmetaFile.close();
-                        }
-                        else {
-                            std::cerr << "Failed to save PBR .mcmeta file: " << pbrMcmetaFilePath << std::endl;
-                        }
-                    }
-                }
-                else {
-                    std::cerr << "Failed to save PBR texture: " << pbrFilePath << std::endl;
-                }
-            }
+        // 读取PBR贴图的尺寸
+        if (GetPNGDimensions(pbrTextureData, pbrWidth, pbrHeight)) {
+            // 保存到尺寸缓存
+            std::lock_guard<std::mutex> dimLock(textureDimensionMutex);
+            textureDimensionCache[pbrTextureKey] = TextureDimension(pbrWidth, pbrHeight);
         }
 
-        return true;
+        // 保存 PBR 贴图及其 .mcmeta 文件(如果存在)
+        fs::path pbrFilePath = saveDir / namespaceName / (blockId + suffix + ".png");
+        TextureWriter::Enqueue(pbrFilePath, std::move(pbrTextureData));
+        if (!pbrMcmetaData.empty() && !(config.cropAnimatedTextures && pbrMcmetaData.contains("animation"))) {
+            fs::path pbrMcmetaFilePath = pbrFilePath;
+            pbrMcmetaFilePath += ".mcmeta";
+            TextureWriter::Enqueue(pbrMcmetaFilePath, DumpJsonBytes(pbrMcmetaData));
+        }
     }
-    else {
-        std::cerr << "Failed to save texture: " << filePath << std::endl;
+
+    return true;
+}
+
+bool SaveTextureToFile(const std::string& namespaceName, const std::string& blockId, std::string& savePath) {
+    return SaveTexture(namespaceName, blockId, savePath, true);
+}
+
+// 图集模式下延迟写出的纹理:材质路径 -> (命名空间, 纹理路径)
+static std::mutex deferredTextureMutex;
+static std::unordered_map<std::string, std::pair<std::string, std::string>> deferredTextures;
+
+bool DeferTextureSave(const std::string& namespaceName, const std::string& blockId) {
+    std::string savePath = "textures";
+    if (!SaveTexture(namespaceName, blockId, savePath, false)) {
         return false;
     }
+    std::lock_guard<std::mutex> lock(deferredTextureMutex);
+    deferredTextures.emplace("textures/" + namespaceName + "/" + blockId + ".png", std::make_pair(namespaceName, blockId));
+    return true;
+}
+
+bool WriteDeferredTexture(const std::string& materialTexturePath) {
+    std::pair<std::string, std::string> source;
+    {
+        std::lock_guard<std::mutex> lock(deferredTextureMutex);
+        auto it = deferredTextures.find(materialTexturePath);
+        if (it == deferredTextures.end()) {
+            return false;
+        }
+        source = std::move(it->second);
+        deferredTextures.erase(it);
+    }
+    std::string savePath = "textures";
+    return SaveTexture(source.first, source.second, savePath, true);
 }
 
 void RegisterTexture(const std::string& namespaceName, const std::string& pathPart, const std::string& savePath) {
@@ -260,6 +335,11 @@ bool ParseMcmetaFile(const std::string& cacheKey, MaterialType& outType, float&
     
     // 检查是否为动态材质
     if (mcmetaData.contains("animation")) {
+        if (config.cropAnimatedTextures) {
+            // 导出时已裁剪为单帧,按普通材质处理,无需缩放UV
+            outAspectRatio = 1.0f;
+            return true;
+        }
         outType = ANIMATED;
         // 注意：我们已经从图片尺寸计算了帧数/比例，不需要再从mcmeta中提取
         return true;
@@ -286,17 +366,13 @@ MaterialType DetectMaterialType(const std::string& namespaceName, const std::str
     MaterialType type = NORMAL;
     outAspectRatio = 1.0f;
     
-    std::lock_guard<std::mutex> lock(GlobalCache::cacheMutex);
-    
-    // 按照JAR文件的加载顺序逐个查找
-    for (size_t i = 0; i < GlobalCache::jarOrder.size(); ++i) {
-        const std::string& modId = GlobalCache::jarOrder[i];
-        std::string cacheKey = modId + ":" + namespaceName + ":" + texturePath;
-        
-        // 检查.mcmeta文件是否存在，同时获取长宽比
-        if (ParseMcmetaFile(cacheKey, type, outAspectRatio)) {
-            break;
-        }
+    // 优先使用生效的.mcmeta所在条目,否则使用生效纹理条目(用于获取长宽比)
+    auto mcmetaEntry = GlobalCache::FindResolved(GlobalCache::resolvedMcmetas, namespaceName, texturePath);
+    if (mcmetaEntry) {
+        ParseMcmetaFile(mcmetaEntry->first, type, outAspectRatio);
+    }
+    else if (auto textureEntry = GlobalCache::FindResolved(GlobalCache::resolvedTextures, namespaceName, texturePath)) {
+        ParseMcmetaFile(textureEntry->first, type, outAspectRatio);
     }
     
     return type;
@@ -306,4 +382,132 @@ MaterialType DetectMaterialType(const std::string& namespaceName, const std::str
 MaterialType DetectMaterialType(const std::string& namespaceName, const std::string& texturePath) {
     float aspectRatio;
     return DetectMaterialType(namespaceName, texturePath, aspectRatio);
-}
\ No newline at end of file
+}
+
+//============== 纹理平均颜色 ==============//
+// sRGB -> 线性 查找表(每个8位分量)
+static const std::array<float, 256>& SrgbToLinearLUT() {
+    static const std::array<float, 256> lut = [] {
+        std::array<float, 256> table{};
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            table[i] = (c <= 0.04045f) ? (c / 12.92f) : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return table;
+    }();
+    return lut;
+}
+
+// 线性 -> sRGB 查找表(4096级量化)
+static const std::array<uint8_t, 4097>& LinearToSrgbLUT() {
+    static const std::array<uint8_t, 4097> lut = [] {
+        std::array<uint8_t, 4097> table{};
+        for (int i = 0; i <= 4096; ++i) {
+            float l = i / 4096.0f;
+            float c = (l <= 0.0031308f) ? (l * 12.92f) : (1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f);
+            table[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+        }
+        return table;
+    }();
+    return lut;
+}
+
+// 计算单张PNG的平均颜色,跳过完全透明的像素
+static uint32_t ComputePNGAverageColor(const std::vector<unsigned char>& pngData) {
+    int width = 0, height = 0, channels = 0;
+    unsigned char* pixels = stbi_load_from_memory(pngData.data(), static_cast<int>(pngData.size()),
+        &width, &height, &channels, 4);
+    if (!pixels) return 0;
+
+    const auto& toLinear = SrgbToLinearLUT();
+    double sumR = 0.0, sumG = 0.0, sumB = 0.0;
+    size_t validPixelCount = 0;
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const unsigned char* p = pixels + i * 4;
+        if (p[3] == 0) continue;
+        sumR += toLinear[p[0]];
+        sumG += toLinear[p[1]];
+        sumB += toLinear[p[2]];
+        validPixelCount++;
+    }
+    stbi_image_free(pixels);
+    if (validPixelCount == 0) return 0;
+
+    const auto& toSrgb = LinearToSrgbLUT();
+    auto encode = [&](double sum) -> uint32_t {
+        float avg = static_cast<float>(sum / validPixelCount);
+        avg = std::pow(avg, kLODColorGamma);
+        int index = static_cast<int>(std::clamp(avg, 0.0f, 1.0f) * 4096.0f + 0.5f);
+        return toSrgb[index];
+    };
+    return kTextureColorValid | (encode(sumR) << 16) | (encode(sumG) << 8) | encode(sumB);
+}
+
+void BuildTextureAverageColors() {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // 每个资源的生效版本已在初始化时按 jarOrder 解析,这里只分配连续的纹理ID
+    textureIdMap.clear();
+    textureIdMap.reserve(GlobalCache::resolvedTextures.size());
+    textureSourceKeys.clear();
+    textureSourceKeys.reserve(GlobalCache::resolvedTextures.size());
+    for (const auto& entry : GlobalCache::resolvedTextures) {
+        textureIdMap.emplace(entry.first, static_cast<int>(textureSourceKeys.size()));
+        textureSourceKeys.push_back(entry.second->first);
+    }
+
+    // 颜色延迟到首次查询时计算,只解压实际用到的纹理
+    textureAverageColors = std::make_unique<std::atomic<uint32_t>[]>(textureSourceKeys.size());
+    for (size_t i = 0; i < textureSourceKeys.size(); ++i) {
+        textureAverageColors[i].store(0, std::memory_order_relaxed);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Texture average color index: " << textureSourceKeys.size() << " textures, "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << "ms" << std::endl;
+}
+
+int GetTextureIdFromMaterialPath(const std::string& materialTexturePath) {
+    // 材质路径格式为 "textures/命名空间/路径.png"
+    std::string path = materialTexturePath;
+    const std::string prefix = "textures/";
+    if (path.compare(0, prefix.size(), prefix) == 0) {
+        path = path.substr(prefix.size());
+    }
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".png") == 0) {
+        path.resize(path.size() - 4);
+    }
+    size_t slashPos = path.find('/');
+    if (slashPos == std::string::npos) return -1;
+    path[slashPos] = ':';
+
+    auto it = textureIdMap.find(path);
+    return (it != textureIdMap.end()) ? it->second : -1;
+}
+
+bool GetTextureAverageColor(int textureId, uint32_t& outColor) {
+    if (textureId < 0 || textureId >= static_cast<int>(textureSourceKeys.size())) return false;
+    uint32_t packed = textureAverageColors[textureId].load(std::memory_order_acquire);
+    if (!(packed & kTextureColorComputed)) {
+        // 首次查询:从归档解压并计算(并发时可能重复计算,结果相同)
+        std::vector<unsigned char> pngData;
+        packed = kTextureColorComputed;
+        if (GlobalCache::LoadTexture(textureSourceKeys[textureId], pngData)) {
+            packed |= ComputePNGAverageColor(pngData);
+        }
+        textureAverageColors[textureId].store(packed, std::memory_order_release);
+    }
+    if (!(packed & kTextureColorValid)) return false;
+    outColor = packed & 0xFFFFFFu;
+    return true;
+}
+
+bool LoadTextureByMaterialPath(const std::string& materialTexturePath, std::vector<unsigned char>& outData) {
+    int textureId = GetTextureIdFromMaterialPath(materialTexturePath);
+    if (textureId < 0) return false;
+    if (!GlobalCache::LoadTexture(textureSourceKeys[textureId], outData)) return false;
+    // 与写出的纹理文件保持一致(裁剪/缩小)
+    ProcessExportTexture(textureSourceKeys[textureId], outData);
+    return true;
+}
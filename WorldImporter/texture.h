@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <mutex>
+#include <cstdint>
 #include "config.h"
 #include "JarReader.h"
 #include "GlobalCache.h"
@@ -17,7 +18,7 @@ enum MaterialType {
 
 // 纹理缓存和互斥锁
 extern std::unordered_map<std::string, std::string> texturePathCache; 
-static std::mutex texturePathCacheMutex;
+extern std::mutex texturePathCacheMutex;
 
 // 新增：纹理尺寸缓存（保存图片的宽高比）
 struct TextureDimension {
@@ -36,6 +37,12 @@ void RegisterTexture(const std::string& namespaceName, const std::string& pathPa
 
 bool SaveTextureToFile(const std::string& namespaceName, const std::string& blockId, std::string& savePath);
 
+// 图集模式:只记录纹理尺寸并登记,暂不写出文件(材质路径为 "textures/命名空间/路径.png")
+bool DeferTextureSave(const std::string& namespaceName, const std::string& blockId);
+
+// 写出先前登记的纹理(每个材质路径只写一次),图集未能打包的纹理由此写出;未登记或已写出时返回 false
+bool WriteDeferredTexture(const std::string& materialTexturePath);
+
 // 从PNG数据中读取图像尺寸
 bool GetPNGDimensions(const std::vector<unsigned char>& pngData, int& width, int& height);
 
@@ -43,6 +50,19 @@ bool GetPNGDimensions(const std::vector<unsigned char>& pngData, int& width, int
 MaterialType DetectMaterialType(const std::string& namespaceName, const std::string& texturePath);
 MaterialType DetectMaterialType(const std::string& namespaceName, const std::string& texturePath, float& outAspectRatio);
 
+// 纹理平均颜色:资源加载后建立纹理ID索引,颜色在首次查询时从归档解压计算(线性空间平均),
+// 结果打包为 0xRRGGBB(sRGB) 并按纹理ID缓存,LOD着色不再读取磁盘
+void BuildTextureAverageColors();
+
+// 根据材质路径("textures/命名空间/路径.png")获取纹理ID,未找到时返回 -1
+int GetTextureIdFromMaterialPath(const std::string& materialTexturePath);
+
+// 获取纹理的打包平均颜色,纹理不存在或全透明时返回 false
+bool GetTextureAverageColor(int textureId, uint32_t& outColor);
+
+// 根据材质路径从归档解压纹理PNG数据,并按导出选项裁剪/缩小(依赖 BuildTextureAverageColors 建立的索引)
+bool LoadTextureByMaterialPath(const std::string& materialTexturePath, std::vector<unsigned char>& outData);
+
 // 从缓存中读取.mcmeta数据并解析（修改后，支持获取长宽比）
 bool ParseMcmetaFile(const std::string& cacheKey, MaterialType& outType);
 bool ParseMcmetaFile(const std::string& cacheKey, MaterialType& outType, float& outAspectRatio);